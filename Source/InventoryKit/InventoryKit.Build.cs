@@ -25,7 +25,7 @@ public class InventoryKit : ModuleRules
 		PublicDependencyModuleNames.AddRange(
 			new string[]
 			{
-				"Core", "GameplayTags",
+				"Core", "GameplayTags", "NetCore",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -16,8 +16,39 @@ bool UFixedSlotSpaceManager::CanAddItemToSlot(int32 SlotIndex) const
 
 int32 UFixedSlotSpaceManager::GetRecommendedSlotIndex() const
 {
-    UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("GetRecommendedSlotIndex is not implemented for FixedSlotSpaceManager."));
-    // 没有可用槽位
+    // 不知道物品标签时只推荐没有类型的通用槽位
+    return FindFreeSlotOfType(FGameplayTag());
+}
+
+int32 UFixedSlotSpaceManager::FindPlacement(const FIntPoint& Size, const FGameplayTagContainer& ItemTags, bool bAllowRotation, bool& bOutRotated) const
+{
+    bOutRotated = false;
+
+    // 物品的标签或其父标签与槽位类型相同即兼容, 多个兼容槽位时取索引最小的
+    int32 BestSlot = INDEX_NONE;
+    for (const FGameplayTag& Tag : ItemTags.GetGameplayTagParents())
+    {
+        const int32 Slot = FindFreeSlotOfType(Tag);
+        if (Slot != INDEX_NONE && (BestSlot == INDEX_NONE || Slot < BestSlot))
+        {
+            BestSlot = Slot;
+        }
+    }
+    return BestSlot != INDEX_NONE ? BestSlot : GetRecommendedSlotIndex();
+}
+
+int32 UFixedSlotSpaceManager::FindFreeSlotOfType(const FGameplayTag& SlotType) const
+{
+    if (const TArray<int32>* Slots = SlotsByType.Find(SlotType))
+    {
+        for (const int32 Slot : *Slots)
+        {
+            if (IsSlotAvailable(Slot))
+            {
+                return Slot;
+            }
+        }
+    }
     return INDEX_NONE;
 }
 
@@ -43,10 +74,11 @@ bool UFixedSlotSpaceManager::IsSlotAvailable(int32 SlotIndex) const
 
 void UFixedSlotSpaceManager::Initialize(const FContainerSpaceConfig& Config)
 {
-    // 清除现有数据
-    IndexToSlotTypeMap.Empty();
-    SlotTypeToIndexMap.Empty();
-    SlotFlags.Empty();
+    // 清除现有数据, 保留已分配的内存供池中复用
+    IndexToSlotTypeMap.Reset();
+    SlotTypeToIndexMap.Reset();
+    SlotFlags.Reset();
+    SlotsByType.Reset();
     
     // 添加固定槽位
     for (int32 i = 0; i < Config.FixedSlotTypes.Num(); ++i)
@@ -54,6 +86,7 @@ void UFixedSlotSpaceManager::Initialize(const FContainerSpaceConfig& Config)
         const FGameplayTag& SlotType = Config.FixedSlotTypes[i];
         IndexToSlotTypeMap.Add(i, SlotType);
         SlotTypeToIndexMap.Add(SlotType, i);
+        SlotsByType.FindOrAdd(SlotType).Add(i);
         
         // 初始化槽位状态为可用
         SlotFlags.Add(i, 0);
@@ -62,8 +95,8 @@ void UFixedSlotSpaceManager::Initialize(const FContainerSpaceConfig& Config)
 
 int32 UFixedSlotSpaceManager::GetCapacity() const
 {
-    // 容量即槽位数量
-    return SlotTypeToIndexMap.Num();
+    // 容量即槽位数量, 同类型的槽位可以有多个
+    return IndexToSlotTypeMap.Num();
 }
 
 bool UFixedSlotSpaceManager::IsValidSlotIndex(int32 SlotIndex) const
@@ -74,7 +107,7 @@ bool UFixedSlotSpaceManager::IsValidSlotIndex(int32 SlotIndex) const
 
 int32 UFixedSlotSpaceManager::GetSlotCount() const
 {
-    return SlotTypeToIndexMap.Num();
+    return IndexToSlotTypeMap.Num();
 }
 
 bool UFixedSlotSpaceManager::HasItemAtSlot(int32 SlotIndex) const
@@ -138,4 +171,56 @@ void UFixedSlotSpaceManager::UpdateSlotState(int32 SlotIndex, uint8 Flag)
     {
         UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("Slot index %d not found in FixedSlotSpaceManager."), SlotIndex);
     }
-} 
\ No newline at end of file
+} 
+void UFixedSlotSpaceManager::SerializeOccupancy(FArchive& Ar)
+{
+    if (!Ar.IsLoading())
+    {
+        Ar << SlotFlags;
+        return;
+    }
+
+    TMap<int32, uint8> LoadedFlags;
+    if (!ReadOccupancy(Ar, LoadedFlags))
+    {
+        Ar.SetError();
+        return;
+    }
+    for (TPair<int32, uint8>& Pair : SlotFlags)
+    {
+        const uint8* LoadedFlag = LoadedFlags.Find(Pair.Key);
+        Pair.Value = LoadedFlag ? *LoadedFlag : 0;
+    }
+}
+
+bool UFixedSlotSpaceManager::CanRestoreOccupancy(FArchive& Ar) const
+{
+    TMap<int32, uint8> LoadedFlags;
+    return ReadOccupancy(Ar, LoadedFlags);
+}
+
+bool UFixedSlotSpaceManager::ReadOccupancy(FArchive& Ar, TMap<int32, uint8>& OutFlags) const
+{
+    Ar << OutFlags;
+    if (Ar.IsError())
+    {
+        return false;
+    }
+    for (const TPair<int32, uint8>& Pair : OutFlags)
+    {
+        if (!IndexToSlotTypeMap.Contains(Pair.Key))
+        {
+            UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("Slot index %d in saved occupancy not found in FixedSlotSpaceManager."), Pair.Key);
+            return false;
+        }
+    }
+    return true;
+}
+
+void UFixedSlotSpaceManager::ResetOccupancy()
+{
+    for (TPair<int32, uint8>& Pair : SlotFlags)
+    {
+        Pair.Value = 0;
+    }
+}
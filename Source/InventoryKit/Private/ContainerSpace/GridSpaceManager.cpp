@@ -6,6 +6,8 @@
 UGridSpaceManager::UGridSpaceManager()
     : GridWidth(0)
     , GridHeight(0)
+    , WordsPerRow(0)
+    , FirstFreeRow(0)
 {
     // 初始化成员变量
 }
@@ -18,12 +20,22 @@ bool UGridSpaceManager::CanAddItemToSlot(int32 SlotIndex) const
 
 int32 UGridSpaceManager::GetRecommendedSlotIndex() const
 {
-    // 寻找第一个可用的槽位
-    for (int32 Index = 0; Index < SlotFlags.Num(); ++Index)
+    // 寻找第一个可用的槽位: 跳过已满的行, 行内按字查找第一个0位
+    for (int32 Row = FirstFreeRow; Row < GridHeight; ++Row)
     {
-        if (SlotFlags[Index] == 0) // 0表示可用
+        if (RowFreeCounts[Row] == 0)
         {
-            return Index;
+            continue;
+        }
+
+        const int32 RowOffset = Row * WordsPerRow;
+        for (int32 Word = 0; Word < WordsPerRow; ++Word)
+        {
+            const uint64 FreeBits = ~OccupancyWords[RowOffset + Word];
+            if (FreeBits != 0)
+            {
+                return Row * GridWidth + Word * 64 + static_cast<int32>(FMath::CountTrailingZeros64(FreeBits));
+            }
         }
     }
     
@@ -39,8 +51,15 @@ bool UGridSpaceManager::IsSlotAvailable(int32 SlotIndex) const
         return false;
     }
     
-    // 检查槽位状态，0表示可用
-    return SlotFlags[SlotIndex] == 0;
+    return !IsSlotOccupied(SlotIndex);
+}
+
+bool UGridSpaceManager::IsSlotOccupied(int32 SlotIndex) const
+{
+    const int32 X = SlotIndex % GridWidth;
+    const int32 Y = SlotIndex / GridWidth;
+    const uint64 Word = OccupancyWords[Y * WordsPerRow + X / 64];
+    return ((Word >> (X % 64)) & 1) != 0;
 }
 
 void UGridSpaceManager::Initialize(const FContainerSpaceConfig& Config)
@@ -49,9 +68,17 @@ void UGridSpaceManager::Initialize(const FContainerSpaceConfig& Config)
     GridWidth = FMath::Max(1, Config.GridWidth);
     GridHeight = FMath::Max(1, Config.GridHeight);
     
-    // 初始化槽位状态数组
-    const int32 TotalSlots = GridWidth * GridHeight;
-    SlotFlags.Init(0, TotalSlots); // 所有槽位初始化为可用状态(0)
+    // 初始化占用位图
+    WordsPerRow = (GridWidth + 63) / 64;
+    ResetOccupancy();
+}
+
+void UGridSpaceManager::AdvanceFirstFreeRow()
+{
+    while (FirstFreeRow < GridHeight && RowFreeCounts[FirstFreeRow] == 0)
+    {
+        ++FirstFreeRow;
+    }
 }
 
 int32 UGridSpaceManager::GetCapacity() const
@@ -63,7 +90,7 @@ int32 UGridSpaceManager::GetCapacity() const
 bool UGridSpaceManager::IsValidSlotIndex(int32 SlotIndex) const
 {
     // 检查索引是否在有效范围内
-    return SlotIndex >= 0 && SlotIndex < SlotFlags.Num();
+    return SlotIndex >= 0 && SlotIndex < GridWidth * GridHeight;
 }
 
 void UGridSpaceManager::GetGridSize(int32& OutWidth, int32& OutHeight) const
@@ -110,13 +137,345 @@ void UGridSpaceManager::UpdateSlotState(int32 SlotIndex, uint8 Flag)
     // 检查索引是否有效
     if (IsValidSlotIndex(SlotIndex))
     {
-        SlotFlags[SlotIndex] = Flag;
+        UpdateFootprintState(SlotIndex, FIntPoint(1, 1), Flag);
     }
 }
 
+bool UGridSpaceManager::IsFootprintAvailable(int32 SlotIndex, const FIntPoint& Footprint, int32 IgnoreSlotIndex, const FIntPoint& IgnoreFootprint) const
+{
+    if (!IsValidSlotIndex(SlotIndex) || Footprint.X < 1 || Footprint.Y < 1)
+    {
+        return false;
+    }
+
+    int32 X, Y;
+    IndexToCoordinate(SlotIndex, X, Y);
+    if (X + Footprint.X > GridWidth || Y + Footprint.Y > GridHeight)
+    {
+        return false;
+    }
+
+    int32 IgnoreX = -1, IgnoreY = -1;
+    IndexToCoordinate(IgnoreSlotIndex, IgnoreX, IgnoreY);
+
+    // 按行检查, 每行只需检查覆盖区域的几个字
+    const int32 FirstWord = X / 64;
+    const int32 LastWord = (X + Footprint.X - 1) / 64;
+    for (int32 Row = Y; Row < Y + Footprint.Y; ++Row)
+    {
+        const bool bIgnoreRow = IgnoreY >= 0 && Row >= IgnoreY && Row < IgnoreY + IgnoreFootprint.Y;
+        for (int32 Word = FirstWord; Word <= LastWord; ++Word)
+        {
+            uint64 Mask = MakeRowMask(Word, X, X + Footprint.X);
+            if (bIgnoreRow)
+            {
+                Mask &= ~MakeRowMask(Word, IgnoreX, IgnoreX + IgnoreFootprint.X);
+            }
+            if (OccupancyWords[Row * WordsPerRow + Word] & Mask)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void UGridSpaceManager::UpdateFootprintState(int32 SlotIndex, const FIntPoint& Footprint, uint8 Flag)
+{
+    int32 X, Y;
+    IndexToCoordinate(SlotIndex, X, Y);
+    if (X < 0 || Footprint.X < 1 || Footprint.Y < 1 || X + Footprint.X > GridWidth || Y + Footprint.Y > GridHeight)
+    {
+        UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("Footprint %dx%d at slot %d is out of grid."), Footprint.X, Footprint.Y, SlotIndex);
+        return;
+    }
+
+    const bool bOccupied = Flag != 0;
+    const int32 FirstWord = X / 64;
+    const int32 LastWord = (X + Footprint.X - 1) / 64;
+    for (int32 Row = Y; Row < Y + Footprint.Y; ++Row)
+    {
+        for (int32 Word = FirstWord; Word <= LastWord; ++Word)
+        {
+            const uint64 Mask = MakeRowMask(Word, X, X + Footprint.X);
+            uint64& RowWord = OccupancyWords[Row * WordsPerRow + Word];
+            if (bOccupied)
+            {
+                RowFreeCounts[Row] -= FMath::CountBits(Mask & ~RowWord);
+                RowWord |= Mask;
+            }
+            else
+            {
+                RowFreeCounts[Row] += FMath::CountBits(Mask & RowWord);
+                RowWord &= ~Mask;
+            }
+        }
+    }
+
+    if (bOccupied)
+    {
+        AdvanceFirstFreeRow();
+    }
+    else
+    {
+        FirstFreeRow = FMath::Min(FirstFreeRow, Y);
+    }
+}
+
+bool UGridSpaceManager::GetFootprintSlots(int32 SlotIndex, const FIntPoint& Footprint, TArray<int32>& OutSlots) const
+{
+    OutSlots.Reset();
+
+    int32 X, Y;
+    IndexToCoordinate(SlotIndex, X, Y);
+    if (X < 0 || Footprint.X < 1 || Footprint.Y < 1 || X + Footprint.X > GridWidth || Y + Footprint.Y > GridHeight)
+    {
+        return false;
+    }
+
+    OutSlots.Reserve(Footprint.X * Footprint.Y);
+    for (int32 Row = Y; Row < Y + Footprint.Y; ++Row)
+    {
+        for (int32 Column = X; Column < X + Footprint.X; ++Column)
+        {
+            OutSlots.Add(Row * GridWidth + Column);
+        }
+    }
+    return true;
+}
+
+int32 UGridSpaceManager::FindFirstFit(const FIntPoint& Size, bool bAllowRotation, bool& bOutRotated) const
+{
+    bOutRotated = false;
+    const int32 Index = FindFirstFitForFootprint(Size);
+    if (!bAllowRotation || Size.X == Size.Y)
+    {
+        return Index;
+    }
+
+    // 旋转后位置更靠前时才使用旋转
+    const int32 RotatedIndex = FindFirstFitForFootprint(FIntPoint(Size.Y, Size.X));
+    if (RotatedIndex != INDEX_NONE && (Index == INDEX_NONE || RotatedIndex < Index))
+    {
+        bOutRotated = true;
+        return RotatedIndex;
+    }
+    return Index;
+}
+
+bool UGridSpaceManager::CanPlaceAt(int32 X, int32 Y, const FIntPoint& Footprint) const
+{
+    const int32 SlotIndex = CoordinateToIndex(X, Y);
+    return SlotIndex != INDEX_NONE && IsFootprintAvailable(SlotIndex, Footprint);
+}
+
+uint64 UGridSpaceManager::MakeRowMask(int32 WordIndex, int32 BeginX, int32 EndX)
+{
+    const int32 WordBegin = WordIndex * 64;
+    const int32 Low = FMath::Max(BeginX, WordBegin) - WordBegin;
+    const int32 High = FMath::Min(EndX, WordBegin + 64) - WordBegin;
+    if (High <= Low)
+    {
+        return 0;
+    }
+
+    const int32 Width = High - Low;
+    const uint64 Bits = Width == 64 ? ~0ull : ((1ull << Width) - 1);
+    return Bits << Low;
+}
+
+int32 UGridSpaceManager::FindNextBit(const uint64* RowWords, int32 StartX, bool bSet) const
+{
+    int32 Word = StartX / 64;
+    if (Word >= WordsPerRow)
+    {
+        return WordsPerRow * 64;
+    }
+
+    uint64 Bits = (bSet ? RowWords[Word] : ~RowWords[Word]) & (~0ull << (StartX % 64));
+    while (Bits == 0)
+    {
+        if (++Word >= WordsPerRow)
+        {
+            return WordsPerRow * 64;
+        }
+        Bits = bSet ? RowWords[Word] : ~RowWords[Word];
+    }
+    return Word * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Bits));
+}
+
+int32 UGridSpaceManager::FindFreeRun(const uint64* RowWords, int32 Width) const
+{
+    // 在空闲起点与下一个占用位之间跳跃, 每段区间只需两次按字查找
+    int32 X = 0;
+    while (X < GridWidth)
+    {
+        const int32 FreeBegin = FindNextBit(RowWords, X, false);
+        if (FreeBegin >= GridWidth)
+        {
+            return INDEX_NONE;
+        }
+
+        const int32 FreeEnd = FMath::Min(FindNextBit(RowWords, FreeBegin, true), GridWidth);
+        if (FreeEnd - FreeBegin >= Width)
+        {
+            return FreeBegin;
+        }
+        X = FreeEnd;
+    }
+    return INDEX_NONE;
+}
+
+int32 UGridSpaceManager::FindFirstFitForFootprint(const FIntPoint& Footprint) const
+{
+    if (Footprint.X < 1 || Footprint.Y < 1 || Footprint.X > GridWidth || Footprint.Y > GridHeight)
+    {
+        return INDEX_NONE;
+    }
+
+    // 候选行的位图按位或, 合并后的空闲区间即可同时放下Footprint.Y行
+    TArray<uint64, TInlineAllocator<4>> CombinedWords;
+    CombinedWords.SetNumUninitialized(WordsPerRow);
+    for (int32 Y = FirstFreeRow; Y + Footprint.Y <= GridHeight; ++Y)
+    {
+        // 空闲数量不足的行不可能放下, 直接跳到它的下一行
+        int32 BlockedRow = INDEX_NONE;
+        for (int32 Row = Y + Footprint.Y - 1; Row >= Y; --Row)
+        {
+            if (RowFreeCounts[Row] < Footprint.X)
+            {
+                BlockedRow = Row;
+                break;
+            }
+        }
+        if (BlockedRow != INDEX_NONE)
+        {
+            Y = BlockedRow;
+            continue;
+        }
+
+        FMemory::Memcpy(CombinedWords.GetData(), &OccupancyWords[Y * WordsPerRow], WordsPerRow * sizeof(uint64));
+        for (int32 Row = Y + 1; Row < Y + Footprint.Y; ++Row)
+        {
+            const uint64* RowWords = &OccupancyWords[Row * WordsPerRow];
+            for (int32 Word = 0; Word < WordsPerRow; ++Word)
+            {
+                CombinedWords[Word] |= RowWords[Word];
+            }
+        }
+
+        const int32 X = FindFreeRun(CombinedWords.GetData(), Footprint.X);
+        if (X != INDEX_NONE)
+        {
+            return Y * GridWidth + X;
+        }
+    }
+    return INDEX_NONE;
+}
+
 int32 UGridSpaceManager::GetSlotIndexByTag(const FGameplayTag& SlotTag) const
 {
     // 网格容器不支持通过标签查找槽位
     UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("GetSlotIndexByTag is not supported in GridSpaceManager."));
     return INDEX_NONE;
 }
+
+void UGridSpaceManager::SerializeOccupancy(FArchive& Ar)
+{
+    if (!Ar.IsLoading())
+    {
+        int32 SavedWidth = GridWidth;
+        int32 SavedHeight = GridHeight;
+        Ar << SavedWidth;
+        Ar << SavedHeight;
+
+        // 位图和行空闲计数直接整块写出
+        OccupancyWords.BulkSerialize(Ar);
+        RowFreeCounts.BulkSerialize(Ar);
+        return;
+    }
+
+    // 先读入临时数组, 校验通过后再替换, 数据不合法时保留当前状态
+    TArray<uint64> LoadedWords;
+    TArray<int32> LoadedRowFreeCounts;
+    if (!ReadOccupancy(Ar, LoadedWords, LoadedRowFreeCounts))
+    {
+        Ar.SetError();
+        return;
+    }
+    OccupancyWords = MoveTemp(LoadedWords);
+    RowFreeCounts = MoveTemp(LoadedRowFreeCounts);
+    FirstFreeRow = 0;
+    AdvanceFirstFreeRow();
+}
+
+bool UGridSpaceManager::CanRestoreOccupancy(FArchive& Ar) const
+{
+    TArray<uint64> LoadedWords;
+    TArray<int32> LoadedRowFreeCounts;
+    return ReadOccupancy(Ar, LoadedWords, LoadedRowFreeCounts);
+}
+
+bool UGridSpaceManager::ReadOccupancy(FArchive& Ar, TArray<uint64>& OutWords, TArray<int32>& OutRowFreeCounts) const
+{
+    int32 SavedWidth = 0;
+    int32 SavedHeight = 0;
+    Ar << SavedWidth;
+    Ar << SavedHeight;
+    if (Ar.IsError() || SavedWidth != GridWidth || SavedHeight != GridHeight)
+    {
+        UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("Grid size mismatch when loading occupancy: saved %dx%d, current %dx%d."), SavedWidth, SavedHeight, GridWidth, GridHeight);
+        return false;
+    }
+
+    OutWords.BulkSerialize(Ar);
+    OutRowFreeCounts.BulkSerialize(Ar);
+    if (Ar.IsError() || OutWords.Num() != GridHeight * WordsPerRow || OutRowFreeCounts.Num() != GridHeight)
+    {
+        UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("Corrupted grid occupancy for %dx%d grid."), GridWidth, GridHeight);
+        return false;
+    }
+
+    // 行尾填充位必须为1, 行空闲计数必须与位图一致, 否则之后的查找会越界或跳过空位
+    const int32 PaddingBits = WordsPerRow * 64 - GridWidth;
+    const uint64 PaddingMask = PaddingBits > 0 ? ~0ull << (64 - PaddingBits) : 0;
+    for (int32 Row = 0; Row < GridHeight; ++Row)
+    {
+        const uint64* RowWords = OutWords.GetData() + Row * WordsPerRow;
+        int32 NumOccupied = 0;
+        for (int32 WordIndex = 0; WordIndex < WordsPerRow; ++WordIndex)
+        {
+            NumOccupied += FMath::CountBits(RowWords[WordIndex]);
+        }
+        if ((RowWords[WordsPerRow - 1] & PaddingMask) != PaddingMask || OutRowFreeCounts[Row] != WordsPerRow * 64 - NumOccupied)
+        {
+            UE_LOG(LogInventoryKitSpaceManager, Error, TEXT("Inconsistent occupancy in row %d of %dx%d grid."), Row, GridWidth, GridHeight);
+            return false;
+        }
+    }
+    return true;
+}
+
+void UGridSpaceManager::ResetOccupancy()
+{
+    // 所有槽位初始化为可用状态(0), 行尾填充位置1
+    // 先Reset再填充, 从池中复用时保留已分配的内存
+    OccupancyWords.Reset(GridHeight * WordsPerRow);
+    OccupancyWords.AddZeroed(GridHeight * WordsPerRow);
+    const int32 PaddingBits = WordsPerRow * 64 - GridWidth;
+    if (PaddingBits > 0)
+    {
+        const uint64 PaddingMask = ~0ull << (64 - PaddingBits);
+        for (int32 Row = 0; Row < GridHeight; ++Row)
+        {
+            OccupancyWords[Row * WordsPerRow + WordsPerRow - 1] = PaddingMask;
+        }
+    }
+    RowFreeCounts.Reset(GridHeight);
+    RowFreeCounts.AddUninitialized(GridHeight);
+    for (int32& FreeCount : RowFreeCounts)
+    {
+        FreeCount = GridWidth;
+    }
+    FirstFreeRow = 0;
+}
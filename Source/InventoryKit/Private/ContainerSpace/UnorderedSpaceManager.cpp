@@ -84,5 +84,39 @@ int32 UUnorderedSpaceManager::GetSlotIndexByXY(int32 X, int32 Y) const
 
 void UUnorderedSpaceManager::UpdateSlotState(int32 SlotIndex, uint8 Flag)
 {
-    
-} 
\ No newline at end of file
+    // 所有物品共用同一个槽位, 容器每添加一个物品占用一次, 每移除一个物品释放一次
+    ItemCount = FMath::Max(0, ItemCount + (Flag != 0 ? 1 : -1));
+} 
+
+bool UUnorderedSpaceManager::IsSlotExclusive() const
+{
+    // 无序容器中所有物品共用同一个槽位索引
+    return false;
+}
+
+void UUnorderedSpaceManager::SerializeOccupancy(FArchive& Ar)
+{
+    int32 SavedItemCount = ItemCount;
+    Ar << SavedItemCount;
+    if (Ar.IsLoading())
+    {
+        if (Ar.IsError() || SavedItemCount < 0)
+        {
+            Ar.SetError();
+            return;
+        }
+        ItemCount = SavedItemCount;
+    }
+}
+
+bool UUnorderedSpaceManager::CanRestoreOccupancy(FArchive& Ar) const
+{
+    int32 SavedItemCount = 0;
+    Ar << SavedItemCount;
+    return !Ar.IsError() && SavedItemCount >= 0;
+}
+
+void UUnorderedSpaceManager::ResetOccupancy()
+{
+    ItemCount = 0;
+}
@@ -5,13 +5,29 @@
 #include "ContainerSpace/ContainerSpaceManager.h"
 #include "Core/InventoryKitItemSystem.h"
 #include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Net/UnrealNetwork.h"
 
 UInventoryKitBaseContainerComponent::UInventoryKitBaseContainerComponent()
 {
     PrimaryComponentTick.bCanEverTick = false;
+    SetIsReplicatedByDefault(true);
     
     // 默认值
     ID = -1;
+    ReplicatedItems.Owner = this;
+}
+
+void UInventoryKitBaseContainerComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+    DOREPLIFETIME(UInventoryKitBaseContainerComponent, ReplicatedItems);
+}
+
+bool UInventoryKitBaseContainerComponent::IsReplicationAuthority() const
+{
+    const AActor* Owner = GetOwner();
+    return Owner && Owner->HasAuthority() && GetIsReplicated();
 }
 
 void UInventoryKitBaseContainerComponent::BeginPlay()
@@ -21,6 +37,7 @@ void UInventoryKitBaseContainerComponent::BeginPlay()
     if (UInventoryKitItemSystem* ItemSystem = GetWorld()->GetSubsystem<UInventoryKitItemSystem>())
     {
         // 注册容器
+        OwningItemSystem = ItemSystem;
         ItemSystem->RegisterContainer(this);
     }
     else
@@ -29,11 +46,36 @@ void UInventoryKitBaseContainerComponent::BeginPlay()
     }
 }
 
+void UInventoryKitBaseContainerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // 注销容器, 空间管理器交还物品系统复用
+    // 关卡切换或退出时整个世界一起销毁, 不移动物品, 避免日志记录大量无意义的移动
+    const bool bWorldTearingDown = EndPlayReason != EEndPlayReason::Destroyed && EndPlayReason != EEndPlayReason::RemovedFromWorld;
+    UInventoryKitItemSystem* ItemSystem = OwningItemSystem.Get();
+    if (ItemSystem && !bWorldTearingDown)
+    {
+        if (ItemSystem->FindContainer(ID) == this)
+        {
+            ItemSystem->UnregisterContainer(this, OrphanPolicy);
+        }
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void UInventoryKitBaseContainerComponent::InitContainer(int32 InContainerID)
 {
     ID = InContainerID;
     
-    SpaceManager = CreateSpaceManager(this, SpaceConfig);
+    // 优先从物品系统的池中取出空间管理器, 避免每个容器都创建新对象
+    if (UInventoryKitItemSystem* ItemSystem = OwningItemSystem.Get())
+    {
+        SpaceManager = ItemSystem->AcquireSpaceManager(SpaceConfig);
+    }
+    else
+    {
+        SpaceManager = CreateSpaceManager(this, SpaceConfig);
+    }
 }
 
 const int32 UInventoryKitBaseContainerComponent::GetContainerID() const
@@ -41,8 +83,19 @@ const int32 UInventoryKitBaseContainerComponent::GetContainerID() const
     return ID;
 }
 
+FString UInventoryKitBaseContainerComponent::GetPersistentKey() const
+{
+    return PersistentKey.IsEmpty() ? GetPathName(GetWorld()) : PersistentKey;
+}
+
 bool UInventoryKitBaseContainerComponent::CanAddItem(const FItemBaseInstance& InItem, int32 DstSlotIndex)
 {
+    // 检查负重和体积限制, 不限容量的容器同样受限
+    if (!CanAcceptLoad(GetItemLoad(InItem)))
+    {
+        return false;
+    }
+    
     if (SpaceManager->GetCapacity() < 0)
     {
         return true;
@@ -54,60 +107,271 @@ bool UInventoryKitBaseContainerComponent::CanAddItem(const FItemBaseInstance& In
         return false;
     }
 
-    // 检查槽位是否可用
-    if (!SpaceManager->IsSlotAvailable(DstSlotIndex))
+    // 检查物品占用的槽位是否可用
+    return SpaceManager->IsFootprintAvailable(DstSlotIndex, InItem.GetFootprint());
+}
+
+bool UInventoryKitBaseContainerComponent::CanMoveItem(const FItemBaseInstance& InItem, int32 DstSlotIndex)
+{
+    // 检查物品占用的槽位是否可用, 物品自身当前占用的槽位视为空闲
+    const FIntPoint Footprint = InItem.GetFootprint();
+    if (!SpaceManager->IsFootprintAvailable(DstSlotIndex, Footprint, InItem.ItemLocation.SlotIndex, Footprint))
+    {
+        return false;
+    }
+
+    // 项目实际使用如果需要判断堆叠等情况， 继承当前组件，然后重写这个方法
+
+    return true;
+}
+
+bool UInventoryKitBaseContainerComponent::CanAddItemStaged(const FItemBaseInstance& InItem, int32 DstSlotIndex, const FInventoryKitStagedContainerDelta& Staged)
+{
+    // 检查暂存后的负重和体积
+    if (!IsWithinLoadLimits(GetCurrentLoad() + Staged.AddedLoad - Staged.RemovedLoad + GetItemLoad(InItem)))
     {
         return false;
     }
     
-    // TODO: 检查重量限制
+    if (SpaceManager->GetCapacity() < 0)
+    {
+        return true;
+    }
     
-    return true;
+    // 检查暂存后的容量
+    if (ItemIDs.Num() + Staged.AddedCount - Staged.RemovedCount >= SpaceManager->GetCapacity())
+    {
+        return false;
+    }
+
+    return IsFootprintAvailableStaged(DstSlotIndex, InItem.GetFootprint(), Staged);
 }
 
-bool UInventoryKitBaseContainerComponent::CanMoveItem(const FItemBaseInstance& InItem, int32 DstSlotIndex)
+bool UInventoryKitBaseContainerComponent::CanAcceptLoad(const FInventoryKitLoad& AdditionalLoad) const
+{
+    return IsWithinLoadLimits(GetCurrentLoad() + AdditionalLoad);
+}
+
+int32 UInventoryKitBaseContainerComponent::GetAcceptableQuantity(const FInventoryKitLoad& UnitLoad, int32 MaxQuantity) const
+{
+    const FInventoryKitLoad TotalLoad = GetCurrentLoad();
+    int32 Acceptable = MaxQuantity;
+    if (SpaceConfig.MaxWeight >= 0.f && UnitLoad.Weight > 0.0)
+    {
+        const double RemainingWeight = FMath::Max(0.0, SpaceConfig.MaxWeight - TotalLoad.Weight + UE_KINDA_SMALL_NUMBER);
+        Acceptable = static_cast<int32>(FMath::Min<int64>(Acceptable, FMath::FloorToInt64(RemainingWeight / UnitLoad.Weight)));
+    }
+    if (SpaceConfig.MaxVolume >= 0.f && UnitLoad.Volume > 0.0)
+    {
+        const double RemainingVolume = FMath::Max(0.0, SpaceConfig.MaxVolume - TotalLoad.Volume + UE_KINDA_SMALL_NUMBER);
+        Acceptable = static_cast<int32>(FMath::Min<int64>(Acceptable, FMath::FloorToInt64(RemainingVolume / UnitLoad.Volume)));
+    }
+    return Acceptable;
+}
+
+FInventoryKitLoad UInventoryKitBaseContainerComponent::GetItemLoad(const FItemBaseInstance& InItem) const
 {
-    // 检查槽位是否可用
-    if (!SpaceManager->IsSlotAvailable(DstSlotIndex))
+    const UInventoryKitItemSystem* ItemSystem = OwningItemSystem.Get();
+    return ItemSystem ? ItemSystem->GetItemLoad(InItem) : FInventoryKitLoad();
+}
+
+bool UInventoryKitBaseContainerComponent::IsWithinLoadLimits(const FInventoryKitLoad& TotalLoad) const
+{
+    // 允许浮点累加误差
+    if (SpaceConfig.MaxWeight >= 0.f && TotalLoad.Weight > SpaceConfig.MaxWeight + UE_KINDA_SMALL_NUMBER)
+    {
+        return false;
+    }
+    if (SpaceConfig.MaxVolume >= 0.f && TotalLoad.Volume > SpaceConfig.MaxVolume + UE_KINDA_SMALL_NUMBER)
     {
         return false;
     }
+    return true;
+}
 
-    // 项目实际使用如果需要判断堆叠等情况， 继承当前组件，然后重写这个方法
+bool UInventoryKitBaseContainerComponent::CanMoveItemStaged(const FItemBaseInstance& InItem, int32 DstSlotIndex, const FInventoryKitStagedContainerDelta& Staged)
+{
+    return IsFootprintAvailableStaged(DstSlotIndex, InItem.GetFootprint(), Staged);
+}
 
+bool UInventoryKitBaseContainerComponent::IsFootprintAvailableStaged(int32 SlotIndex, const FIntPoint& Footprint, const FInventoryKitStagedContainerDelta& Staged) const
+{
+    TArray<int32> FootprintSlots;
+    if (!SpaceManager->GetFootprintSlots(SlotIndex, Footprint, FootprintSlots))
+    {
+        return false;
+    }
+
+    for (const int32 Slot : FootprintSlots)
+    {
+        if (Staged.ClaimedSlots.Contains(Slot))
+        {
+            return false;
+        }
+        
+        // 已被事务内前序步骤腾出的槽位视为可用
+        if (Staged.FreedSlots.Contains(Slot))
+        {
+            continue;
+        }
+        
+        if (!SpaceManager->IsSlotAvailable(Slot))
+        {
+            return false;
+        }
+    }
     return true;
 }
 
 void UInventoryKitBaseContainerComponent::OnItemAdded(const FItemBaseInstance& InItem)
 {
     // 如果物品已经在背包中，不重复添加
-    if (!ItemIDs.Contains(InItem.ItemID))
+    if (ItemIDs.Add(InItem.ItemID))
     {
-        ItemIDs.Add(InItem.ItemID);
-        SpaceManager->UpdateSlotState(InItem.ItemLocation.SlotIndex, 1);
-        // TODO: 更新当前重量
+        SpaceManager->UpdateFootprintState(InItem.ItemLocation.SlotIndex, InItem.GetFootprint(), 1);
+        ChangeJournal.RecordAdded(InItem.ItemID);
+        RecordDirtyFootprint(InItem.ItemLocation.SlotIndex, InItem.GetFootprint());
+        if (IsReplicationAuthority())
+        {
+            ReplicatedItems.AddOrUpdate(InItem);
+        }
+        CurrentLoad += GetItemLoad(InItem);
     }
 }
 
 void UInventoryKitBaseContainerComponent::OnItemMoved(const FItemLocation& OldLocation, const FItemBaseInstance& InItem)
 {
-    SpaceManager->UpdateSlotState(OldLocation.SlotIndex, 0);
-    SpaceManager->UpdateSlotState(InItem.ItemLocation.SlotIndex, 1);
+    const FIntPoint Footprint = InItem.GetFootprint();
+    SpaceManager->UpdateFootprintState(OldLocation.SlotIndex, Footprint, 0);
+    SpaceManager->UpdateFootprintState(InItem.ItemLocation.SlotIndex, Footprint, 1);
+    ChangeJournal.RecordChanged(InItem.ItemID);
+    RecordDirtyFootprint(OldLocation.SlotIndex, Footprint);
+    RecordDirtyFootprint(InItem.ItemLocation.SlotIndex, Footprint);
+    if (IsReplicationAuthority())
+    {
+        ReplicatedItems.AddOrUpdate(InItem);
+    }
 }
 
 void UInventoryKitBaseContainerComponent::OnItemRemoved(const FItemBaseInstance& InItem)
 {
-    if (ItemIDs.Contains(InItem.ItemID))
+    if (ItemIDs.Remove(InItem.ItemID))
+    {
+        SpaceManager->UpdateFootprintState(InItem.ItemLocation.SlotIndex, InItem.GetFootprint(), 0);
+        ChangeJournal.RecordRemoved(InItem.ItemID);
+        RecordDirtyFootprint(InItem.ItemLocation.SlotIndex, InItem.GetFootprint());
+        if (IsReplicationAuthority())
+        {
+            ReplicatedItems.Remove(InItem.ItemID);
+        }
+        CurrentLoad -= GetItemLoad(InItem);
+    }
+}
+
+void UInventoryKitBaseContainerComponent::OnItemsAdded(TConstArrayView<FItemBaseInstance> InItems)
+{
+    const bool bReplicate = IsReplicationAuthority();
+    ItemIDs.Reserve(ItemIDs.Num() + InItems.Num());
+    for (const FItemBaseInstance& Item : InItems)
+    {
+        if (ItemIDs.Add(Item.ItemID))
+        {
+            SpaceManager->UpdateFootprintState(Item.ItemLocation.SlotIndex, Item.GetFootprint(), 1);
+            ChangeJournal.RecordAdded(Item.ItemID);
+            RecordDirtyFootprint(Item.ItemLocation.SlotIndex, Item.GetFootprint());
+            if (bReplicate)
+            {
+                ReplicatedItems.AddOrUpdate(Item);
+            }
+            CurrentLoad += GetItemLoad(Item);
+        }
+    }
+}
+
+void UInventoryKitBaseContainerComponent::OnItemsMoved(TConstArrayView<FItemLocation> OldLocations, TConstArrayView<FItemBaseInstance> InItems)
+{
+    check(OldLocations.Num() == InItems.Num());
+    
+    // 先释放所有旧槽位, 再占用新槽位, 批次内的互换不会互相覆盖
+    for (int32 Index = 0; Index < InItems.Num(); ++Index)
+    {
+        SpaceManager->UpdateFootprintState(OldLocations[Index].SlotIndex, InItems[Index].GetFootprint(), 0);
+        RecordDirtyFootprint(OldLocations[Index].SlotIndex, InItems[Index].GetFootprint());
+    }
+    const bool bReplicate = IsReplicationAuthority();
+    for (const FItemBaseInstance& Item : InItems)
+    {
+        SpaceManager->UpdateFootprintState(Item.ItemLocation.SlotIndex, Item.GetFootprint(), 1);
+        ChangeJournal.RecordChanged(Item.ItemID);
+        RecordDirtyFootprint(Item.ItemLocation.SlotIndex, Item.GetFootprint());
+        if (bReplicate)
+        {
+            ReplicatedItems.AddOrUpdate(Item);
+        }
+    }
+}
+
+void UInventoryKitBaseContainerComponent::OnItemsRemoved(TConstArrayView<FItemBaseInstance> InItems)
+{
+    const bool bReplicate = IsReplicationAuthority();
+    for (const FItemBaseInstance& Item : InItems)
     {
-        ItemIDs.Remove(InItem.ItemID);
-        SpaceManager->UpdateSlotState(InItem.ItemLocation.SlotIndex, 0);
-        // TODO: 更新当前重量
+        if (ItemIDs.Remove(Item.ItemID))
+        {
+            SpaceManager->UpdateFootprintState(Item.ItemLocation.SlotIndex, Item.GetFootprint(), 0);
+            ChangeJournal.RecordRemoved(Item.ItemID);
+            RecordDirtyFootprint(Item.ItemLocation.SlotIndex, Item.GetFootprint());
+            if (bReplicate)
+            {
+                ReplicatedItems.Remove(Item.ItemID);
+            }
+            CurrentLoad -= GetItemLoad(Item);
+        }
+    }
+}
+
+void UInventoryKitBaseContainerComponent::OnItemQuantityChanged(const FItemBaseInstance& InItem, int32 OldQuantity)
+{
+    FItemBaseInstance OldItem = InItem;
+    OldItem.Quantity = OldQuantity;
+    CurrentLoad += GetItemLoad(InItem) - GetItemLoad(OldItem);
+    ChangeJournal.RecordChanged(InItem.ItemID);
+    if (IsReplicationAuthority())
+    {
+        ReplicatedItems.AddOrUpdate(InItem);
+    }
+}
+
+void UInventoryKitBaseContainerComponent::FlushPendingChanges()
+{
+    FContainerChangeSet ChangeSet;
+    if (ChangeJournal.Flush(ID, ChangeSet))
+    {
+        OnContainerChanged.Broadcast(ChangeSet);
+    }
+}
+
+void UInventoryKitBaseContainerComponent::RecordDirtyFootprint(int32 SlotIndex, const FIntPoint& Footprint)
+{
+    if (Footprint == FIntPoint(1, 1))
+    {
+        ChangeJournal.RecordDirtySlot(SlotIndex);
+        return;
+    }
+
+    TArray<int32> Slots;
+    if (SpaceManager->GetFootprintSlots(SlotIndex, Footprint, Slots))
+    {
+        for (const int32 Slot : Slots)
+        {
+            ChangeJournal.RecordDirtySlot(Slot);
+        }
     }
 }
 
 const TArray<int32>& UInventoryKitBaseContainerComponent::GetAllItems() const
 {
-    return ItemIDs;
+    return ItemIDs.GetItems();
 }
 
 UContainerSpaceManager* UInventoryKitBaseContainerComponent::GetSpaceManager()
@@ -115,7 +379,130 @@ UContainerSpaceManager* UInventoryKitBaseContainerComponent::GetSpaceManager()
     return SpaceManager;
 }
 
+UContainerSpaceManager* UInventoryKitBaseContainerComponent::ReleaseSpaceManager()
+{
+    UContainerSpaceManager* Released = SpaceManager;
+    SpaceManager = nullptr;
+    return Released;
+}
+
 bool UInventoryKitBaseContainerComponent::ContainsItem(int32 ItemId) const
 {
     return ItemIDs.Contains(ItemId);
-} 
\ No newline at end of file
+}
+
+void UInventoryKitBaseContainerComponent::RestoreContents(TConstArrayView<int32> InItemIds)
+{
+    for (const int32 ItemId : ItemIDs)
+    {
+        ChangeJournal.RecordRemoved(ItemId);
+    }
+    
+    ItemIDs.Reset();
+    ItemIDs.Reserve(InItemIds.Num());
+    for (const int32 ItemId : InItemIds)
+    {
+        ItemIDs.Add(ItemId);
+        ChangeJournal.RecordAdded(ItemId);
+    }
+
+    // 加载快照后重新累计负重, 只在加载时发生; 嵌套负重由物品系统随后重新累加
+    const UInventoryKitItemSystem* ItemSystem = OwningItemSystem.Get();
+    const bool bReplicate = IsReplicationAuthority();
+    CurrentLoad = FInventoryKitLoad();
+    NestedLoad = FInventoryKitLoad();
+    if (bReplicate)
+    {
+        ReplicatedItems.Reset();
+    }
+    for (const int32 ItemId : InItemIds)
+    {
+        const FItemBaseInstance Item = ItemSystem ? ItemSystem->GetItemBaseInstance(ItemId) : FItemBaseInstance();
+        CurrentLoad += GetItemLoad(Item);
+        if (bReplicate)
+        {
+            ReplicatedItems.AddOrUpdate(Item);
+        }
+    }
+}
+
+void UInventoryKitBaseContainerComponent::OnReplicatedItemAdded(const FItemBaseInstance& InItem)
+{
+    PendingReplicatedAdds.Add(InItem);
+}
+
+void UInventoryKitBaseContainerComponent::OnReplicatedItemChanged(const FItemBaseInstance& InItem)
+{
+    PendingReplicatedChanges.Add(InItem);
+}
+
+void UInventoryKitBaseContainerComponent::OnReplicatedItemRemoved(const FItemBaseInstance& InItem)
+{
+    PendingReplicatedRemoves.Add(InItem);
+}
+
+void UInventoryKitBaseContainerComponent::OnReplicatedItemsReceived()
+{
+    // 先释放移除和变化前的槽位, 再占用新槽位, 与OnItemsMoved保持一致
+    for (const FItemBaseInstance& Item : PendingReplicatedRemoves)
+    {
+        FItemBaseInstance OldItem;
+        if (ReplicatedItemCache.RemoveAndCopyValue(Item.ItemID, OldItem))
+        {
+            ItemIDs.Remove(Item.ItemID);
+            if (SpaceManager)
+            {
+                SpaceManager->UpdateFootprintState(OldItem.ItemLocation.SlotIndex, OldItem.GetFootprint(), 0);
+                RecordDirtyFootprint(OldItem.ItemLocation.SlotIndex, OldItem.GetFootprint());
+            }
+            CurrentLoad -= GetItemLoad(OldItem);
+            ChangeJournal.RecordRemoved(Item.ItemID);
+        }
+    }
+    for (const FItemBaseInstance& Item : PendingReplicatedChanges)
+    {
+        const FItemBaseInstance* OldItem = ReplicatedItemCache.Find(Item.ItemID);
+        if (!OldItem)
+        {
+            continue;
+        }
+        if (SpaceManager)
+        {
+            SpaceManager->UpdateFootprintState(OldItem->ItemLocation.SlotIndex, OldItem->GetFootprint(), 0);
+            RecordDirtyFootprint(OldItem->ItemLocation.SlotIndex, OldItem->GetFootprint());
+        }
+        CurrentLoad -= GetItemLoad(*OldItem);
+    }
+
+    auto ApplyItem = [this](const FItemBaseInstance& Item)
+    {
+        ReplicatedItemCache.Add(Item.ItemID, Item);
+        CurrentLoad += GetItemLoad(Item);
+        if (ItemIDs.Add(Item.ItemID))
+        {
+            ChangeJournal.RecordAdded(Item.ItemID);
+        }
+        else
+        {
+            ChangeJournal.RecordChanged(Item.ItemID);
+        }
+        if (SpaceManager)
+        {
+            SpaceManager->UpdateFootprintState(Item.ItemLocation.SlotIndex, Item.GetFootprint(), 1);
+            RecordDirtyFootprint(Item.ItemLocation.SlotIndex, Item.GetFootprint());
+        }
+    };
+    for (const FItemBaseInstance& Item : PendingReplicatedAdds)
+    {
+        ApplyItem(Item);
+    }
+    for (const FItemBaseInstance& Item : PendingReplicatedChanges)
+    {
+        ApplyItem(Item);
+    }
+
+    PendingReplicatedAdds.Reset();
+    PendingReplicatedChanges.Reset();
+    PendingReplicatedRemoves.Reset();
+    FlushPendingChanges();
+}
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitCommandQueue.h"
+
+void FInventoryKitCommandQueue::FCommand::Complete(FInventoryKitCommandResult&& Result)
+{
+    if (Callback)
+    {
+        Callback(Result);
+    }
+    if (Promise)
+    {
+        Promise->SetValue(MoveTemp(Result));
+    }
+}
+
+TFuture<FInventoryKitCommandResult> FInventoryKitCommandQueue::Submit(FInventoryKitTransaction&& Transaction)
+{
+    FCommand Command;
+    Command.Transaction = MoveTemp(Transaction);
+    Command.Promise = MakeUnique<TPromise<FInventoryKitCommandResult>>();
+    TFuture<FInventoryKitCommandResult> Future = Command.Promise->GetFuture();
+
+    // 先计数再入队, 消费方看到的数量不会少于可取出的命令
+    NumPending.fetch_add(1, std::memory_order_relaxed);
+    Commands.Enqueue(MoveTemp(Command));
+    return Future;
+}
+
+void FInventoryKitCommandQueue::Submit(FInventoryKitTransaction&& Transaction, FCallback&& Callback)
+{
+    FCommand Command;
+    Command.Transaction = MoveTemp(Transaction);
+    Command.Callback = MoveTemp(Callback);
+
+    NumPending.fetch_add(1, std::memory_order_relaxed);
+    Commands.Enqueue(MoveTemp(Command));
+}
+
+int32 FInventoryKitCommandQueue::Drain(FExecuteFunc Execute, int32 MaxCommands)
+{
+    int32 Budget = NumPending.load(std::memory_order_relaxed);
+    if (MaxCommands > 0)
+    {
+        Budget = FMath::Min(Budget, MaxCommands);
+    }
+
+    int32 NumProcessed = 0;
+    FCommand Command;
+    while (NumProcessed < Budget && Commands.Dequeue(Command))
+    {
+        NumPending.fetch_sub(1, std::memory_order_relaxed);
+        ++NumProcessed;
+
+        FInventoryKitCommandResult Result;
+        Result.bSucceeded = Execute(Command.Transaction, Result.CreatedItemIds);
+        Command.Complete(MoveTemp(Result));
+    }
+    return NumProcessed;
+}
+
+void FInventoryKitCommandQueue::CancelAll()
+{
+    FCommand Command;
+    while (Commands.Dequeue(Command))
+    {
+        NumPending.fetch_sub(1, std::memory_order_relaxed);
+        Command.Complete(FInventoryKitCommandResult());
+    }
+}
@@ -0,0 +1,225 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitItemCatalog.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogInventoryKitCatalog, Log, All);
+
+FInventoryKitItemCatalog::~FInventoryKitItemCatalog()
+{
+    // 先释放映射区域再关闭文件
+    MappedRegion.Reset();
+    MappedHandle.Reset();
+}
+
+TUniquePtr<FInventoryKitItemCatalog> FInventoryKitItemCatalog::Open(const FString& Path)
+{
+    TUniquePtr<FInventoryKitItemCatalog> Catalog(new FInventoryKitItemCatalog());
+    Catalog->MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+    if (!Catalog->MappedHandle)
+    {
+        UE_LOG(LogInventoryKitCatalog, Error, TEXT("Failed to map item catalog %s."), *Path);
+        return nullptr;
+    }
+
+    const int64 FileSize = Catalog->MappedHandle->GetFileSize();
+    if (FileSize < static_cast<int64>(sizeof(FHeader)))
+    {
+        UE_LOG(LogInventoryKitCatalog, Error, TEXT("Item catalog %s is too small."), *Path);
+        return nullptr;
+    }
+
+    Catalog->MappedRegion.Reset(Catalog->MappedHandle->MapRegion(0, FileSize));
+    if (!Catalog->MappedRegion)
+    {
+        UE_LOG(LogInventoryKitCatalog, Error, TEXT("Failed to map region of item catalog %s."), *Path);
+        return nullptr;
+    }
+
+    // 只校验文件头和各段范围, 不遍历记录
+    const uint8* Data = Catalog->MappedRegion->GetMappedPtr();
+    const FHeader* Header = reinterpret_cast<const FHeader*>(Data);
+    const uint64 RecordsEnd = Header->RecordsOffset + static_cast<uint64>(FMath::Max(Header->RecordCount, 0)) * sizeof(FInventoryKitCatalogRecord);
+    if (Header->Magic != FileMagic || Header->Version != FileVersion || Header->RecordSize != sizeof(FInventoryKitCatalogRecord)
+        || Header->RecordCount < 0 || Header->RecordsOffset % alignof(FInventoryKitCatalogRecord) != 0
+        || RecordsEnd > static_cast<uint64>(FileSize) || Header->StringPoolOffset < RecordsEnd
+        || Header->StringPoolOffset + Header->StringPoolSize > static_cast<uint64>(FileSize))
+    {
+        UE_LOG(LogInventoryKitCatalog, Error, TEXT("Invalid item catalog header in %s."), *Path);
+        return nullptr;
+    }
+
+    Catalog->Header = Header;
+    Catalog->Records = reinterpret_cast<const FInventoryKitCatalogRecord*>(Data + Header->RecordsOffset);
+    Catalog->StringPool = Data + Header->StringPoolOffset;
+    return Catalog;
+}
+
+const FInventoryKitCatalogRecord* FInventoryKitItemCatalog::Find(int32 DefinitionID) const
+{
+    const int32 RecordCount = Header->RecordCount;
+    if (RecordCount == 0)
+    {
+        return nullptr;
+    }
+
+    if (Header->Flags & Flag_DenseIDs)
+    {
+        const int64 Index = static_cast<int64>(DefinitionID) - Records[0].DefinitionID;
+        return Index >= 0 && Index < RecordCount ? &Records[Index] : nullptr;
+    }
+
+    const int32 Index = Algo::LowerBoundBy(GetRecords(), DefinitionID, &FInventoryKitCatalogRecord::DefinitionID);
+    return Index < RecordCount && Records[Index].DefinitionID == DefinitionID ? &Records[Index] : nullptr;
+}
+
+int32 FInventoryKitItemCatalog::Num() const
+{
+    return Header->RecordCount;
+}
+
+TConstArrayView<FInventoryKitCatalogRecord> FInventoryKitItemCatalog::GetRecords() const
+{
+    return TConstArrayView<FInventoryKitCatalogRecord>(Records, Header->RecordCount);
+}
+
+FUtf8StringView FInventoryKitItemCatalog::GetNameView(const FInventoryKitCatalogRecord& Record) const
+{
+    return GetPoolString(Record.NameOffset);
+}
+
+FString FInventoryKitItemCatalog::GetName(const FInventoryKitCatalogRecord& Record) const
+{
+    const FUtf8StringView Name = GetNameView(Record);
+    return FString(Name.Len(), Name.GetData());
+}
+
+void FInventoryKitItemCatalog::GetTags(const FInventoryKitCatalogRecord& Record, FGameplayTagContainer& OutTags) const
+{
+    OutTags.Reset();
+    const uint64 TagListEnd = static_cast<uint64>(Record.TagListOffset) + static_cast<uint64>(Record.TagCount) * sizeof(uint32);
+    if (TagListEnd > Header->StringPoolSize)
+    {
+        return;
+    }
+
+    const uint8* TagList = StringPool + Record.TagListOffset;
+    for (uint32 TagIndex = 0; TagIndex < Record.TagCount; ++TagIndex)
+    {
+        uint32 TagOffset;
+        FMemory::Memcpy(&TagOffset, TagList + TagIndex * sizeof(uint32), sizeof(uint32));
+        const FUtf8StringView TagName = GetPoolString(TagOffset);
+        const FGameplayTag Tag = FGameplayTag::RequestGameplayTag(FName(FString(TagName.Len(), TagName.GetData())), false);
+        if (Tag.IsValid())
+        {
+            OutTags.AddTagFast(Tag);
+        }
+    }
+}
+
+FUtf8StringView FInventoryKitItemCatalog::GetPoolString(uint32 Offset) const
+{
+    if (Offset >= Header->StringPoolSize)
+    {
+        return FUtf8StringView();
+    }
+
+    const UTF8CHAR* String = reinterpret_cast<const UTF8CHAR*>(StringPool + Offset);
+    const int32 MaxLen = static_cast<int32>(FMath::Min<uint64>(Header->StringPoolSize - Offset, MAX_int32));
+    int32 Len = 0;
+    while (Len < MaxLen && String[Len] != 0)
+    {
+        ++Len;
+    }
+    return FUtf8StringView(String, Len);
+}
+
+bool FInventoryKitItemCatalog::Write(const FString& Path, TArray<FInventoryKitCatalogEntry> Entries)
+{
+    Entries.Sort([](const FInventoryKitCatalogEntry& A, const FInventoryKitCatalogEntry& B)
+    {
+        return A.DefinitionID < B.DefinitionID;
+    });
+
+    bool bDenseIDs = true;
+    for (int32 Index = 1; Index < Entries.Num(); ++Index)
+    {
+        if (Entries[Index].DefinitionID == Entries[Index - 1].DefinitionID)
+        {
+            UE_LOG(LogInventoryKitCatalog, Error, TEXT("Duplicate definition id %d in item catalog."), Entries[Index].DefinitionID);
+            return false;
+        }
+        bDenseIDs &= Entries[Index].DefinitionID == Entries[Index - 1].DefinitionID + 1;
+    }
+
+    // 字符串池: 相同字符串只存一份, 标签列表按4字节对齐
+    TArray<uint8> StringPool;
+    TMap<FString, uint32> StringOffsets;
+    auto AddString = [&StringPool, &StringOffsets](const FString& String) -> uint32
+    {
+        if (const uint32* Offset = StringOffsets.Find(String))
+        {
+            return *Offset;
+        }
+        const uint32 Offset = StringPool.Num();
+        const FTCHARToUTF8 Converted(*String);
+        StringPool.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+        StringPool.Add(0);
+        StringOffsets.Add(String, Offset);
+        return Offset;
+    };
+
+    TArray<FInventoryKitCatalogRecord> Records;
+    Records.SetNumZeroed(Entries.Num());
+    TArray<uint32> TagOffsets;
+    for (int32 Index = 0; Index < Entries.Num(); ++Index)
+    {
+        const FInventoryKitCatalogEntry& Entry = Entries[Index];
+        FInventoryKitCatalogRecord& Record = Records[Index];
+        Record.DefinitionID = Entry.DefinitionID;
+        Record.MaxStackSize = FMath::Max(1, Entry.MaxStackSize);
+        Record.Weight = Entry.Weight;
+        Record.Volume = Entry.Volume;
+        Record.SizeX = FMath::Max(1, Entry.Size.X);
+        Record.SizeY = FMath::Max(1, Entry.Size.Y);
+        Record.NameOffset = AddString(Entry.Name);
+
+        TagOffsets.Reset();
+        for (const FGameplayTag& Tag : Entry.Tags)
+        {
+            TagOffsets.Add(AddString(Tag.ToString()));
+        }
+        StringPool.SetNumZeroed(Align(StringPool.Num(), sizeof(uint32)));
+        Record.TagListOffset = StringPool.Num();
+        Record.TagCount = TagOffsets.Num();
+        StringPool.Append(reinterpret_cast<const uint8*>(TagOffsets.GetData()), TagOffsets.Num() * sizeof(uint32));
+    }
+
+    FHeader Header;
+    FMemory::Memzero(Header);
+    Header.Magic = FileMagic;
+    Header.Version = FileVersion;
+    Header.RecordCount = Records.Num();
+    Header.RecordSize = sizeof(FInventoryKitCatalogRecord);
+    Header.Flags = bDenseIDs ? Flag_DenseIDs : 0;
+    Header.RecordsOffset = Align(sizeof(FHeader), alignof(FInventoryKitCatalogRecord));
+    Header.StringPoolOffset = Header.RecordsOffset + Records.Num() * sizeof(FInventoryKitCatalogRecord);
+    Header.StringPoolSize = StringPool.Num();
+
+    TArray<uint8> FileData;
+    FileData.SetNumZeroed(Header.StringPoolOffset);
+    FMemory::Memcpy(FileData.GetData(), &Header, sizeof(FHeader));
+    FMemory::Memcpy(FileData.GetData() + Header.RecordsOffset, Records.GetData(), Records.Num() * sizeof(FInventoryKitCatalogRecord));
+    FileData.Append(StringPool);
+
+    if (!FFileHelper::SaveArrayToFile(FileData, *Path))
+    {
+        UE_LOG(LogInventoryKitCatalog, Error, TEXT("Failed to write item catalog %s."), *Path);
+        return false;
+    }
+    return true;
+}
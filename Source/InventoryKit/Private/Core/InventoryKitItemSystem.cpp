@@ -3,28 +3,50 @@
 #include "Core/InventoryKitItemSystem.h"
 
 #include "ContainerSpace/ContainerSpaceManager.h"
+#include "Core/InventoryKitSnapshot.h"
 #include "Core/InventoryKitVoidContainer.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 
 void UInventoryKitItemSystem::Initialize(FSubsystemCollectionBase& Collection)
 {
     Super::Initialize(Collection);
-    ItemMap.Empty();
+    ItemStore.Empty();
     VoidContainer = NewObject<UInventoryKitVoidContainer>(this);
     RegisterContainer(VoidContainer);
     VoidContainerID = VoidContainer->GetContainerID();
+    PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ThisClass::HandlePostActorTick);
 }
 
 void UInventoryKitItemSystem::Deinitialize()
 {
-    ItemMap.Empty();
+    CommandQueue.CancelAll();
+    CloseJournal();
+    FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+    PostActorTickHandle.Reset();
+    DirtyContainers.Empty();
+    ItemStore.Empty();
     ContainerMap.Empty();
+    ContainerItemIndex.Empty();
+    PartialStackIndex.Empty();
+    ContainerHostItems.Empty();
+    ItemHostedContainers.Empty();
+    TagIndex.Reset();
+    DefinitionTagCache.Empty();
+    ItemCatalog.Reset();
+    WorldView.Reset();
+    ViewDirtyItems.Empty();
+    ViewDirtyContainers.Empty();
+    SpaceManagerPools.Empty();
     Super::Deinitialize();
 }
 
 bool UInventoryKitItemSystem::GetItemLocation(int32 ItemId, FItemLocation& OutLocation) const
 {
-    if (const FItemBaseInstance* Location = ItemMap.Find(ItemId))
+    if (const FItemBaseInstance* Location = ItemStore.Find(ItemId))
     {
         OutLocation = Location->ItemLocation;
         return true;
@@ -34,21 +56,22 @@ bool UInventoryKitItemSystem::GetItemLocation(int32 ItemId, FItemLocation& OutLo
 
 bool UInventoryKitItemSystem::MoveItem(int32 ItemId, const FItemLocation& TargetLocation)
 {
-    if (!ItemMap.Contains(ItemId))
+    FItemBaseInstance* Item = ItemStore.Find(ItemId);
+    if (!Item)
     {
         UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d not found!"), ItemId);
         return false;
     }
     
     // 验证物品当前位置
-    FItemBaseInstance CopyOldItem = ItemMap[ItemId];
-    if (!ContainerMap.Contains(TargetLocation.ContainerID))
+    FItemBaseInstance CopyOldItem = *Item;
+    IInventoryKitContainerInterface* TargetContainer = FindContainer(TargetLocation.ContainerID);
+    if (!TargetContainer)
     {
         UE_LOG(LogInventoryKitSystem, Error, TEXT("Target container %d not found!"), TargetLocation.ContainerID);
         return false;
     }
     
-    auto TargetContainer = ContainerMap[TargetLocation.ContainerID];
     if (CopyOldItem.ItemLocation.ContainerID != TargetLocation.ContainerID && !TargetContainer->CanAddItem(CopyOldItem, TargetLocation.SlotIndex))
     {
         UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot add item %d to container %d!"), ItemId, TargetLocation.ContainerID);
@@ -61,80 +84,2752 @@ bool UInventoryKitItemSystem::MoveItem(int32 ItemId, const FItemLocation& Target
         UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot move item %d to container %d!"), ItemId, TargetLocation.ContainerID);
         return false;
     }
+
+    // 嵌套容器: 不能放进自己承载的容器内部, 祖先容器也要能承受负重
+    if (!IsSameContainer && ContainerHostItems.Num() > 0)
+    {
+        const int32* HostedContainerID = ItemHostedContainers.Find(ItemId);
+        if (HostedContainerID && WouldCreateCycle(*HostedContainerID, TargetLocation.ContainerID, [this](int32 Id) { return GetItemContainerID(Id); }))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot move item %d into its own container %d!"), ItemId, *HostedContainerID);
+            return false;
+        }
+        if (!CanContainersAcceptLoad(CopyOldItem.ItemLocation.ContainerID, TargetLocation.ContainerID, GetItemLoad(CopyOldItem) + GetHostedLoad(ItemId)))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Parent containers of %d cannot accept item %d!"), TargetLocation.ContainerID, ItemId);
+            return false;
+        }
+    }
+    
+    ApplyMove(*Item, TargetLocation, TargetContainer);
+    return true;
+}
+
+void UInventoryKitItemSystem::ApplyMove(FItemBaseInstance& Item, const FItemLocation& TargetLocation, IInventoryKitContainerInterface* TargetContainer)
+{
+    const FItemBaseInstance CopyOldItem = Item;
+    RecordJournal(FInventoryKitJournalRecord::MakeMove(Item.ItemID, TargetLocation));
+    MarkItemViewDirty(Item.ItemID);
     
     // 更新位置
-    ItemMap[ItemId].ItemLocation = TargetLocation;
+    Item.ItemLocation = TargetLocation;
     
-    if (IsSameContainer)
+    if (CopyOldItem.ItemLocation.ContainerID == TargetLocation.ContainerID)
     {
-        TargetContainer->OnItemMoved(CopyOldItem.ItemLocation, ItemMap[ItemId]);
+        TargetContainer->OnItemMoved(CopyOldItem.ItemLocation, Item);
+        MarkContainerDirty(TargetLocation.ContainerID);
     }
     else
     {
-        if (ContainerMap.Contains(CopyOldItem.ItemLocation.ContainerID))
+        if (FInventoryKitItemIdSet* OldContainerItems = ContainerItemIndex.Find(CopyOldItem.ItemLocation.ContainerID))
+        {
+            OldContainerItems->Remove(CopyOldItem.ItemID);
+        }
+        ContainerItemIndex.FindOrAdd(TargetLocation.ContainerID).Add(CopyOldItem.ItemID);
+        UnindexPartialStack(CopyOldItem);
+        IndexPartialStack(Item);
+        RollUpItemMove(CopyOldItem, TargetLocation.ContainerID);
+        
+        if (IInventoryKitContainerInterface* OldContainer = FindContainer(CopyOldItem.ItemLocation.ContainerID))
+        {
+            OldContainer->OnItemRemoved(CopyOldItem);
+            MarkContainerDirty(CopyOldItem.ItemLocation.ContainerID);
+        }
+        TargetContainer->OnItemAdded(Item);
+        MarkContainerDirty(TargetLocation.ContainerID);
+    }
+}
+
+bool UInventoryKitItemSystem::MoveItems(const TArray<FItemMoveRequest>& Requests)
+{
+    // 批次内涉及的容器, 每个容器只解析一次
+    struct FBatchContainer
+    {
+        int32 ContainerID = INDEX_NONE;
+        IInventoryKitContainerInterface* Container = nullptr;
+        UContainerSpaceManager* SpaceManager = nullptr;
+        TArray<FItemBaseInstance> Removed;
+        TArray<FItemBaseInstance> Added;
+        TArray<FItemLocation> MovedFrom;
+        TArray<FItemBaseInstance> Moved;
+    };
+
+    // 单个请求解析后的结果
+    struct FResolvedMove
+    {
+        FItemBaseInstance* Item = nullptr;
+        int32 SourceIndex = INDEX_NONE;
+        int32 TargetIndex = INDEX_NONE;
+    };
+
+    TArray<FBatchContainer> BatchContainers;
+    TMap<int32, int32> ContainerToBatchIndex;
+    auto ResolveContainer = [&](int32 ContainerID) -> int32
+    {
+        if (const int32* Found = ContainerToBatchIndex.Find(ContainerID))
+        {
+            return *Found;
+        }
+        IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+        if (!Container)
+        {
+            return INDEX_NONE;
+        }
+        const int32 NewIndex = BatchContainers.AddDefaulted();
+        BatchContainers[NewIndex].ContainerID = ContainerID;
+        BatchContainers[NewIndex].Container = *Container;
+        BatchContainers[NewIndex].SpaceManager = (*Container)->GetSpaceManager();
+        ContainerToBatchIndex.Add(ContainerID, NewIndex);
+        return NewIndex;
+    };
+
+    // 获取独占槽位容器中物品占用的所有槽位, 非独占容器返回false
+    TArray<int32> FootprintSlots;
+    auto GetExclusiveSlots = [&FootprintSlots](const FBatchContainer& BatchContainer, const FItemBaseInstance& InItem, int32 SlotIndex) -> bool
+    {
+        if (!BatchContainer.SpaceManager || !BatchContainer.SpaceManager->IsSlotExclusive())
+        {
+            return false;
+        }
+        return BatchContainer.SpaceManager->GetFootprintSlots(SlotIndex, InItem.GetFootprint(), FootprintSlots);
+    };
+
+    // 校验阶段: 不修改任何状态, 与ValidateTransaction相同地按暂存变化校验
+    // 先释放批次内所有物品的原位置, 再逐个占用目标位置, 批次内的互换和腾挪与整批应用后的结果一致
+    TArray<FResolvedMove> Moves;
+    Moves.Reserve(Requests.Num());
+    TSet<int32> SeenItems;
+    SeenItems.Reserve(Requests.Num());
+    TMap<int32, FInventoryKitStagedContainerDelta> StagedContainers;
+    for (const FItemMoveRequest& Request : Requests)
+    {
+        FResolvedMove& Move = Moves.AddDefaulted_GetRef();
+        Move.Item = ItemStore.Find(Request.ItemID);
+        if (!Move.Item)
+        {
+            UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d not found!"), Request.ItemID);
+            return false;
+        }
+
+        bool bAlreadyInBatch = false;
+        SeenItems.Add(Request.ItemID, &bAlreadyInBatch);
+        if (bAlreadyInBatch)
+        {
+            UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d appears more than once in batch!"), Request.ItemID);
+            return false;
+        }
+
+        Move.TargetIndex = ResolveContainer(Request.TargetLocation.ContainerID);
+        if (Move.TargetIndex == INDEX_NONE)
+        {
+            UE_LOG(LogInventoryKitSystem, Error, TEXT("Target container %d not found!"), Request.TargetLocation.ContainerID);
+            return false;
+        }
+        Move.SourceIndex = ResolveContainer(Move.Item->ItemLocation.ContainerID);
+        if (Move.SourceIndex == INDEX_NONE)
+        {
+            continue;
+        }
+
+        FInventoryKitStagedContainerDelta& Delta = StagedContainers.FindOrAdd(Move.Item->ItemLocation.ContainerID);
+        if (GetExclusiveSlots(BatchContainers[Move.SourceIndex], *Move.Item, Move.Item->ItemLocation.SlotIndex))
+        {
+            for (const int32 Slot : FootprintSlots)
+            {
+                Delta.ReleaseSlot(Slot);
+            }
+        }
+        if (Move.SourceIndex != Move.TargetIndex)
+        {
+            ++Delta.RemovedCount;
+            Delta.RemovedLoad += GetItemLoad(*Move.Item);
+        }
+    }
+
+    FContainerChain GainContainers;
+    bool bMovesHostItem = false;
+    for (int32 Index = 0; Index < Requests.Num(); ++Index)
+    {
+        const FItemMoveRequest& Request = Requests[Index];
+        const FResolvedMove& Move = Moves[Index];
+        const FItemLocation& TargetLocation = Request.TargetLocation;
+        const FBatchContainer& Target = BatchContainers[Move.TargetIndex];
+        const bool IsSameContainer = Move.SourceIndex == Move.TargetIndex;
+
+        FInventoryKitStagedContainerDelta& Delta = StagedContainers.FindOrAdd(TargetLocation.ContainerID);
+        const bool bCanEnter = IsSameContainer
+            ? Target.Container->CanMoveItemStaged(*Move.Item, TargetLocation.SlotIndex, Delta)
+            : Target.Container->CanAddItemStaged(*Move.Item, TargetLocation.SlotIndex, Delta);
+        if (!bCanEnter)
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot place item %d to container %d in batch!"), Request.ItemID, TargetLocation.ContainerID);
+            return false;
+        }
+
+        // 容器的暂存检查可能被项目重写, 这里再兜底检查批次内的槽位冲突
+        if (GetExclusiveSlots(Target, *Move.Item, TargetLocation.SlotIndex))
+        {
+            for (const int32 Slot : FootprintSlots)
+            {
+                if (Delta.ClaimedSlots.Contains(Slot))
+                {
+                    UE_LOG(LogInventoryKitSystem, Warning, TEXT("Slot %d of container %d is targeted more than once in batch!"), Slot, TargetLocation.ContainerID);
+                    return false;
+                }
+            }
+            for (const int32 Slot : FootprintSlots)
+            {
+                Delta.ClaimSlot(Slot);
+            }
+        }
+        if (IsSameContainer)
+        {
+            continue;
+        }
+        const FInventoryKitLoad ItemLoad = GetItemLoad(*Move.Item);
+        ++Delta.AddedCount;
+        Delta.AddedLoad += ItemLoad;
+
+        // 嵌套容器: 负重同样计入目标的祖先容器, 承载容器的物品之后还要检查是否成环
+        if (ContainerHostItems.Num() > 0)
+        {
+            const FInventoryKitLoad HostedLoad = GetHostedLoad(Request.ItemID);
+            GetLoadGainContainers(Move.Item->ItemLocation.ContainerID, TargetLocation.ContainerID, GainContainers);
+            for (const int32 ContainerID : GainContainers)
+            {
+                // 目标容器自身已在CanAddItemStaged中计入物品负重
+                FInventoryKitStagedContainerDelta& GainDelta = StagedContainers.FindOrAdd(ContainerID);
+                GainDelta.AddedLoad += ContainerID == TargetLocation.ContainerID ? HostedLoad : ItemLoad + HostedLoad;
+                if (!FindContainer(ContainerID)->CanAcceptLoad(GainDelta.AddedLoad - GainDelta.RemovedLoad))
+                {
+                    UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d is overloaded for batch!"), ContainerID);
+                    return false;
+                }
+            }
+            if (ItemHostedContainers.Contains(Request.ItemID))
+            {
+                bMovesHostItem = true;
+            }
+        }
+    }
+
+    // 按整批移动后的位置检查承载容器的物品是否成环
+    if (bMovesHostItem)
+    {
+        TMap<int32, int32> StagedContainers;
+        for (int32 Index = 0; Index < Requests.Num(); ++Index)
+        {
+            StagedContainers.Add(Requests[Index].ItemID, Requests[Index].TargetLocation.ContainerID);
+        }
+        auto GetStagedContainer = [this, &StagedContainers](int32 Id)
+        {
+            const int32* StagedContainer = StagedContainers.Find(Id);
+            return StagedContainer ? *StagedContainer : GetItemContainerID(Id);
+        };
+        for (const FItemMoveRequest& Request : Requests)
+        {
+            const int32* HostedContainerID = ItemHostedContainers.Find(Request.ItemID);
+            if (HostedContainerID && WouldCreateCycle(*HostedContainerID, Request.TargetLocation.ContainerID, GetStagedContainer))
+            {
+                UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot move item %d into its own container %d!"), Request.ItemID, *HostedContainerID);
+                return false;
+            }
+        }
+    }
+
+    // 先确保所有目标容器都有索引条目, 之后取到的指针不会因扩容失效
+    for (const FBatchContainer& BatchContainer : BatchContainers)
+    {
+        ContainerItemIndex.FindOrAdd(BatchContainer.ContainerID);
+    }
+    TArray<FInventoryKitItemIdSet*> BatchIndices;
+    BatchIndices.Reserve(BatchContainers.Num());
+    for (const FBatchContainer& BatchContainer : BatchContainers)
+    {
+        BatchIndices.Add(ContainerItemIndex.Find(BatchContainer.ContainerID));
+    }
+
+    // 应用阶段: 更新位置并按容器收集通知
+    RecordJournal(FInventoryKitJournalRecord::MakeMoveBatch(Requests.Num()));
+    for (int32 Index = 0; Index < Requests.Num(); ++Index)
+    {
+        const FResolvedMove& Move = Moves[Index];
+        const FItemBaseInstance OldItem = *Move.Item;
+        Move.Item->ItemLocation = Requests[Index].TargetLocation;
+        RecordJournal(FInventoryKitJournalRecord::MakeMove(OldItem.ItemID, Move.Item->ItemLocation));
+        MarkItemViewDirty(OldItem.ItemID);
+
+        FBatchContainer& Target = BatchContainers[Move.TargetIndex];
+        if (Move.SourceIndex == Move.TargetIndex)
+        {
+            Target.MovedFrom.Add(OldItem.ItemLocation);
+            Target.Moved.Add(*Move.Item);
+            continue;
+        }
+
+        if (Move.SourceIndex != INDEX_NONE)
+        {
+            BatchIndices[Move.SourceIndex]->Remove(OldItem.ItemID);
+            BatchContainers[Move.SourceIndex].Removed.Add(OldItem);
+        }
+        else if (FInventoryKitItemIdSet* OldContainerItems = ContainerItemIndex.Find(OldItem.ItemLocation.ContainerID))
+        {
+            OldContainerItems->Remove(OldItem.ItemID);
+        }
+        BatchIndices[Move.TargetIndex]->Add(OldItem.ItemID);
+        UnindexPartialStack(OldItem);
+        IndexPartialStack(*Move.Item);
+        Target.Added.Add(*Move.Item);
+
+        // 移动了承载容器的物品时嵌套关系在批次中途可能暂时成环, 之后整体重建
+        if (!bMovesHostItem)
+        {
+            RollUpItemMove(OldItem, Move.Item->ItemLocation.ContainerID);
+        }
+    }
+
+    // 通知阶段: 先移除, 再容器内移动, 最后添加, 保证槽位先释放后占用
+    for (FBatchContainer& BatchContainer : BatchContainers)
+    {
+        if (BatchContainer.Removed.Num() > 0)
+        {
+            BatchContainer.Container->OnItemsRemoved(BatchContainer.Removed);
+        }
+    }
+    for (FBatchContainer& BatchContainer : BatchContainers)
+    {
+        if (BatchContainer.Moved.Num() > 0)
+        {
+            BatchContainer.Container->OnItemsMoved(BatchContainer.MovedFrom, BatchContainer.Moved);
+        }
+    }
+    for (FBatchContainer& BatchContainer : BatchContainers)
+    {
+        if (BatchContainer.Added.Num() > 0)
         {
-            ContainerMap[CopyOldItem.ItemLocation.ContainerID]->OnItemRemoved(CopyOldItem);
+            BatchContainer.Container->OnItemsAdded(BatchContainer.Added);
         }
-        TargetContainer->OnItemAdded(ItemMap[ItemId]);
+    }
+    if (bMovesHostItem)
+    {
+        RebuildNestedLoads();
+    }
+    for (const FBatchContainer& BatchContainer : BatchContainers)
+    {
+        MarkContainerDirty(BatchContainer.ContainerID);
     }
     
     return true;
 }
 
-int32 UInventoryKitItemSystem::IntervalCreateItem(const FItemLocation& Location, bool bNotify)
+bool UInventoryKitItemSystem::SetItemRotated(int32 ItemId, bool bInRotated)
 {
-    // 生成新的物品ID
-    int32 NewItemId = NextItemID++;
+    FItemBaseInstance* Item = ItemStore.Find(ItemId);
+    if (!Item)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d not found!"), ItemId);
+        return false;
+    }
+    
+    if (Item->bRotated == bInRotated)
+    {
+        return true;
+    }
 
-    // 创建物品实例
-    FItemBaseInstance NewItem;
-    NewItem.ItemID = NewItemId;
-    NewItem.ItemLocation = Location;
+    IInventoryKitContainerInterface* const* Container = ContainerMap.Find(Item->ItemLocation.ContainerID);
+    if (!Container)
+    {
+        Item->bRotated = bInRotated;
+        RecordJournal(FInventoryKitJournalRecord::MakeSetRotated(ItemId, bInRotated));
+        MarkItemViewDirty(ItemId);
+        return true;
+    }
+    
+    // 旋转后的区域不能与其他物品重叠, 物品自身当前的占用视为空闲
+    const FItemBaseInstance CopyOldItem = *Item;
+    FItemBaseInstance RotatedItem = CopyOldItem;
+    RotatedItem.bRotated = bInRotated;
+    const UContainerSpaceManager* SpaceManager = (*Container)->GetSpaceManager();
+    if (SpaceManager && !SpaceManager->IsFootprintAvailable(CopyOldItem.ItemLocation.SlotIndex, RotatedItem.GetFootprint(), CopyOldItem.ItemLocation.SlotIndex, CopyOldItem.GetFootprint()))
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot rotate item %d in container %d!"), ItemId, CopyOldItem.ItemLocation.ContainerID);
+        return false;
+    }
 
-    // 添加到映射表
-    ItemMap.Add(NewItemId, NewItem);
+    // 占用区域变化, 以先移除后添加的方式通知容器
+    Item->bRotated = bInRotated;
+    RecordJournal(FInventoryKitJournalRecord::MakeSetRotated(ItemId, bInRotated));
+    MarkItemViewDirty(ItemId);
+    (*Container)->OnItemRemoved(CopyOldItem);
+    (*Container)->OnItemAdded(RotatedItem);
+    MarkContainerDirty(CopyOldItem.ItemLocation.ContainerID);
+    return true;
+}
 
-    if (bNotify && ContainerMap.Contains(Location.ContainerID))
+bool UInventoryKitItemSystem::MergeStacks(int32 SourceItemId, int32 TargetItemId)
+{
+    FItemBaseInstance* SourceItem = ItemStore.Find(SourceItemId);
+    FItemBaseInstance* TargetItem = ItemStore.Find(TargetItemId);
+    if (!SourceItem || !TargetItem || SourceItemId == TargetItemId)
     {
-        ContainerMap[Location.ContainerID]->OnItemAdded(NewItem);
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Cannot merge item %d into item %d!"), SourceItemId, TargetItemId);
+        return false;
     }
-    
-    return NewItemId;
+
+    if (SourceItem->DefinitionID == INDEX_NONE || SourceItem->DefinitionID != TargetItem->DefinitionID)
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Item %d and item %d are not the same definition!"), SourceItemId, TargetItemId);
+        return false;
+    }
+
+    const int32 MaxStackSize = GetMaxStackSize(TargetItem->DefinitionID);
+    const int32 Transfer = FMath::Min(SourceItem->Quantity, MaxStackSize - TargetItem->Quantity);
+    if (Transfer <= 0)
+    {
+        return false;
+    }
+
+    // 跨容器合并时目标容器及其祖先的负重增加
+    FItemBaseInstance TransferItem = *SourceItem;
+    TransferItem.Quantity = Transfer;
+    if (!CanContainersAcceptLoad(SourceItem->ItemLocation.ContainerID, TargetItem->ItemLocation.ContainerID, GetItemLoad(TransferItem)))
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d cannot accept merged load!"), TargetItem->ItemLocation.ContainerID);
+        return false;
+    }
+
+    const int32 SourceQuantity = SourceItem->Quantity;
+    SetItemQuantity(*TargetItem, TargetItem->Quantity + Transfer);
+    if (Transfer == SourceQuantity)
+    {
+        IntervalDestroyItem(SourceItemId);
+    }
+    else
+    {
+        // 容器回调中可能创建物品导致存储扩容, 重新查找源堆叠
+        SetItemQuantity(*ItemStore.Find(SourceItemId), SourceQuantity - Transfer);
+    }
+    return true;
 }
 
-TArray<int32> UInventoryKitItemSystem::GetItemsInContainer(int32 Identifier) const
+int32 UInventoryKitItemSystem::SplitStack(int32 ItemId, int32 Count, const FItemLocation& TargetLocation)
 {
-    TArray<int32> Result;
-    for (const auto& Pair : ItemMap)
+    FItemBaseInstance* Item = ItemStore.Find(ItemId);
+    if (!Item)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d not found!"), ItemId);
+        return INDEX_NONE;
+    }
+
+    if (Count <= 0 || Count >= Item->Quantity)
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot split %d from item %d with quantity %d!"), Count, ItemId, Item->Quantity);
+        return INDEX_NONE;
+    }
+
+    IInventoryKitContainerInterface* const* TargetContainer = ContainerMap.Find(TargetLocation.ContainerID);
+    if (!TargetContainer)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Target container %d not found!"), TargetLocation.ContainerID);
+        return INDEX_NONE;
+    }
+
+    // 新堆叠继承原物品的数据
+    FItemBaseInstance Template = *Item;
+    Template.ItemID = INDEX_NONE;
+    Template.ItemLocation = TargetLocation;
+    Template.Quantity = Count;
+    if (!(*TargetContainer)->CanAddItem(Template, TargetLocation.SlotIndex)
+        || (ContainerHostItems.Num() > 0 && !CanContainersAcceptLoad(Item->ItemLocation.ContainerID, TargetLocation.ContainerID, GetItemLoad(Template))))
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot add split stack to container %d!"), TargetLocation.ContainerID);
+        return INDEX_NONE;
+    }
+
+    SetItemQuantity(*Item, Item->Quantity - Count);
+    return IntervalCreateItemFromTemplate(MoveTemp(Template));
+}
+
+int32 UInventoryKitItemSystem::AddStackableItems(int32 DefinitionID, int32 Count, int32 ContainerID)
+{
+    IInventoryKitContainerInterface* const* ContainerPtr = ContainerMap.Find(ContainerID);
+    if (!ContainerPtr || Count <= 0)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Cannot add %d of definition %d to container %d!"), Count, DefinitionID, ContainerID);
+        return 0;
+    }
+    IInventoryKitContainerInterface* Container = *ContainerPtr;
+
+    const int32 MaxStackSize = FMath::Max(1, GetMaxStackSize(DefinitionID));
+
+    // 按容器及其祖先的剩余负重和体积限制数量
+    FItemBaseInstance UnitItem = MakeItemTemplate(DefinitionID);
+    UnitItem.Quantity = 1;
+    const FInventoryKitLoad UnitLoad = GetItemLoad(UnitItem);
+    int32 Acceptable = FMath::Min(Count, Container->GetAcceptableQuantity(UnitLoad, Count));
+    if (ContainerHostItems.Num() > 0)
     {
-        if (Pair.Value.ItemLocation.ContainerID == Identifier)
+        FContainerChain Ancestors;
+        GetLoadGainContainers(INDEX_NONE, ContainerID, Ancestors);
+        for (int32 ChainIndex = 1; ChainIndex < Ancestors.Num(); ++ChainIndex)
         {
-            Result.Add(Pair.Key);
+            Acceptable = FMath::Min(Acceptable, FindContainer(Ancestors[ChainIndex])->GetAcceptableQuantity(UnitLoad, Acceptable));
         }
     }
-    return Result;
+    int32 Remaining = Acceptable;
+
+    // 优先填充已有的未满堆叠
+    if (const TMap<int32, FInventoryKitItemIdSet>* StacksByDefinition = PartialStackIndex.Find(ContainerID))
+    {
+        if (const FInventoryKitItemIdSet* PartialStacks = StacksByDefinition->Find(DefinitionID))
+        {
+            // 填满的堆叠会从索引中移除, 这里遍历副本
+            const TArray<int32> PartialStackIds = PartialStacks->GetItems();
+            for (const int32 StackId : PartialStackIds)
+            {
+                FItemBaseInstance* Stack = ItemStore.Find(StackId);
+                const int32 Transfer = FMath::Min(Remaining, MaxStackSize - Stack->Quantity);
+                SetItemQuantity(*Stack, Stack->Quantity + Transfer);
+                Remaining -= Transfer;
+                if (Remaining == 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    // 剩余部分创建新堆叠
+    while (Remaining > 0)
+    {
+        FItemBaseInstance Template = MakeItemTemplate(DefinitionID);
+        const int32 SlotIndex = FindPlacementSlot(Template, Container);
+        if (SlotIndex == INDEX_NONE)
+        {
+            break;
+        }
+
+        Template.ItemLocation = FItemLocation(ContainerID, SlotIndex);
+        Template.Quantity = FMath::Min(Remaining, MaxStackSize);
+        if (!Container->CanAddItem(Template, SlotIndex))
+        {
+            break;
+        }
+        
+        const int32 Added = Template.Quantity;
+        if (IntervalCreateItemFromTemplate(MoveTemp(Template)) == INDEX_NONE)
+        {
+            break;
+        }
+        Remaining -= Added;
+    }
+
+    return Acceptable - Remaining;
 }
 
-FItemBaseInstance UInventoryKitItemSystem::GetItemBaseInstance(int32 ItemId) const
+bool UInventoryKitItemSystem::DestroyItem(int32 ItemId)
 {
-    if (const FItemBaseInstance* Item = ItemMap.Find(ItemId))
+    if (!IntervalDestroyItem(ItemId))
     {
-        return *Item;
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Item %d not found!"), ItemId);
+        return false;
     }
-    
-    return FItemBaseInstance();
+    return true;
 }
 
-void UInventoryKitItemSystem::RegisterContainer(IInventoryKitContainerInterface* InContainer)
+int32 UInventoryKitItemSystem::DestroyItems(const TArray<int32>& ItemIds)
 {
-    auto ID = NextContainerID++;
-    ContainerMap.Add(ID, InContainer);
-    InContainer->InitContainer(ID);
+    // 先逐个释放存储, 再按容器统一通知
+    TMap<int32, TArray<FItemBaseInstance>> RemovedByContainer;
+    int32 NumDestroyed = 0;
+    for (const int32 ItemId : ItemIds)
+    {
+        const FItemBaseInstance* Item = ItemStore.Find(ItemId);
+        if (!Item)
+        {
+            continue;
+        }
+
+        const FItemBaseInstance CopyOldItem = *Item;
+        IntervalDestroyItem(ItemId, false);
+        ++NumDestroyed;
+        if (ContainerMap.Contains(CopyOldItem.ItemLocation.ContainerID))
+        {
+            RemovedByContainer.FindOrAdd(CopyOldItem.ItemLocation.ContainerID).Add(CopyOldItem);
+        }
+    }
+
+    for (const TPair<int32, TArray<FItemBaseInstance>>& Pair : RemovedByContainer)
+    {
+        FindContainer(Pair.Key)->OnItemsRemoved(Pair.Value);
+        MarkContainerDirty(Pair.Key);
+    }
+    return NumDestroyed;
 }
 
-void UInventoryKitItemSystem::UnregisterContainer(IInventoryKitContainerInterface* InContainer)
+void UInventoryKitItemSystem::SetVoidSweep(float MaxAgeSeconds, int32 ItemsPerFrame)
 {
-    auto ID = InContainer->GetContainerID();
-    check(ContainerMap.Contains(ID));
-    ContainerMap.Remove(ID);
-} 
\ No newline at end of file
+    VoidSweepMaxAge = MaxAgeSeconds;
+    VoidSweepItemsPerFrame = FMath::Max(1, ItemsPerFrame);
+
+    // 不回收时虚空容器不记录进入时间
+    if (VoidContainer)
+    {
+        VoidContainer->SetTrackEnterTimes(VoidSweepMaxAge > 0.f);
+    }
+}
+
+void UInventoryKitItemSystem::SweepVoidContainer()
+{
+    if (VoidSweepMaxAge <= 0.f || !VoidContainer)
+    {
+        return;
+    }
+
+    TArray<int32> ExpiredItems;
+    if (VoidContainer->CollectExpiredItems(FPlatformTime::Seconds(), VoidSweepMaxAge, VoidSweepItemsPerFrame, ExpiredItems) > 0)
+    {
+        DestroyItems(ExpiredItems);
+    }
+}
+
+bool UInventoryKitItemSystem::MoveItemToContainer(int32 ItemId, int32 ContainerID)
+{
+    const FItemBaseInstance* Item = ItemStore.Find(ItemId);
+    IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+    if (!Item || !Container)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Cannot move item %d to container %d!"), ItemId, ContainerID);
+        return false;
+    }
+
+    if (Item->ItemLocation.ContainerID == ContainerID)
+    {
+        return true;
+    }
+
+    const int32 SlotIndex = FindPlacementSlot(*Item, *Container);
+    if (SlotIndex == INDEX_NONE)
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("No space for item %d in container %d!"), ItemId, ContainerID);
+        return false;
+    }
+    return MoveItem(ItemId, FItemLocation(ContainerID, SlotIndex));
+}
+
+TArray<int32> UInventoryKitItemSystem::MoveItemsToContainer(const TArray<int32>& ItemIds, int32 ContainerID)
+{
+    // 每次移动后空间管理器的占用随之更新, 下一个物品直接查找新的空位
+    TArray<int32> MovedItems;
+    MovedItems.Reserve(ItemIds.Num());
+    for (const int32 ItemId : ItemIds)
+    {
+        if (MoveItemToContainer(ItemId, ContainerID))
+        {
+            MovedItems.Add(ItemId);
+        }
+    }
+    return MovedItems;
+}
+
+bool UInventoryKitItemSystem::SortContainer(int32 ContainerID)
+{
+    return SortContainerBy(ContainerID, [](const FItemBaseInstance& A, const FItemBaseInstance& B)
+    {
+        if (A.DefinitionID != B.DefinitionID)
+        {
+            return A.DefinitionID < B.DefinitionID;
+        }
+        return A.Quantity > B.Quantity;
+    });
+}
+
+bool UInventoryKitItemSystem::CompactContainer(int32 ContainerID)
+{
+    return SortContainerBy(ContainerID, [](const FItemBaseInstance& A, const FItemBaseInstance& B)
+    {
+        return A.ItemLocation.SlotIndex < B.ItemLocation.SlotIndex;
+    });
+}
+
+bool UInventoryKitItemSystem::SortContainerBy(int32 ContainerID, TFunctionRef<bool(const FItemBaseInstance&, const FItemBaseInstance&)> Predicate)
+{
+    IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+    if (!Container)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Container %d not found!"), ContainerID);
+        return false;
+    }
+
+    UContainerSpaceManager* SpaceManager = (*Container)->GetSpaceManager();
+    const FInventoryKitItemIdSet* ContainerItems = ContainerItemIndex.Find(ContainerID);
+    if (!SpaceManager || !SpaceManager->IsSlotExclusive() || !ContainerItems || ContainerItems->Num() == 0)
+    {
+        return true;
+    }
+
+    TArray<const FItemBaseInstance*> Items;
+    Items.Reserve(ContainerItems->Num());
+    for (const int32 ItemId : *ContainerItems)
+    {
+        Items.Add(ItemStore.Find(ItemId));
+    }
+
+    // 集合的遍历顺序不固定, 先按槽位排列, 相等的物品保持槽位上的先后顺序
+    Items.Sort([](const FItemBaseInstance& A, const FItemBaseInstance& B)
+    {
+        return A.ItemLocation.SlotIndex < B.ItemLocation.SlotIndex;
+    });
+    Items.StableSort(Predicate);
+
+    // 先清空所有物品的占用, 按新顺序依次放置得到目标位置; 计算完成后恢复原占用, 由批量移动通知统一更新
+    for (const FItemBaseInstance* Item : Items)
+    {
+        SpaceManager->UpdateFootprintState(Item->ItemLocation.SlotIndex, Item->GetFootprint(), 0);
+    }
+    TArray<int32> TargetSlots;
+    TargetSlots.Reserve(Items.Num());
+    FGameplayTagContainer ItemTags;
+    for (const FItemBaseInstance* Item : Items)
+    {
+        ItemTags.Reset();
+        GetItemTags(*Item, ItemTags);
+        bool bRotated = false;
+        const int32 SlotIndex = SpaceManager->FindPlacement(Item->GetFootprint(), ItemTags, false, bRotated);
+        if (SlotIndex == INDEX_NONE)
+        {
+            break;
+        }
+        SpaceManager->UpdateFootprintState(SlotIndex, Item->GetFootprint(), 1);
+        TargetSlots.Add(SlotIndex);
+    }
+    for (int32 Index = 0; Index < TargetSlots.Num(); ++Index)
+    {
+        SpaceManager->UpdateFootprintState(TargetSlots[Index], Items[Index]->GetFootprint(), 0);
+    }
+    for (const FItemBaseInstance* Item : Items)
+    {
+        SpaceManager->UpdateFootprintState(Item->ItemLocation.SlotIndex, Item->GetFootprint(), 1);
+    }
+
+    if (TargetSlots.Num() < Items.Num())
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d cannot fit its items in the requested order, sort skipped."), ContainerID);
+        return false;
+    }
+
+    TArray<FItemMoveRequest> Moves;
+    for (int32 Index = 0; Index < Items.Num(); ++Index)
+    {
+        if (Items[Index]->ItemLocation.SlotIndex != TargetSlots[Index])
+        {
+            Moves.Add(FItemMoveRequest(Items[Index]->ItemID, FItemLocation(ContainerID, TargetSlots[Index])));
+        }
+    }
+    if (Moves.Num() > 0)
+    {
+        ApplyRearrange(ContainerID, Moves);
+    }
+    return true;
+}
+
+void UInventoryKitItemSystem::ApplyRearrange(int32 ContainerID, const TArray<FItemMoveRequest>& Moves)
+{
+    RecordJournal(FInventoryKitJournalRecord::MakeRearrange(ContainerID, Moves.Num()));
+
+    TArray<FItemLocation> OldLocations;
+    TArray<FItemBaseInstance> MovedItems;
+    OldLocations.Reserve(Moves.Num());
+    MovedItems.Reserve(Moves.Num());
+    for (const FItemMoveRequest& Move : Moves)
+    {
+        FItemBaseInstance* Item = ItemStore.Find(Move.ItemID);
+        OldLocations.Add(Item->ItemLocation);
+        Item->ItemLocation = Move.TargetLocation;
+        RecordJournal(FInventoryKitJournalRecord::MakeMove(Move.ItemID, Move.TargetLocation));
+        MarkItemViewDirty(Move.ItemID);
+        MovedItems.Add(*Item);
+    }
+
+    // 容器内移动不影响反向索引、堆叠索引和负重
+    FindContainer(ContainerID)->OnItemsMoved(OldLocations, MovedItems);
+    MarkContainerDirty(ContainerID);
+}
+
+int32 UInventoryKitItemSystem::FindPlacementSlot(const FItemBaseInstance& Item, IInventoryKitContainerInterface* Container) const
+{
+    const UContainerSpaceManager* SpaceManager = Container->GetSpaceManager();
+    if (!SpaceManager)
+    {
+        return 0;
+    }
+
+    FGameplayTagContainer ItemTags;
+    GetItemTags(Item, ItemTags);
+    bool bRotated = false;
+    return SpaceManager->FindPlacement(Item.GetFootprint(), ItemTags, false, bRotated);
+}
+
+bool UInventoryKitItemSystem::CommitTransaction(const FInventoryKitTransaction& Transaction, TArray<int32>* OutCreatedItemIds)
+{
+    if (!ValidateTransaction(Transaction))
+    {
+        return false;
+    }
+
+    if (OutCreatedItemIds)
+    {
+        OutCreatedItemIds->Reset(Transaction.GetNumCreates());
+    }
+
+    // 校验已基于暂存状态覆盖了所有步骤, 这里按顺序直接执行
+    for (const FInventoryKitTransaction::FOp& Op : Transaction.GetOps())
+    {
+        switch (Op.Type)
+        {
+        case FInventoryKitTransaction::EOpType::Move:
+            ApplyMove(*ItemStore.Find(Op.ItemID), Op.Location, FindContainer(Op.Location.ContainerID));
+            break;
+        case FInventoryKitTransaction::EOpType::Create:
+            {
+                const FItemBaseInstance* Template = Transaction.GetCreateTemplate(Op);
+                const int32 NewItemId = Template ? IntervalCreateItemFromTemplate(*Template) : IntervalCreateItem(Op.Location);
+                if (OutCreatedItemIds)
+                {
+                    OutCreatedItemIds->Add(NewItemId);
+                }
+            }
+            break;
+        case FInventoryKitTransaction::EOpType::Destroy:
+            IntervalDestroyItem(Op.ItemID);
+            break;
+        }
+    }
+
+    return true;
+}
+
+int32 UInventoryKitItemSystem::ProcessCommandQueue()
+{
+    check(IsInGameThread());
+    return CommandQueue.Drain([this](const FInventoryKitTransaction& Transaction, TArray<int32>& OutCreatedItemIds)
+    {
+        return CommitTransaction(Transaction, &OutCreatedItemIds);
+    });
+}
+
+bool UInventoryKitItemSystem::ValidateTransaction(const FInventoryKitTransaction& Transaction) const
+{
+    // 暂存状态: 被事务修改过的物品、被销毁的物品、各容器的暂存变化
+    TMap<int32, FItemBaseInstance> StagedItems;
+    TSet<int32> DestroyedItems;
+    TMap<int32, FInventoryKitStagedContainerDelta> StagedContainers;
+
+    auto FindStagedItem = [&](int32 ItemId) -> const FItemBaseInstance*
+    {
+        if (DestroyedItems.Contains(ItemId))
+        {
+            return nullptr;
+        }
+        if (const FItemBaseInstance* StagedItem = StagedItems.Find(ItemId))
+        {
+            return StagedItem;
+        }
+        return ItemStore.Find(ItemId);
+    };
+
+    // 获取独占槽位容器中物品占用的所有槽位, 非独占容器返回false
+    TArray<int32> FootprintSlots;
+    auto GetExclusiveSlots = [&](IInventoryKitContainerInterface* Container, const FItemBaseInstance& InItem, const FItemLocation& Location) -> bool
+    {
+        const UContainerSpaceManager* SpaceManager = Container->GetSpaceManager();
+        if (!SpaceManager || !SpaceManager->IsSlotExclusive())
+        {
+            return false;
+        }
+        return SpaceManager->GetFootprintSlots(Location.SlotIndex, InItem.GetFootprint(), FootprintSlots);
+    };
+
+    // 物品离开原位置: 释放槽位
+    auto StageLeave = [&](const FItemBaseInstance& InItem, bool bLeaveContainer)
+    {
+        IInventoryKitContainerInterface* const* Container = ContainerMap.Find(InItem.ItemLocation.ContainerID);
+        if (!Container)
+        {
+            return;
+        }
+        FInventoryKitStagedContainerDelta& Delta = StagedContainers.FindOrAdd(InItem.ItemLocation.ContainerID);
+        if (GetExclusiveSlots(*Container, InItem, InItem.ItemLocation))
+        {
+            for (const int32 Slot : FootprintSlots)
+            {
+                Delta.ReleaseSlot(Slot);
+            }
+        }
+        if (bLeaveContainer)
+        {
+            ++Delta.RemovedCount;
+            Delta.RemovedLoad += GetItemLoad(InItem);
+        }
+    };
+
+    // 物品进入新位置: 校验并占用槽位
+    auto StageEnter = [&](const FItemBaseInstance& InItem, const FItemLocation& TargetLocation, bool bSameContainer) -> bool
+    {
+        IInventoryKitContainerInterface* const* Container = ContainerMap.Find(TargetLocation.ContainerID);
+        if (!Container)
+        {
+            UE_LOG(LogInventoryKitSystem, Error, TEXT("Target container %d not found!"), TargetLocation.ContainerID);
+            return false;
+        }
+
+        FInventoryKitStagedContainerDelta& Delta = StagedContainers.FindOrAdd(TargetLocation.ContainerID);
+        const bool bCanEnter = bSameContainer
+            ? (*Container)->CanMoveItemStaged(InItem, TargetLocation.SlotIndex, Delta)
+            : (*Container)->CanAddItemStaged(InItem, TargetLocation.SlotIndex, Delta);
+        if (!bCanEnter)
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot place item %d to container %d in transaction!"), InItem.ItemID, TargetLocation.ContainerID);
+            return false;
+        }
+
+        if (GetExclusiveSlots(*Container, InItem, TargetLocation))
+        {
+            // 容器的暂存检查可能被项目重写, 这里再兜底检查一次槽位冲突
+            for (const int32 Slot : FootprintSlots)
+            {
+                if (Delta.ClaimedSlots.Contains(Slot))
+                {
+                    UE_LOG(LogInventoryKitSystem, Warning, TEXT("Slot %d of container %d is already claimed in transaction!"), Slot, TargetLocation.ContainerID);
+                    return false;
+                }
+            }
+            for (const int32 Slot : FootprintSlots)
+            {
+                Delta.ClaimSlot(Slot);
+            }
+        }
+        if (!bSameContainer)
+        {
+            ++Delta.AddedCount;
+            Delta.AddedLoad += GetItemLoad(InItem);
+        }
+        return true;
+    };
+
+    // 嵌套容器: 按暂存位置检查是否成环, 并把负重计入目标的祖先容器, 新创建的物品SourceContainerID为-1
+    FContainerChain GainContainers;
+    auto StageNested = [&](const FItemBaseInstance& InItem, int32 SourceContainerID, int32 TargetContainerID) -> bool
+    {
+        const int32* HostedContainerID = ItemHostedContainers.Find(InItem.ItemID);
+        auto GetStagedContainer = [&](int32 Id)
+        {
+            const FItemBaseInstance* StagedItem = FindStagedItem(Id);
+            return StagedItem ? StagedItem->ItemLocation.ContainerID : INDEX_NONE;
+        };
+        if (HostedContainerID && WouldCreateCycle(*HostedContainerID, TargetContainerID, GetStagedContainer))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot move item %d into its own container %d in transaction!"), InItem.ItemID, *HostedContainerID);
+            return false;
+        }
+
+        const FInventoryKitLoad ItemLoad = GetItemLoad(InItem);
+        const FInventoryKitLoad HostedLoad = HostedContainerID ? GetHostedLoad(InItem.ItemID) : FInventoryKitLoad();
+        GetLoadGainContainers(SourceContainerID, TargetContainerID, GainContainers);
+        for (const int32 ContainerID : GainContainers)
+        {
+            // 目标容器自身已在StageEnter中计入物品负重
+            FInventoryKitStagedContainerDelta& Delta = StagedContainers.FindOrAdd(ContainerID);
+            Delta.AddedLoad += ContainerID == TargetContainerID ? HostedLoad : ItemLoad + HostedLoad;
+            if (!FindContainer(ContainerID)->CanAcceptLoad(Delta.AddedLoad - Delta.RemovedLoad))
+            {
+                UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d is overloaded in transaction!"), ContainerID);
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (const FInventoryKitTransaction::FOp& Op : Transaction.GetOps())
+    {
+        switch (Op.Type)
+        {
+        case FInventoryKitTransaction::EOpType::Move:
+            {
+                const FItemBaseInstance* CurrentItem = FindStagedItem(Op.ItemID);
+                if (!CurrentItem)
+                {
+                    UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d not found in transaction!"), Op.ItemID);
+                    return false;
+                }
+
+                // 先释放原位置再占用新位置, 容器内移动时物品自身占用的槽位视为空闲
+                FItemBaseInstance StagedItem = *CurrentItem;
+                const bool bSameContainer = StagedItem.ItemLocation.ContainerID == Op.Location.ContainerID;
+                StageLeave(StagedItem, !bSameContainer);
+                if (!StageEnter(StagedItem, Op.Location, bSameContainer))
+                {
+                    return false;
+                }
+                if (!bSameContainer && ContainerHostItems.Num() > 0 && !StageNested(StagedItem, StagedItem.ItemLocation.ContainerID, Op.Location.ContainerID))
+                {
+                    return false;
+                }
+                
+                StagedItem.ItemLocation = Op.Location;
+                StagedItems.Add(Op.ItemID, StagedItem);
+            }
+            break;
+        case FInventoryKitTransaction::EOpType::Create:
+            {
+                // 按模板的尺寸和负重校验, 与移动相同地计入祖先容器的负重
+                const FItemBaseInstance* Template = Transaction.GetCreateTemplate(Op);
+                FItemBaseInstance NewItem = Template ? *Template : FItemBaseInstance();
+                NewItem.ItemLocation = Op.Location;
+                if (!StageEnter(NewItem, Op.Location, false))
+                {
+                    return false;
+                }
+                if (ContainerHostItems.Num() > 0 && !StageNested(NewItem, INDEX_NONE, Op.Location.ContainerID))
+                {
+                    return false;
+                }
+            }
+            break;
+        case FInventoryKitTransaction::EOpType::Destroy:
+            {
+                const FItemBaseInstance* CurrentItem = FindStagedItem(Op.ItemID);
+                if (!CurrentItem)
+                {
+                    UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d not found in transaction!"), Op.ItemID);
+                    return false;
+                }
+                StageLeave(*CurrentItem, true);
+                DestroyedItems.Add(Op.ItemID);
+                StagedItems.Remove(Op.ItemID);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+int32 UInventoryKitItemSystem::IntervalCreateItem(const FItemLocation& Location, bool bNotify)
+{
+    FItemBaseInstance Template;
+    Template.ItemLocation = Location;
+    return IntervalCreateItemFromTemplate(Template, bNotify);
+}
+
+int32 UInventoryKitItemSystem::IntervalCreateItemFromTemplate(FItemBaseInstance Template, bool bNotify)
+{
+    // 分配存储条目, 同时生成新的物品ID
+    int32 NewItemId;
+    FItemBaseInstance* NewItem = ItemStore.AddDefaulted(NewItemId);
+    if (!NewItem)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Item store exhausted, cannot create item!"));
+        return INDEX_NONE;
+    }
+
+    // 初始化物品实例
+    Template.ItemID = NewItemId;
+    *NewItem = MoveTemp(Template);
+    const FItemLocation& Location = NewItem->ItemLocation;
+    ContainerItemIndex.FindOrAdd(Location.ContainerID).Add(NewItemId);
+    IndexPartialStack(*NewItem);
+    IndexItemTags(*NewItem);
+    RecordJournal(FInventoryKitJournalRecord::MakeCreate(*NewItem));
+    MarkItemViewDirty(NewItemId);
+    if (ContainerHostItems.Num() > 0)
+    {
+        RollUpLoad(Location.ContainerID, GetItemLoad(*NewItem));
+    }
+
+    IInventoryKitContainerInterface* Container = bNotify ? FindContainer(Location.ContainerID) : nullptr;
+    if (Container)
+    {
+        Container->OnItemAdded(*NewItem);
+        MarkContainerDirty(Location.ContainerID);
+    }
+    
+    return NewItemId;
+}
+
+bool UInventoryKitItemSystem::IntervalDestroyItem(int32 ItemId, bool bNotify)
+{
+    const FItemBaseInstance* Item = ItemStore.Find(ItemId);
+    if (!Item)
+    {
+        return false;
+    }
+
+    const FItemBaseInstance CopyOldItem = *Item;
+    if (const int32* HostedContainerID = ItemHostedContainers.Find(ItemId))
+    {
+        DetachContainer(*HostedContainerID);
+    }
+    if (ContainerHostItems.Num() > 0)
+    {
+        RollUpLoad(CopyOldItem.ItemLocation.ContainerID, -GetItemLoad(CopyOldItem));
+    }
+    if (FInventoryKitItemIdSet* ContainerItems = ContainerItemIndex.Find(CopyOldItem.ItemLocation.ContainerID))
+    {
+        ContainerItems->Remove(ItemId);
+    }
+    UnindexPartialStack(CopyOldItem);
+    UnindexItemTags(CopyOldItem);
+    ItemStore.Remove(ItemId);
+    RecordJournal(FInventoryKitJournalRecord::MakeDestroy(ItemId));
+    MarkItemViewDirty(ItemId);
+
+    IInventoryKitContainerInterface* Container = bNotify ? FindContainer(CopyOldItem.ItemLocation.ContainerID) : nullptr;
+    if (Container)
+    {
+        Container->OnItemRemoved(CopyOldItem);
+        MarkContainerDirty(CopyOldItem.ItemLocation.ContainerID);
+    }
+    
+    return true;
+}
+
+FItemBaseInstance UInventoryKitItemSystem::MakeItemTemplate(int32 DefinitionID) const
+{
+    FItemBaseInstance Template;
+    Template.DefinitionID = DefinitionID;
+    if (const FInventoryKitCatalogRecord* Record = ItemCatalog ? ItemCatalog->Find(DefinitionID) : nullptr)
+    {
+        Template.Size = Record->GetSize();
+    }
+    return Template;
+}
+
+bool UInventoryKitItemSystem::IsPartialStack(const FItemBaseInstance& Item) const
+{
+    return Item.DefinitionID != INDEX_NONE && Item.Quantity < GetMaxStackSize(Item.DefinitionID);
+}
+
+void UInventoryKitItemSystem::IndexPartialStack(const FItemBaseInstance& Item)
+{
+    if (IsPartialStack(Item))
+    {
+        PartialStackIndex.FindOrAdd(Item.ItemLocation.ContainerID).FindOrAdd(Item.DefinitionID).Add(Item.ItemID);
+    }
+}
+
+void UInventoryKitItemSystem::UnindexPartialStack(const FItemBaseInstance& Item)
+{
+    TMap<int32, FInventoryKitItemIdSet>* StacksByDefinition = PartialStackIndex.Find(Item.ItemLocation.ContainerID);
+    if (!StacksByDefinition)
+    {
+        return;
+    }
+    
+    FInventoryKitItemIdSet* PartialStacks = StacksByDefinition->Find(Item.DefinitionID);
+    if (PartialStacks && PartialStacks->Remove(Item.ItemID) && PartialStacks->Num() == 0)
+    {
+        StacksByDefinition->Remove(Item.DefinitionID);
+    }
+}
+
+void UInventoryKitItemSystem::SetItemQuantity(FItemBaseInstance& Item, int32 NewQuantity)
+{
+    const int32 OldQuantity = Item.Quantity;
+    if (OldQuantity == NewQuantity)
+    {
+        return;
+    }
+    
+    const FInventoryKitLoad OldLoad = ContainerHostItems.Num() > 0 ? GetItemLoad(Item) : FInventoryKitLoad();
+    UnindexPartialStack(Item);
+    Item.Quantity = NewQuantity;
+    IndexPartialStack(Item);
+    RecordJournal(FInventoryKitJournalRecord::MakeSetQuantity(Item.ItemID, NewQuantity));
+    MarkItemViewDirty(Item.ItemID);
+    if (ContainerHostItems.Num() > 0)
+    {
+        RollUpLoad(Item.ItemLocation.ContainerID, GetItemLoad(Item) - OldLoad);
+    }
+
+    if (IInventoryKitContainerInterface* const* Container = ContainerMap.Find(Item.ItemLocation.ContainerID))
+    {
+        (*Container)->OnItemQuantityChanged(Item, OldQuantity);
+        MarkContainerDirty(Item.ItemLocation.ContainerID);
+    }
+}
+
+void UInventoryKitItemSystem::SetItemIdPolicy(EInventoryKitItemIdPolicy InPolicy)
+{
+    ItemIdPolicy = InPolicy;
+    ItemStore.SetReuseOldestFirst(ItemIdPolicy == EInventoryKitItemIdPolicy::RecycleOldest);
+}
+
+FInventoryKitItemIdStats UInventoryKitItemSystem::GetItemIdStats() const
+{
+    FInventoryKitItemIdStats Stats;
+    Stats.NumLive = ItemStore.Num();
+    Stats.NumFree = ItemStore.GetNumFree();
+    Stats.NumRetired = ItemStore.GetNumRetired();
+    Stats.PeakLive = ItemStore.GetPeakNum();
+    Stats.NumEntries = ItemStore.GetNumEntries();
+    Stats.MaxEntries = TInventoryKitSlotMap<FItemBaseInstance>::MaxEntries;
+    Stats.RemainingAllocations = ItemStore.GetRemainingAllocations();
+    return Stats;
+}
+
+void UInventoryKitItemSystem::ReserveItems(int32 NumItems)
+{
+    if (NumItems > ItemStore.Num())
+    {
+        ItemStore.Reserve(NumItems);
+    }
+}
+
+void UInventoryKitItemSystem::SetChangeFlushPolicy(EContainerChangeFlushPolicy InPolicy)
+{
+    ChangeFlushPolicy = InPolicy;
+    if (ChangeFlushPolicy == EContainerChangeFlushPolicy::Immediate)
+    {
+        FlushContainerChanges();
+    }
+}
+
+void UInventoryKitItemSystem::FlushContainerChanges()
+{
+    // 广播回调中可能再次修改容器, 先取出当前的脏容器集合
+    TSet<int32> ContainersToFlush = MoveTemp(DirtyContainers);
+    DirtyContainers.Reset();
+    for (const int32 ContainerID : ContainersToFlush)
+    {
+        if (IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID))
+        {
+            (*Container)->FlushPendingChanges();
+        }
+    }
+}
+
+bool UInventoryKitItemSystem::SaveSnapshot(TArray<uint8>& OutData)
+{
+    OutData.Reset();
+    FMemoryWriter Ar(OutData);
+
+    FInventoryKitSnapshotHeader Header;
+    Ar << Header;
+    // 兼容旧格式, 写入容器表的条目数
+    int32 NumContainerEntries = ContainerMap.GetNumEntries();
+    Ar << NumContainerEntries;
+    Ar << VoidContainerID;
+
+    ItemStore.SerializeLayout(Ar);
+    FInventoryKitItemColumns Columns;
+    Columns.Gather(ItemStore.GetElements());
+    Columns.Serialize(Ar);
+
+    // 每个容器的占用数据带长度前缀, 加载时找不到的容器可以直接跳过
+    int32 NumContainers = ContainerMap.Num();
+    Ar << NumContainers;
+    TArray<uint8> OccupancyData;
+    TConstArrayView<IInventoryKitContainerInterface*> Containers = ContainerMap.GetElements();
+    for (int32 DenseIndex = 0; DenseIndex < Containers.Num(); ++DenseIndex)
+    {
+        int32 ContainerID = ContainerMap.GetIDAt(DenseIndex);
+        OccupancyData.Reset();
+        if (UContainerSpaceManager* SpaceManager = Containers[DenseIndex]->GetSpaceManager())
+        {
+            FMemoryWriter OccupancyAr(OccupancyData);
+            SpaceManager->SerializeOccupancy(OccupancyAr);
+        }
+        FString PersistentKey = Containers[DenseIndex]->GetPersistentKey();
+        Ar << ContainerID;
+        Ar << PersistentKey;
+        OccupancyData.BulkSerialize(Ar);
+    }
+
+    Ar << ContainerHostItems;
+
+    SerializeCustomSnapshotData(Ar);
+    return !Ar.IsError();
+}
+
+bool UInventoryKitItemSystem::LoadSnapshot(const TArray<uint8>& InData)
+{
+    FMemoryReader Ar(InData);
+
+    FInventoryKitSnapshotHeader Header;
+    Ar << Header;
+    if (Ar.IsError() || !Header.IsValid())
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Invalid snapshot header, magic %08x version %d."), Header.Magic, Header.Version);
+        return false;
+    }
+
+    // 容器ID由注册顺序决定, 加载时按持久化标识重新映射, 保存时的条目数只为兼容旧格式保留
+    int32 SavedNumContainerEntries = 0;
+    int32 SavedVoidContainerID = INDEX_NONE;
+    Ar << SavedNumContainerEntries;
+    Ar << SavedVoidContainerID;
+
+    TInventoryKitSlotMap<FItemBaseInstance> LoadedStore;
+    FInventoryKitItemColumns Columns;
+    const bool bLayoutValid = LoadedStore.SerializeLayout(Ar);
+    Columns.Serialize(Ar);
+
+    int32 NumContainers = 0;
+    Ar << NumContainers;
+    struct FSavedContainer
+    {
+        int32 ContainerID = INDEX_NONE;
+        FString PersistentKey;
+        TArray<uint8> Occupancy;
+    };
+    const bool bHasContainerKeys = Header.Version >= static_cast<int32>(EInventoryKitSnapshotVersion::ContainerKeys);
+    TArray<FSavedContainer> SavedContainers;
+    for (int32 Index = 0; Index < NumContainers && !Ar.IsError(); ++Index)
+    {
+        FSavedContainer& Entry = SavedContainers.AddDefaulted_GetRef();
+        Ar << Entry.ContainerID;
+        if (bHasContainerKeys)
+        {
+            Ar << Entry.PersistentKey;
+        }
+        Entry.Occupancy.BulkSerialize(Ar);
+    }
+
+    TMap<int32, int32> SavedHostItems;
+    if (Header.Version >= static_cast<int32>(EInventoryKitSnapshotVersion::NestedContainers))
+    {
+        Ar << SavedHostItems;
+    }
+    
+    if (Ar.IsError() || !bLayoutValid || !Columns.IsValid(LoadedStore.Num()))
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Corrupted snapshot data, load aborted."));
+        return false;
+    }
+
+    // 容器ID随注册顺序分配并会复用, 按持久化标识把保存时的ID映射到当前注册的容器
+    // 旧版本快照没有标识, 除虚空容器外按原ID映射; 找不到对应容器的物品移入虚空
+    TMap<int32, int32> LoadedContainerRemap;
+    LoadedContainerRemap.Add(SavedVoidContainerID, VoidContainerID);
+    TMap<FString, int32> ContainerKeyIndex = BuildContainerKeyIndex();
+    for (const FSavedContainer& Entry : SavedContainers)
+    {
+        int32 CurrentID = INDEX_NONE;
+        if (!bHasContainerKeys)
+        {
+            LoadedContainerRemap.FindOrAdd(Entry.ContainerID, Entry.ContainerID);
+        }
+        // 每个标识只匹配一次, 保存时标识重复的容器不会合并到同一个容器中
+        else if (!Entry.PersistentKey.IsEmpty() && ContainerKeyIndex.RemoveAndCopyValue(Entry.PersistentKey, CurrentID))
+        {
+            LoadedContainerRemap.Add(Entry.ContainerID, CurrentID);
+        }
+    }
+    int32 NumOrphanedItems = 0;
+    auto RemapContainerID = [this, &LoadedContainerRemap](int32 ContainerID)
+    {
+        const int32* CurrentID = LoadedContainerRemap.Find(ContainerID);
+        return CurrentID && ContainerMap.Contains(*CurrentID) ? *CurrentID : INDEX_NONE;
+    };
+
+    TArrayView<FItemBaseInstance> Items = LoadedStore.GetElements();
+    for (int32 Index = 0; Index < Items.Num(); ++Index)
+    {
+        FItemBaseInstance& Item = Items[Index];
+        Item.ItemID = LoadedStore.GetIDAt(Index);
+        Item.ItemLocation.ContainerID = RemapContainerID(Columns.ContainerIDs[Index]);
+        Item.ItemLocation.SlotIndex = Columns.SlotIndices[Index];
+        if (Item.ItemLocation.ContainerID == INDEX_NONE)
+        {
+            Item.ItemLocation = FItemLocation(VoidContainerID, 0);
+            ++NumOrphanedItems;
+        }
+        Item.DefinitionID = Columns.DefinitionIDs[Index];
+        Item.Quantity = Columns.Quantities[Index];
+        Item.Size = FIntPoint(Columns.SizeX[Index], Columns.SizeY[Index]);
+        Item.bRotated = Columns.Rotated[Index] != 0;
+    }
+
+    // 替换状态之前校验各容器保存的占用, 不合法或缺失的容器之后按恢复的物品重建占用
+    TMap<int32, const FSavedContainer*> RestorableOccupancy;
+    for (const FSavedContainer& Entry : SavedContainers)
+    {
+        const int32 ContainerID = RemapContainerID(Entry.ContainerID);
+        IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+        if (!Container || RestorableOccupancy.Contains(ContainerID))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d (%s) in snapshot is not registered, occupancy skipped."), Entry.ContainerID, *Entry.PersistentKey);
+            continue;
+        }
+
+        const UContainerSpaceManager* SpaceManager = (*Container)->GetSpaceManager();
+        FMemoryReader OccupancyAr(Entry.Occupancy);
+        if (SpaceManager && Entry.Occupancy.Num() > 0 && (!SpaceManager->CanRestoreOccupancy(OccupancyAr) || OccupancyAr.IsError()))
+        {
+            UE_LOG(LogInventoryKitSystem, Error, TEXT("Occupancy of container %d does not match its config, rebuilding it from items."), ContainerID);
+            continue;
+        }
+        RestorableOccupancy.Add(ContainerID, &Entry);
+    }
+
+    // 移入虚空的孤儿物品不在保存的占用中
+    if (NumOrphanedItems > 0)
+    {
+        RestorableOccupancy.Remove(VoidContainerID);
+    }
+
+    // 数据校验通过, 替换当前状态
+    ItemStore = MoveTemp(LoadedStore);
+    ItemStore.SetReuseOldestFirst(ItemIdPolicy == EInventoryKitItemIdPolicy::RecycleOldest);
+    ContainerItemIndex.Reset();
+    PartialStackIndex.Reset();
+    for (const FItemBaseInstance& Item : ItemStore)
+    {
+        ContainerItemIndex.FindOrAdd(Item.ItemLocation.ContainerID).Add(Item.ItemID);
+        IndexPartialStack(Item);
+    }
+    RebuildTagIndex();
+
+    if (NumOrphanedItems > 0)
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("%d items in snapshot belong to unregistered containers, moved to void."), NumOrphanedItems);
+    }
+
+    TConstArrayView<IInventoryKitContainerInterface*> Containers = ContainerMap.GetElements();
+    for (int32 DenseIndex = 0; DenseIndex < Containers.Num(); ++DenseIndex)
+    {
+        const int32 ContainerID = ContainerMap.GetIDAt(DenseIndex);
+        const FInventoryKitItemIdSet* ContainerItems = ContainerItemIndex.Find(ContainerID);
+        const TConstArrayView<int32> ContainerItemIds = ContainerItems ? TConstArrayView<int32>(ContainerItems->GetItems()) : TConstArrayView<int32>();
+        if (UContainerSpaceManager* SpaceManager = Containers[DenseIndex]->GetSpaceManager())
+        {
+            const FSavedContainer* const* Entry = RestorableOccupancy.Find(ContainerID);
+            bool bOccupancyRestored = false;
+            if (Entry && (*Entry)->Occupancy.Num() > 0)
+            {
+                FMemoryReader OccupancyAr((*Entry)->Occupancy);
+                SpaceManager->SerializeOccupancy(OccupancyAr);
+                bOccupancyRestored = !OccupancyAr.IsError();
+            }
+            if (!bOccupancyRestored)
+            {
+                // 快照中没有可用的占用状态, 按恢复到该容器的物品重新占用, 不留下旧状态
+                if (!Entry)
+                {
+                    UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d has no usable occupancy in snapshot, rebuilt from %d items."), ContainerID, ContainerItemIds.Num());
+                }
+                SpaceManager->ResetOccupancy();
+                for (const int32 ItemId : ContainerItemIds)
+                {
+                    const FItemBaseInstance& Item = *ItemStore.Find(ItemId);
+                    SpaceManager->UpdateFootprintState(Item.ItemLocation.SlotIndex, Item.GetFootprint(), 1);
+                }
+            }
+        }
+        
+        Containers[DenseIndex]->RestoreContents(ContainerItemIds);
+        MarkContainerDirty(ContainerID);
+    }
+
+    // 恢复挂接关系后重新累计嵌套负重
+    ContainerHostItems.Reset();
+    ItemHostedContainers.Reset();
+    for (const TPair<int32, int32>& Link : SavedHostItems)
+    {
+        const int32 ContainerID = RemapContainerID(Link.Key);
+        if (ContainerID == INDEX_NONE || ContainerID == VoidContainerID || ContainerHostItems.Contains(ContainerID)
+            || !ItemStore.Find(Link.Value) || ItemHostedContainers.Contains(Link.Value))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d in snapshot cannot be attached to item %d, skipped."), Link.Key, Link.Value);
+            continue;
+        }
+
+        // 与AttachContainerToItem相同的祖先检查, 损坏的快照中成环的挂接关系直接丢弃
+        if (WouldCreateCycle(ContainerID, GetItemContainerID(Link.Value), [this](int32 Id) { return GetItemContainerID(Id); }))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Container %d in snapshot would contain its host item %d, skipped."), Link.Key, Link.Value);
+            continue;
+        }
+        ContainerHostItems.Add(ContainerID, Link.Value);
+        ItemHostedContainers.Add(Link.Value, ContainerID);
+    }
+    PersistedContainerRemap = MoveTemp(LoadedContainerRemap);
+    RebuildNestedLoads();
+    bViewNeedsRebuild = true;
+
+    SerializeCustomSnapshotData(Ar);
+    
+    // 已开启日志时, 之前的记录不再适用于加载后的状态
+    CheckpointJournal();
+    return !Ar.IsError();
+}
+
+void UInventoryKitItemSystem::MarkContainerDirty(int32 ContainerID)
+{
+    if (ChangeFlushPolicy == EContainerChangeFlushPolicy::Immediate)
+    {
+        if (IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID))
+        {
+            (*Container)->FlushPendingChanges();
+        }
+        return;
+    }
+    DirtyContainers.Add(ContainerID);
+}
+
+void UInventoryKitItemSystem::HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+    if (World != GetWorld())
+    {
+        return;
+    }
+
+    // 先执行其他线程提交的命令, 其变更在本帧内广播
+    if (CommandQueue.GetNumPending() > 0)
+    {
+        CommandQueue.Drain([this](const FInventoryKitTransaction& Transaction, TArray<int32>& OutCreatedItemIds)
+        {
+            return CommitTransaction(Transaction, &OutCreatedItemIds);
+        }, MaxCommandsPerFrame);
+    }
+
+    SweepVoidContainer();
+
+    if (ChangeFlushPolicy == EContainerChangeFlushPolicy::EndOfFrame && DirtyContainers.Num() > 0)
+    {
+        FlushContainerChanges();
+    }
+
+    if (bPublishWorldView)
+    {
+        PublishWorldView();
+    }
+
+    // 本帧的日志记录成批交给写入线程
+    if (JournalWriter)
+    {
+        if (JournalCheckpointInterval > 0 && JournalWriter->GetNumRecordsSinceCheckpoint() >= JournalCheckpointInterval)
+        {
+            CheckpointJournal();
+        }
+        else
+        {
+            JournalWriter->SubmitPending();
+        }
+    }
+}
+
+bool UInventoryKitItemSystem::LoadItemCatalog(const FString& Path)
+{
+    TUniquePtr<FInventoryKitItemCatalog> NewCatalog = FInventoryKitItemCatalog::Open(Path);
+    if (!NewCatalog)
+    {
+        return false;
+    }
+    
+    ItemCatalog = MoveTemp(NewCatalog);
+
+    // 定义标签可能变化, 重新建立标签索引
+    DefinitionTagCache.Reset();
+    RebuildTagIndex();
+    return true;
+}
+
+bool UInventoryKitItemSystem::OpenJournal(const FString& JournalPath, const FString& CheckpointPath, int32 CheckpointInterval)
+{
+    CloseJournal();
+    
+    TUniquePtr<FInventoryKitJournalWriter> NewWriter = MakeUnique<FInventoryKitJournalWriter>(JournalPath, CheckpointPath);
+    if (!NewWriter->Start())
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Failed to open journal %s!"), *JournalPath);
+        return false;
+    }
+    
+    JournalWriter = MoveTemp(NewWriter);
+    JournalCheckpointInterval = CheckpointInterval;
+    
+    // 日志中的记录都基于这次检查点
+    CheckpointJournal();
+    return true;
+}
+
+void UInventoryKitItemSystem::CloseJournal()
+{
+    if (JournalWriter)
+    {
+        JournalWriter->Shutdown();
+        JournalWriter.Reset();
+    }
+}
+
+void UInventoryKitItemSystem::CheckpointJournal()
+{
+    if (!JournalWriter)
+    {
+        return;
+    }
+    
+    TArray<uint8> SnapshotData;
+    if (!SaveSnapshot(SnapshotData))
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Failed to save snapshot for journal checkpoint!"));
+        return;
+    }
+    JournalWriter->SubmitCheckpoint(MoveTemp(SnapshotData));
+}
+
+bool UInventoryKitItemSystem::RecoverFromJournal(const FString& JournalPath, const FString& CheckpointPath)
+{
+    if (JournalWriter)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Cannot recover while journal is open!"));
+        return false;
+    }
+    
+    // 没有检查点时按原ID映射, 加载检查点时由快照中的持久化标识重建
+    PersistedContainerRemap.Reset();
+    for (int32 DenseIndex = 0; DenseIndex < ContainerMap.Num(); ++DenseIndex)
+    {
+        const int32 ContainerID = ContainerMap.GetIDAt(DenseIndex);
+        PersistedContainerRemap.Add(ContainerID, ContainerID);
+    }
+
+    TArray<uint8> CheckpointData;
+    uint64 CheckpointSequence = 0;
+    if (!FInventoryKitJournalWriter::ReadCheckpoint(CheckpointPath, CheckpointData, CheckpointSequence)
+        || (CheckpointData.Num() > 0 && !LoadSnapshot(CheckpointData)))
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Failed to load journal checkpoint %s!"), *CheckpointPath);
+        return false;
+    }
+    
+    TArray<FInventoryKitJournalRecord> Records;
+    uint64 JournalSequence = 0;
+    if (!FInventoryKitJournalWriter::ReadRecords(JournalPath, Records, JournalSequence))
+    {
+        return false;
+    }
+
+    // 检查点写入后、日志清空前崩溃时, 日志中的记录已经包含在检查点中
+    if (Records.Num() > 0 && JournalSequence < CheckpointSequence)
+    {
+        UE_LOG(LogInventoryKitSystem, Log, TEXT("Journal %s predates checkpoint %llu, %d records skipped."), *JournalPath, CheckpointSequence, Records.Num());
+        return true;
+    }
+    if (Records.Num() > 0 && JournalSequence > CheckpointSequence)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Journal %s is based on checkpoint %llu, which is missing!"), *JournalPath, JournalSequence);
+        return false;
+    }
+    
+    TGuardValue<bool> ReplayGuard(bReplayingJournal, true);
+    TArray<FItemMoveRequest> BatchRequests;
+    for (int32 Index = 0; Index < Records.Num(); ++Index)
+    {
+        const FInventoryKitJournalRecord& Record = Records[Index];
+        bool bReplayed;
+        if (Record.Op == EInventoryKitJournalOp::MoveBatch)
+        {
+            // 批量移动需要整体应用, 逐条应用时中间状态可能出现重叠
+            BatchRequests.Reset(Record.BatchSize);
+            for (int32 MoveIndex = 1; MoveIndex <= Record.BatchSize && Records.IsValidIndex(Index + MoveIndex); ++MoveIndex)
+            {
+                const FInventoryKitJournalRecord& MoveRecord = Records[Index + MoveIndex];
+                const FItemBaseInstance* Item = ItemStore.Find(MoveRecord.ItemID);
+                BatchRequests.Add(FItemMoveRequest(MoveRecord.ItemID, Item ? RemapJournalLocation(MoveRecord.Location, *Item) : MoveRecord.Location));
+            }
+            bReplayed = BatchRequests.Num() == Record.BatchSize && MoveItems(BatchRequests);
+            Index += Record.BatchSize;
+        }
+        else if (Record.Op == EInventoryKitJournalOp::Rearrange)
+        {
+            // 整理过程中物品互换位置, 只检查物品仍在该容器中, 然后整体应用
+            // 容器已不存在时其中的物品在之前的回放中已移入虚空, 整理不再适用
+            const int32* MappedContainerID = PersistedContainerRemap.Find(Record.Location.ContainerID);
+            const int32 ContainerID = MappedContainerID && ContainerMap.Contains(*MappedContainerID) ? *MappedContainerID : INDEX_NONE;
+            BatchRequests.Reset(Record.BatchSize);
+            bReplayed = true;
+            for (int32 MoveIndex = 1; MoveIndex <= Record.BatchSize && bReplayed && ContainerID != INDEX_NONE; ++MoveIndex)
+            {
+                const FInventoryKitJournalRecord* MoveRecord = Records.IsValidIndex(Index + MoveIndex) ? &Records[Index + MoveIndex] : nullptr;
+                const FItemBaseInstance* Item = MoveRecord ? ItemStore.Find(MoveRecord->ItemID) : nullptr;
+                bReplayed = Item && Item->ItemLocation.ContainerID == ContainerID && MoveRecord->Location.ContainerID == Record.Location.ContainerID;
+                if (bReplayed)
+                {
+                    BatchRequests.Add(FItemMoveRequest(MoveRecord->ItemID, FItemLocation(ContainerID, MoveRecord->Location.SlotIndex)));
+                }
+            }
+            if (bReplayed && ContainerID != INDEX_NONE)
+            {
+                ApplyRearrange(ContainerID, BatchRequests);
+            }
+            Index += Record.BatchSize;
+        }
+        else
+        {
+            bReplayed = ReplayJournalRecord(Record);
+        }
+        
+        if (!bReplayed)
+        {
+            UE_LOG(LogInventoryKitSystem, Error, TEXT("Journal replay diverged at record %d, item %d!"), Index, Record.ItemID);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool UInventoryKitItemSystem::ReplayJournalRecord(const FInventoryKitJournalRecord& Record)
+{
+    switch (Record.Op)
+    {
+    case EInventoryKitJournalOp::Create:
+        {
+            FItemBaseInstance Template;
+            Template.ItemLocation = Record.Location;
+            Template.DefinitionID = Record.DefinitionID;
+            Template.Quantity = Record.Quantity;
+            Template.Size = Record.Size;
+            Template.bRotated = Record.bRotated;
+            Template.ItemLocation = RemapJournalLocation(Record.Location, Template);
+            
+            // 从同一检查点按相同顺序创建, 分配到的ID必然与记录一致
+            return IntervalCreateItemFromTemplate(MoveTemp(Template)) == Record.ItemID;
+        }
+    case EInventoryKitJournalOp::Move:
+        {
+            FItemBaseInstance* Item = ItemStore.Find(Record.ItemID);
+            if (!Item)
+            {
+                return false;
+            }
+            const FItemLocation TargetLocation = RemapJournalLocation(Record.Location, *Item);
+            IInventoryKitContainerInterface* const* Container = ContainerMap.Find(TargetLocation.ContainerID);
+            if (!Container)
+            {
+                return false;
+            }
+            ApplyMove(*Item, TargetLocation, *Container);
+            return true;
+        }
+    case EInventoryKitJournalOp::Destroy:
+        return IntervalDestroyItem(Record.ItemID);
+    case EInventoryKitJournalOp::SetQuantity:
+        {
+            FItemBaseInstance* Item = ItemStore.Find(Record.ItemID);
+            if (!Item)
+            {
+                return false;
+            }
+            SetItemQuantity(*Item, Record.Quantity);
+            return true;
+        }
+    case EInventoryKitJournalOp::SetRotated:
+        return SetItemRotated(Record.ItemID, Record.bRotated);
+    case EInventoryKitJournalOp::AttachContainer:
+        {
+            const int32* ContainerID = PersistedContainerRemap.Find(Record.Location.ContainerID);
+            if (!ContainerID || !ContainerMap.Contains(*ContainerID))
+            {
+                UE_LOG(LogInventoryKitSystem, Warning, TEXT("Journal container %d is not registered, attachment skipped."), Record.Location.ContainerID);
+                return true;
+            }
+            return Record.ItemID == INDEX_NONE ? DetachContainer(*ContainerID) : AttachContainerToItem(*ContainerID, Record.ItemID);
+        }
+    case EInventoryKitJournalOp::RegisterContainer:
+        {
+            // 记录时分配的ID可能已被复用, 以最新的注册记录为准
+            const TMap<FString, int32> ContainerKeyIndex = BuildContainerKeyIndex();
+            const int32* ContainerID = ContainerKeyIndex.Find(Record.ContainerKey);
+            if (ContainerID)
+            {
+                PersistedContainerRemap.Add(Record.Location.ContainerID, *ContainerID);
+            }
+            else
+            {
+                PersistedContainerRemap.Remove(Record.Location.ContainerID);
+            }
+            return true;
+        }
+    default:
+        return false;
+    }
+}
+
+TMap<FString, int32> UInventoryKitItemSystem::BuildContainerKeyIndex() const
+{
+    TMap<FString, int32> ContainerKeyIndex;
+    TConstArrayView<IInventoryKitContainerInterface*> Containers = ContainerMap.GetElements();
+    for (int32 DenseIndex = 0; DenseIndex < Containers.Num(); ++DenseIndex)
+    {
+        FString PersistentKey = Containers[DenseIndex]->GetPersistentKey();
+        if (PersistentKey.IsEmpty())
+        {
+            continue;
+        }
+        if (ContainerKeyIndex.Contains(PersistentKey))
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Duplicate container key %s, container %d is not persisted."), *PersistentKey, ContainerMap.GetIDAt(DenseIndex));
+            continue;
+        }
+        ContainerKeyIndex.Add(MoveTemp(PersistentKey), ContainerMap.GetIDAt(DenseIndex));
+    }
+    return ContainerKeyIndex;
+}
+
+FItemLocation UInventoryKitItemSystem::RemapJournalLocation(const FItemLocation& Location, const FItemBaseInstance& Item) const
+{
+    const int32* ContainerID = PersistedContainerRemap.Find(Location.ContainerID);
+    if (ContainerID && ContainerMap.Contains(*ContainerID))
+    {
+        return FItemLocation(*ContainerID, Location.SlotIndex);
+    }
+    IInventoryKitContainerInterface* VoidTarget = FindContainer(VoidContainerID);
+    return FItemLocation(VoidContainerID, VoidTarget ? FMath::Max(0, FindPlacementSlot(Item, VoidTarget)) : 0);
+}
+
+TArray<int32> UInventoryKitItemSystem::GetItemsInContainer(int32 Identifier) const
+{
+    return TArray<int32>(GetItemsInContainerView(Identifier));
+}
+
+TConstArrayView<int32> UInventoryKitItemSystem::GetItemsInContainerView(int32 Identifier) const
+{
+    if (const FInventoryKitItemIdSet* ContainerItems = ContainerItemIndex.Find(Identifier))
+    {
+        return ContainerItems->GetItems();
+    }
+    return TConstArrayView<int32>();
+}
+
+FItemBaseInstance UInventoryKitItemSystem::GetItemBaseInstance(int32 ItemId) const
+{
+    if (const FItemBaseInstance* Item = ItemStore.Find(ItemId))
+    {
+        return *Item;
+    }
+    
+    return FItemBaseInstance();
+}
+
+void UInventoryKitItemSystem::RegisterContainer(IInventoryKitContainerInterface* InContainer)
+{
+    // 注销的容器释放的ID会被复用, 世代不同, 持有旧ID的查询不会命中新容器
+    int32 ID;
+    IInventoryKitContainerInterface** Slot = ContainerMap.AddDefaulted(ID);
+    if (!Slot)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Container table exhausted, cannot register container!"));
+        return;
+    }
+    *Slot = InContainer;
+    InContainer->InitContainer(ID);
+
+    // 持久化标识按组件路径生成时需要拼接字符串, 不写日志时不去取
+    if (JournalWriter && !bReplayingJournal)
+    {
+        RecordJournal(FInventoryKitJournalRecord::MakeRegisterContainer(ID, InContainer->GetPersistentKey()));
+    }
+}
+
+void UInventoryKitItemSystem::UnregisterContainer(IInventoryKitContainerInterface* InContainer,
+                                                  EInventoryKitOrphanPolicy OrphanPolicy, int32 HandOffContainerID)
+{
+    auto ID = InContainer->GetContainerID();
+    check(FindContainer(ID) == InContainer);
+
+    // 从父容器上解除, 祖先容器扣除其负重
+    DetachContainer(ID);
+
+    // 移出或销毁容器内的物品
+    ReleaseOrphanItems(ID, InContainer, OrphanPolicy, HandOffContainerID);
+    
+    // 注销前广播该容器尚未广播的变更
+    if (DirtyContainers.Remove(ID) > 0)
+    {
+        InContainer->FlushPendingChanges();
+    }
+    ContainerMap.Remove(ID);
+    ContainerItemIndex.Remove(ID);
+    PartialStackIndex.Remove(ID);
+    if (bPublishWorldView)
+    {
+        ViewDirtyContainers.Add(ID);
+    }
+
+    // 回收空间管理器, 下次注册同类型容器时复用
+    if (UContainerSpaceManager* SpaceManager = InContainer->ReleaseSpaceManager())
+    {
+        SpaceManagerPools.FindOrAdd(SpaceManager->GetClass()).FreeManagers.Add(SpaceManager);
+    }
+}
+
+void UInventoryKitItemSystem::ReleaseOrphanItems(int32 ContainerID, IInventoryKitContainerInterface* Container,
+                                                 EInventoryKitOrphanPolicy OrphanPolicy, int32 HandOffContainerID)
+{
+    const FInventoryKitItemIdSet* ContainerItems = ContainerItemIndex.Find(ContainerID);
+    if (!ContainerItems || ContainerItems->Num() == 0)
+    {
+        return;
+    }
+
+    // 处理过程中会修改反向索引, 先复制一份
+    const TArray<int32> OrphanIds = ContainerItems->GetItems();
+
+    IInventoryKitContainerInterface* HandOffContainer = nullptr;
+    if (OrphanPolicy == EInventoryKitOrphanPolicy::HandOff)
+    {
+        HandOffContainer = HandOffContainerID != ContainerID ? FindContainer(HandOffContainerID) : nullptr;
+        if (!HandOffContainer)
+        {
+            UE_LOG(LogInventoryKitSystem, Warning, TEXT("Hand-off container %d not found, items of container %d moved to void."), HandOffContainerID, ContainerID);
+        }
+    }
+
+    // 虚空容器自身注销时, 其中的物品只能销毁
+    IInventoryKitContainerInterface* VoidTarget = ContainerID != VoidContainerID ? FindContainer(VoidContainerID) : nullptr;
+    if (!VoidTarget)
+    {
+        OrphanPolicy = EInventoryKitOrphanPolicy::Destroy;
+    }
+
+    TArray<FItemBaseInstance> RemovedItems;
+    RemovedItems.Reserve(OrphanIds.Num());
+    for (const int32 ItemId : OrphanIds)
+    {
+        FItemBaseInstance* Item = ItemStore.Find(ItemId);
+        if (!Item)
+        {
+            continue;
+        }
+
+        RemovedItems.Add(*Item);
+        if (OrphanPolicy == EInventoryKitOrphanPolicy::Destroy)
+        {
+            IntervalDestroyItem(ItemId, false);
+            continue;
+        }
+
+        // 转交的容器放不下时移入虚空
+        int32 TargetContainerID = VoidContainerID;
+        IInventoryKitContainerInterface* TargetContainer = VoidTarget;
+        int32 SlotIndex = HandOffContainer ? FindOrphanPlacement(*Item, HandOffContainerID, HandOffContainer) : INDEX_NONE;
+        if (SlotIndex != INDEX_NONE)
+        {
+            TargetContainerID = HandOffContainerID;
+            TargetContainer = HandOffContainer;
+        }
+        else
+        {
+            SlotIndex = FMath::Max(0, FindPlacementSlot(*Item, VoidTarget));
+        }
+
+        // 原容器的反向索引和堆叠索引在注销时整体删除, 这里只维护目标容器
+        const FItemBaseInstance CopyOldItem = *Item;
+        const FItemLocation TargetLocation(TargetContainerID, SlotIndex);
+        RecordJournal(FInventoryKitJournalRecord::MakeMove(ItemId, TargetLocation));
+        MarkItemViewDirty(ItemId);
+        Item->ItemLocation = TargetLocation;
+        ContainerItemIndex.FindOrAdd(TargetContainerID).Add(ItemId);
+        IndexPartialStack(*Item);
+        RollUpItemMove(CopyOldItem, TargetContainerID);
+
+        // 目标容器逐个通知, 空间管理器的占用随之更新, 下一个物品直接查找新的空位
+        TargetContainer->OnItemAdded(*Item);
+        MarkContainerDirty(TargetContainerID);
+    }
+
+    // 原容器统一通知一次, 由注销流程随后广播
+    Container->OnItemsRemoved(RemovedItems);
+    MarkContainerDirty(ContainerID);
+}
+
+int32 UInventoryKitItemSystem::FindOrphanPlacement(const FItemBaseInstance& Item, int32 TargetContainerID,
+                                                   IInventoryKitContainerInterface* TargetContainer) const
+{
+    const int32 SlotIndex = FindPlacementSlot(Item, TargetContainer);
+    if (SlotIndex == INDEX_NONE || !TargetContainer->CanAddItem(Item, SlotIndex))
+    {
+        return INDEX_NONE;
+    }
+
+    // 嵌套容器: 不能放进自己承载的容器内部, 祖先容器也要能承受负重
+    if (ContainerHostItems.Num() > 0)
+    {
+        const int32* HostedContainerID = ItemHostedContainers.Find(Item.ItemID);
+        if (HostedContainerID && WouldCreateCycle(*HostedContainerID, TargetContainerID, [this](int32 Id) { return GetItemContainerID(Id); }))
+        {
+            return INDEX_NONE;
+        }
+        if (!CanContainersAcceptLoad(INDEX_NONE, TargetContainerID, GetItemLoad(Item) + GetHostedLoad(Item.ItemID)))
+        {
+            return INDEX_NONE;
+        }
+    }
+    return SlotIndex;
+}
+
+UContainerSpaceManager* UInventoryKitItemSystem::AcquireSpaceManager(const FContainerSpaceConfig& InConfig)
+{
+    UClass* SpaceManagerClass = IInventoryKitContainerInterface::GetSpaceManagerClass(InConfig.SpaceType);
+    if (FInventoryKitSpaceManagerPool* Pool = SpaceManagerPools.Find(SpaceManagerClass))
+    {
+        if (Pool->FreeManagers.Num() > 0)
+        {
+            // Initialize会重置全部状态, 数组按新配置复用已有的内存
+            UContainerSpaceManager* SpaceManager = Pool->FreeManagers.Pop();
+            SpaceManager->Initialize(InConfig);
+            return SpaceManager;
+        }
+    }
+    return IInventoryKitContainerInterface::CreateSpaceManager(this, InConfig);
+}
+
+void UInventoryKitItemSystem::PrewarmSpaceManagers(const FContainerSpaceConfig& InConfig, int32 Count)
+{
+    if (Count <= 0)
+    {
+        return;
+    }
+
+    TArray<TObjectPtr<UContainerSpaceManager>>& FreeManagers =
+        SpaceManagerPools.FindOrAdd(IInventoryKitContainerInterface::GetSpaceManagerClass(InConfig.SpaceType)).FreeManagers;
+    FreeManagers.Reserve(FreeManagers.Num() + Count);
+    for (int32 Index = 0; Index < Count; ++Index)
+    {
+        FreeManagers.Add(IInventoryKitContainerInterface::CreateSpaceManager(this, InConfig));
+    }
+}
+
+int32 UInventoryKitItemSystem::GetNumPooledSpaceManagers() const
+{
+    int32 NumPooled = 0;
+    for (const TPair<TObjectPtr<UClass>, FInventoryKitSpaceManagerPool>& Pool : SpaceManagerPools)
+    {
+        NumPooled += Pool.Value.FreeManagers.Num();
+    }
+    return NumPooled;
+}
+
+bool UInventoryKitItemSystem::AttachContainerToItem(int32 ContainerID, int32 HostItemId)
+{
+    IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+    const FItemBaseInstance* HostItem = ItemStore.Find(HostItemId);
+    if (!Container || !HostItem || ContainerID == VoidContainerID)
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Cannot attach container %d to item %d!"), ContainerID, HostItemId);
+        return false;
+    }
+
+    if (const int32* ExistingHost = ContainerHostItems.Find(ContainerID))
+    {
+        if (*ExistingHost == HostItemId)
+        {
+            return true;
+        }
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Container %d is already attached to item %d!"), ContainerID, *ExistingHost);
+        return false;
+    }
+    if (ItemHostedContainers.Contains(HostItemId))
+    {
+        UE_LOG(LogInventoryKitSystem, Error, TEXT("Item %d already hosts a container!"), HostItemId);
+        return false;
+    }
+
+    const int32 ParentContainerID = HostItem->ItemLocation.ContainerID;
+    if (WouldCreateCycle(ContainerID, ParentContainerID, [this](int32 Id) { return GetItemContainerID(Id); }))
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Cannot attach container %d to item %d inside itself!"), ContainerID, HostItemId);
+        return false;
+    }
+
+    const FInventoryKitLoad ContainerLoad = (*Container)->GetCurrentLoad();
+    if (!CanContainersAcceptLoad(INDEX_NONE, ParentContainerID, ContainerLoad))
+    {
+        UE_LOG(LogInventoryKitSystem, Warning, TEXT("Parent containers of item %d cannot accept container %d!"), HostItemId, ContainerID);
+        return false;
+    }
+
+    ContainerHostItems.Add(ContainerID, HostItemId);
+    ItemHostedContainers.Add(HostItemId, ContainerID);
+    RollUpLoad(ContainerID, ContainerLoad);
+    RecordJournal(FInventoryKitJournalRecord::MakeAttachContainer(ContainerID, HostItemId));
+    MarkHostLinksViewDirty();
+    return true;
+}
+
+bool UInventoryKitItemSystem::DetachContainer(int32 ContainerID)
+{
+    const int32 HostItemId = GetHostItemID(ContainerID);
+    if (HostItemId == INDEX_NONE)
+    {
+        return false;
+    }
+
+    // 先从祖先扣除负重, 再断开链接
+    if (IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID))
+    {
+        RollUpLoad(ContainerID, -(*Container)->GetCurrentLoad());
+    }
+    ContainerHostItems.Remove(ContainerID);
+    ItemHostedContainers.Remove(HostItemId);
+    RecordJournal(FInventoryKitJournalRecord::MakeAttachContainer(ContainerID, INDEX_NONE));
+    MarkHostLinksViewDirty();
+    return true;
+}
+
+int32 UInventoryKitItemSystem::GetHostItemID(int32 ContainerID) const
+{
+    const int32* HostItemId = ContainerHostItems.Find(ContainerID);
+    return HostItemId ? *HostItemId : INDEX_NONE;
+}
+
+int32 UInventoryKitItemSystem::GetHostedContainerID(int32 ItemId) const
+{
+    const int32* HostedContainerID = ItemHostedContainers.Find(ItemId);
+    return HostedContainerID ? *HostedContainerID : INDEX_NONE;
+}
+
+int32 UInventoryKitItemSystem::GetParentContainerID(int32 ContainerID) const
+{
+    const int32* HostItemId = ContainerHostItems.Find(ContainerID);
+    if (!HostItemId)
+    {
+        return INDEX_NONE;
+    }
+    const int32 ParentContainerID = GetItemContainerID(*HostItemId);
+    return ContainerMap.Contains(ParentContainerID) ? ParentContainerID : INDEX_NONE;
+}
+
+bool UInventoryKitItemSystem::IsContainerInside(int32 ContainerID, int32 AncestorID) const
+{
+    int32 Depth = 0;
+    for (int32 ParentID = GetParentContainerID(ContainerID); ParentID != INDEX_NONE && Depth <= ContainerMap.Num(); ParentID = GetParentContainerID(ParentID), ++Depth)
+    {
+        if (ParentID == AncestorID)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32 UInventoryKitItemSystem::GetTopLevelContainerID(int32 ItemId) const
+{
+    int32 ContainerID = GetItemContainerID(ItemId);
+    int32 Depth = 0;
+    for (int32 ParentID = GetParentContainerID(ContainerID); ParentID != INDEX_NONE && Depth <= ContainerMap.Num(); ParentID = GetParentContainerID(ParentID), ++Depth)
+    {
+        ContainerID = ParentID;
+    }
+    return ContainerID;
+}
+
+AActor* UInventoryKitItemSystem::GetTopLevelOwner(int32 ItemId) const
+{
+    IInventoryKitContainerInterface* const* Container = ContainerMap.Find(GetTopLevelContainerID(ItemId));
+    if (!Container)
+    {
+        return nullptr;
+    }
+
+    UObject* ContainerObject = (*Container)->_getUObject();
+    if (const UActorComponent* Component = Cast<UActorComponent>(ContainerObject))
+    {
+        return Component->GetOwner();
+    }
+    return Cast<AActor>(ContainerObject);
+}
+
+TArray<int32> UInventoryKitItemSystem::GetItemsInContainerRecursive(int32 ContainerID) const
+{
+    TArray<int32> Result;
+    TArray<int32, TInlineAllocator<16>> PendingContainers;
+    TSet<int32, DefaultKeyFuncs<int32>, TInlineSetAllocator<16>> VisitedContainers;
+    PendingContainers.Add(ContainerID);
+    VisitedContainers.Add(ContainerID);
+    for (int32 Index = 0; Index < PendingContainers.Num(); ++Index)
+    {
+        const TConstArrayView<int32> Items = GetItemsInContainerView(PendingContainers[Index]);
+        Result.Append(Items);
+        if (ItemHostedContainers.Num() == 0)
+        {
+            continue;
+        }
+
+        // 每个子容器只展开一次, 嵌套关系意外成环时也能结束
+        for (const int32 ItemId : Items)
+        {
+            const int32* HostedContainerID = ItemHostedContainers.Find(ItemId);
+            bool bAlreadyVisited = true;
+            if (HostedContainerID)
+            {
+                VisitedContainers.Add(*HostedContainerID, &bAlreadyVisited);
+            }
+            if (!bAlreadyVisited)
+            {
+                PendingContainers.Add(*HostedContainerID);
+            }
+        }
+    }
+    return Result;
+}
+
+void UInventoryKitItemSystem::SetWorldViewPublishing(bool bEnabled)
+{
+    if (bPublishWorldView == bEnabled)
+    {
+        return;
+    }
+
+    bPublishWorldView = bEnabled;
+    ViewDirtyItems.Reset();
+    ViewDirtyContainers.Reset();
+    bViewNeedsRebuild = true;
+    if (bEnabled)
+    {
+        PublishWorldView();
+    }
+    else
+    {
+        WorldView.Reset();
+    }
+}
+
+void UInventoryKitItemSystem::PublishWorldView()
+{
+    if (!bPublishWorldView)
+    {
+        return;
+    }
+
+    if (bViewNeedsRebuild || !WorldView)
+    {
+        TSharedRef<FInventoryKitWorldView, ESPMode::ThreadSafe> NewView = MakeShared<FInventoryKitWorldView, ESPMode::ThreadSafe>();
+        NewView->Version = WorldView ? WorldView->Version + 1 : 1;
+        RebuildWorldView(*NewView);
+        WorldView = NewView;
+        ViewDirtyItems.Reset();
+        ViewDirtyContainers.Reset();
+        bViewHostLinksDirty = false;
+        bViewNeedsRebuild = false;
+        return;
+    }
+
+    if (ViewDirtyItems.Num() == 0 && ViewDirtyContainers.Num() == 0 && !bViewHostLinksDirty)
+    {
+        return;
+    }
+
+    // 复制上一版本的块指针表, 没有变化的物品块和容器块与上一版本共享
+    TSharedRef<FInventoryKitWorldView, ESPMode::ThreadSafe> NewView = MakeShared<FInventoryKitWorldView, ESPMode::ThreadSafe>(*WorldView);
+    NewView->Version = WorldView->Version + 1;
+
+    TMap<int32, FInventoryKitWorldView::FItemChunk*> CopiedChunks;
+    TSet<int32> DirtyViewContainers = MoveTemp(ViewDirtyContainers);
+    for (const int32 ItemId : ViewDirtyItems)
+    {
+        UpdateWorldViewItem(*NewView, CopiedChunks, ItemId, DirtyViewContainers);
+    }
+
+    TMap<int32, FInventoryKitWorldView::FContainerChunk*> CopiedContainerChunks;
+    for (const int32 ContainerID : DirtyViewContainers)
+    {
+        UpdateWorldViewContainer(*NewView, CopiedContainerChunks, ContainerID);
+    }
+
+    if (bViewHostLinksDirty)
+    {
+        NewView->ContainerHostItems = MakeShared<TMap<int32, int32>, ESPMode::ThreadSafe>(ContainerHostItems);
+        NewView->ItemHostedContainers = MakeShared<TMap<int32, int32>, ESPMode::ThreadSafe>(ItemHostedContainers);
+    }
+
+    WorldView = NewView;
+    ViewDirtyItems.Reset();
+    ViewDirtyContainers.Reset();
+    bViewHostLinksDirty = false;
+}
+
+void UInventoryKitItemSystem::RebuildWorldView(FInventoryKitWorldView& View) const
+{
+    FItemBaseInstance EmptyItem;
+    EmptyItem.ItemID = INDEX_NONE;
+
+    TArray<TSharedPtr<FInventoryKitWorldView::FItemChunk, ESPMode::ThreadSafe>> Chunks;
+    for (const FItemBaseInstance& Item : ItemStore)
+    {
+        const int32 EntryIndex = TInventoryKitSlotMap<FItemBaseInstance>::GetEntryIndex(Item.ItemID);
+        const int32 ChunkIndex = EntryIndex >> FInventoryKitWorldView::ChunkBits;
+        if (Chunks.Num() <= ChunkIndex)
+        {
+            Chunks.SetNum(ChunkIndex + 1);
+        }
+        if (!Chunks[ChunkIndex])
+        {
+            Chunks[ChunkIndex] = MakeShared<FInventoryKitWorldView::FItemChunk, ESPMode::ThreadSafe>();
+            Chunks[ChunkIndex]->Init(EmptyItem, FInventoryKitWorldView::ChunkSize);
+        }
+        (*Chunks[ChunkIndex])[EntryIndex & (FInventoryKitWorldView::ChunkSize - 1)] = Item;
+    }
+
+    View.Chunks.Reset(Chunks.Num());
+    for (const TSharedPtr<FInventoryKitWorldView::FItemChunk, ESPMode::ThreadSafe>& Chunk : Chunks)
+    {
+        View.Chunks.Add(Chunk);
+    }
+    View.NumItems = ItemStore.Num();
+
+    View.ContainerChunks.Reset();
+    TMap<int32, FInventoryKitWorldView::FContainerChunk*> CopiedContainerChunks;
+    for (const TPair<int32, FInventoryKitItemIdSet>& Pair : ContainerItemIndex)
+    {
+        UpdateWorldViewContainer(View, CopiedContainerChunks, Pair.Key);
+    }
+
+    View.ContainerHostItems = MakeShared<TMap<int32, int32>, ESPMode::ThreadSafe>(ContainerHostItems);
+    View.ItemHostedContainers = MakeShared<TMap<int32, int32>, ESPMode::ThreadSafe>(ItemHostedContainers);
+}
+
+void UInventoryKitItemSystem::UpdateWorldViewItem(FInventoryKitWorldView& View, TMap<int32, FInventoryKitWorldView::FItemChunk*>& CopiedChunks, int32 ItemId, TSet<int32>& OutDirtyContainers) const
+{
+    const int32 EntryIndex = TInventoryKitSlotMap<FItemBaseInstance>::GetEntryIndex(ItemId);
+    const int32 ChunkIndex = EntryIndex >> FInventoryKitWorldView::ChunkBits;
+    const int32 IndexInChunk = EntryIndex & (FInventoryKitWorldView::ChunkSize - 1);
+    const FItemBaseInstance* Item = ItemStore.Find(ItemId);
+
+    const FItemBaseInstance* OldEntry = View.Chunks.IsValidIndex(ChunkIndex) && View.Chunks[ChunkIndex] ? &(*View.Chunks[ChunkIndex])[IndexInChunk] : nullptr;
+    const int32 OldItemId = OldEntry ? OldEntry->ItemID : INDEX_NONE;
+    const int32 OldContainerID = OldEntry ? OldEntry->ItemLocation.ContainerID : INDEX_NONE;
+
+    // 物品已销毁且条目已被同一批次中新建的物品占用时, 由新物品负责更新
+    if (!Item && OldItemId != ItemId)
+    {
+        return;
+    }
+
+    FInventoryKitWorldView::FItemChunk* Chunk = CopiedChunks.FindRef(ChunkIndex);
+    if (!Chunk)
+    {
+        TSharedRef<FInventoryKitWorldView::FItemChunk, ESPMode::ThreadSafe> NewChunk = MakeShared<FInventoryKitWorldView::FItemChunk, ESPMode::ThreadSafe>();
+        if (OldEntry)
+        {
+            *NewChunk = *View.Chunks[ChunkIndex];
+        }
+        else
+        {
+            FItemBaseInstance EmptyItem;
+            EmptyItem.ItemID = INDEX_NONE;
+            NewChunk->Init(EmptyItem, FInventoryKitWorldView::ChunkSize);
+        }
+
+        if (View.Chunks.Num() <= ChunkIndex)
+        {
+            View.Chunks.SetNum(ChunkIndex + 1);
+        }
+        View.Chunks[ChunkIndex] = NewChunk;
+        Chunk = &NewChunk.Get();
+        CopiedChunks.Add(ChunkIndex, Chunk);
+    }
+
+    FItemBaseInstance& Entry = (*Chunk)[IndexInChunk];
+    if (OldItemId != INDEX_NONE)
+    {
+        OutDirtyContainers.Add(OldContainerID);
+    }
+    if (Item)
+    {
+        View.NumItems += OldItemId == INDEX_NONE ? 1 : 0;
+        Entry = *Item;
+        OutDirtyContainers.Add(Item->ItemLocation.ContainerID);
+    }
+    else
+    {
+        --View.NumItems;
+        Entry.ItemID = INDEX_NONE;
+    }
+}
+
+void UInventoryKitItemSystem::UpdateWorldViewContainer(FInventoryKitWorldView& View, TMap<int32, FInventoryKitWorldView::FContainerChunk*>& CopiedChunks, int32 ContainerID) const
+{
+    // 不在任何容器中的物品不进入视图
+    if (ContainerID < 0)
+    {
+        return;
+    }
+
+    const int32 EntryIndex = TInventoryKitSlotMap<IInventoryKitContainerInterface*>::GetEntryIndex(ContainerID);
+    const int32 ChunkIndex = EntryIndex >> FInventoryKitWorldView::ContainerChunkBits;
+    const int32 IndexInChunk = EntryIndex & (FInventoryKitWorldView::ContainerChunkSize - 1);
+    const FInventoryKitItemIdSet* ContainerItems = ContainerItemIndex.Find(ContainerID);
+    const bool bHasOldChunk = View.ContainerChunks.IsValidIndex(ChunkIndex) && View.ContainerChunks[ChunkIndex];
+
+    // 容器已注销, 且视图中的条目已空或已属于复用该条目的新容器
+    if (!ContainerItems && (!bHasOldChunk || (*View.ContainerChunks[ChunkIndex])[IndexInChunk].ContainerID != ContainerID))
+    {
+        return;
+    }
+
+    FInventoryKitWorldView::FContainerChunk* Chunk = CopiedChunks.FindRef(ChunkIndex);
+    if (!Chunk)
+    {
+        TSharedRef<FInventoryKitWorldView::FContainerChunk, ESPMode::ThreadSafe> NewChunk = MakeShared<FInventoryKitWorldView::FContainerChunk, ESPMode::ThreadSafe>();
+        if (bHasOldChunk)
+        {
+            *NewChunk = *View.ContainerChunks[ChunkIndex];
+        }
+        else
+        {
+            NewChunk->SetNum(FInventoryKitWorldView::ContainerChunkSize);
+        }
+
+        if (View.ContainerChunks.Num() <= ChunkIndex)
+        {
+            View.ContainerChunks.SetNum(ChunkIndex + 1);
+        }
+        View.ContainerChunks[ChunkIndex] = NewChunk;
+        Chunk = &NewChunk.Get();
+        CopiedChunks.Add(ChunkIndex, Chunk);
+    }
+
+    FInventoryKitWorldView::FContainerEntry& Entry = (*Chunk)[IndexInChunk];
+    if (ContainerItems)
+    {
+        Entry.ContainerID = ContainerID;
+        Entry.Items = MakeShared<TArray<int32>, ESPMode::ThreadSafe>(ContainerItems->GetItems());
+        Entry.Version = View.Version;
+    }
+    else
+    {
+        Entry = FInventoryKitWorldView::FContainerEntry();
+    }
+}
+
+int32 UInventoryKitItemSystem::GetItemContainerID(int32 ItemId) const
+{
+    const FItemBaseInstance* Item = ItemStore.Find(ItemId);
+    return Item ? Item->ItemLocation.ContainerID : INDEX_NONE;
+}
+
+FInventoryKitLoad UInventoryKitItemSystem::GetHostedLoad(int32 ItemId) const
+{
+    const int32* HostedContainerID = ItemHostedContainers.Find(ItemId);
+    IInventoryKitContainerInterface* const* HostedContainer = HostedContainerID ? ContainerMap.Find(*HostedContainerID) : nullptr;
+    return HostedContainer ? (*HostedContainer)->GetCurrentLoad() : FInventoryKitLoad();
+}
+
+bool UInventoryKitItemSystem::WouldCreateCycle(int32 HostedContainerID, int32 TargetContainerID, TFunctionRef<int32(int32)> GetContainerOfItem) const
+{
+    // 从目标容器沿暂存状态的父链上溯, 遇到被承载的容器即成环; 步数超过容器数量说明已有环
+    int32 ContainerID = TargetContainerID;
+    for (int32 Depth = 0; ContainerID != INDEX_NONE; ++Depth)
+    {
+        if (ContainerID == HostedContainerID || Depth > ContainerMap.Num())
+        {
+            return true;
+        }
+        const int32* HostItemId = ContainerHostItems.Find(ContainerID);
+        ContainerID = HostItemId ? GetContainerOfItem(*HostItemId) : INDEX_NONE;
+    }
+    return false;
+}
+
+void UInventoryKitItemSystem::GetLoadGainContainers(int32 SourceContainerID, int32 TargetContainerID, FContainerChain& OutContainers) const
+{
+    OutContainers.Reset();
+    if (ContainerHostItems.Num() == 0)
+    {
+        if (TargetContainerID != SourceContainerID)
+        {
+            OutContainers.Add(TargetContainerID);
+        }
+        return;
+    }
+
+    FContainerChain SourceChain;
+    for (int32 ContainerID = SourceContainerID; ContainerID != INDEX_NONE && SourceChain.Num() <= ContainerMap.Num(); ContainerID = GetParentContainerID(ContainerID))
+    {
+        SourceChain.Add(ContainerID);
+    }
+    for (int32 ContainerID = TargetContainerID; ContainerID != INDEX_NONE && OutContainers.Num() <= ContainerMap.Num(); ContainerID = GetParentContainerID(ContainerID))
+    {
+        if (SourceChain.Contains(ContainerID))
+        {
+            break;
+        }
+        OutContainers.Add(ContainerID);
+    }
+}
+
+bool UInventoryKitItemSystem::CanContainersAcceptLoad(int32 SourceContainerID, int32 TargetContainerID, const FInventoryKitLoad& Load) const
+{
+    if (Load.IsZero())
+    {
+        return true;
+    }
+
+    FContainerChain GainContainers;
+    GetLoadGainContainers(SourceContainerID, TargetContainerID, GainContainers);
+    for (const int32 ContainerID : GainContainers)
+    {
+        IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+        if (Container && !(*Container)->CanAcceptLoad(Load))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void UInventoryKitItemSystem::RollUpLoad(int32 ContainerID, const FInventoryKitLoad& Delta)
+{
+    if (Delta.IsZero() || ContainerHostItems.Num() == 0)
+    {
+        return;
+    }
+
+    int32 Depth = 0;
+    for (int32 ParentID = GetParentContainerID(ContainerID); ParentID != INDEX_NONE && Depth <= ContainerMap.Num(); ParentID = GetParentContainerID(ParentID), ++Depth)
+    {
+        FindContainer(ParentID)->AddNestedLoad(Delta);
+    }
+}
+
+void UInventoryKitItemSystem::RollUpItemMove(const FItemBaseInstance& OldItem, int32 NewContainerID)
+{
+    // 没有嵌套时不产生额外开销
+    if (ContainerHostItems.Num() == 0)
+    {
+        return;
+    }
+
+    const int32 OldContainerID = OldItem.ItemLocation.ContainerID;
+    const FInventoryKitLoad HostedLoad = GetHostedLoad(OldItem.ItemID);
+    if (!HostedLoad.IsZero())
+    {
+        if (IInventoryKitContainerInterface* const* OldContainer = ContainerMap.Find(OldContainerID))
+        {
+            (*OldContainer)->AddNestedLoad(-HostedLoad);
+        }
+        if (IInventoryKitContainerInterface* const* NewContainer = ContainerMap.Find(NewContainerID))
+        {
+            (*NewContainer)->AddNestedLoad(HostedLoad);
+        }
+    }
+
+    const FInventoryKitLoad TotalLoad = GetItemLoad(OldItem) + HostedLoad;
+    RollUpLoad(OldContainerID, -TotalLoad);
+    RollUpLoad(NewContainerID, TotalLoad);
+}
+
+void UInventoryKitItemSystem::RebuildNestedLoads()
+{
+    for (IInventoryKitContainerInterface* Container : ContainerMap)
+    {
+        Container->ResetNestedLoad();
+    }
+
+    // 清空后各容器的负重只含直接存放的物品, 先全部取出再逐个向祖先累加
+    TArray<TPair<int32, FInventoryKitLoad>> DirectLoads;
+    DirectLoads.Reserve(ContainerHostItems.Num());
+    for (const TPair<int32, int32>& Link : ContainerHostItems)
+    {
+        if (IInventoryKitContainerInterface* const* Container = ContainerMap.Find(Link.Key))
+        {
+            DirectLoads.Emplace(Link.Key, (*Container)->GetCurrentLoad());
+        }
+    }
+    for (const TPair<int32, FInventoryKitLoad>& Entry : DirectLoads)
+    {
+        RollUpLoad(Entry.Key, Entry.Value);
+    }
+}
+
+void UInventoryKitItemSystem::GetItemTags(const FItemBaseInstance& Item, FGameplayTagContainer& OutTags) const
+{
+    if (const FGameplayTagContainer* CachedTags = DefinitionTagCache.Find(Item.DefinitionID))
+    {
+        OutTags = *CachedTags;
+        return;
+    }
+
+    OutTags.Reset();
+    if (const FInventoryKitCatalogRecord* Record = ItemCatalog ? ItemCatalog->Find(Item.DefinitionID) : nullptr)
+    {
+        ItemCatalog->GetTags(*Record, OutTags);
+    }
+}
+
+TArray<int32> UInventoryKitItemSystem::FindItemsWithTag(FGameplayTag Tag, int32 ContainerID, bool bRecursive) const
+{
+    TArray<int32> Result;
+    if (const FInventoryKitItemIdSet* Posting = TagIndex.Find(Tag))
+    {
+        CollectItemsInScope(*Posting, false, ContainerID, bRecursive, &Result);
+    }
+    return Result;
+}
+
+TArray<int32> UInventoryKitItemSystem::QueryItems(const FGameplayTagQuery& Query, int32 ContainerID, bool bRecursive) const
+{
+    TArray<int32> Result;
+    FInventoryKitTagIndex::FResult QueryResult;
+    if (TagIndex.Evaluate(Query, QueryResult))
+    {
+        CollectItemsInScope(QueryResult.Items, QueryResult.bComplement, ContainerID, bRecursive, &Result);
+    }
+    else
+    {
+        MatchItemsInScope(Query, ContainerID, bRecursive, &Result);
+    }
+    return Result;
+}
+
+bool UInventoryKitItemSystem::HasItemMatchingQuery(const FGameplayTagQuery& Query, int32 ContainerID, bool bRecursive) const
+{
+    FInventoryKitTagIndex::FResult QueryResult;
+    if (TagIndex.Evaluate(Query, QueryResult))
+    {
+        return CollectItemsInScope(QueryResult.Items, QueryResult.bComplement, ContainerID, bRecursive, nullptr);
+    }
+    return MatchItemsInScope(Query, ContainerID, bRecursive, nullptr);
+}
+
+void UInventoryKitItemSystem::IndexItemTags(const FItemBaseInstance& Item)
+{
+    // 首次遇到的定义先解析并缓存目录中的标签
+    if (ItemCatalog && Item.DefinitionID != INDEX_NONE && !DefinitionTagCache.Contains(Item.DefinitionID))
+    {
+        FGameplayTagContainer& DefinitionTags = DefinitionTagCache.Add(Item.DefinitionID);
+        if (const FInventoryKitCatalogRecord* Record = ItemCatalog->Find(Item.DefinitionID))
+        {
+            ItemCatalog->GetTags(*Record, DefinitionTags);
+        }
+    }
+
+    FGameplayTagContainer Tags;
+    GetItemTags(Item, Tags);
+    TagIndex.AddItem(Item.ItemID, Tags);
+}
+
+void UInventoryKitItemSystem::UnindexItemTags(const FItemBaseInstance& Item)
+{
+    FGameplayTagContainer Tags;
+    GetItemTags(Item, Tags);
+    TagIndex.RemoveItem(Item.ItemID, Tags);
+}
+
+void UInventoryKitItemSystem::RebuildTagIndex()
+{
+    TagIndex.Reset();
+    for (const FItemBaseInstance& Item : ItemStore)
+    {
+        IndexItemTags(Item);
+    }
+}
+
+bool UInventoryKitItemSystem::IsItemInScope(int32 ItemId, int32 ContainerID, bool bRecursive) const
+{
+    if (ContainerID == INDEX_NONE)
+    {
+        return true;
+    }
+
+    const int32 ItemContainerID = GetItemContainerID(ItemId);
+    return ItemContainerID == ContainerID || (bRecursive && IsContainerInside(ItemContainerID, ContainerID));
+}
+
+void UInventoryKitItemSystem::GetItemsInScope(int32 ContainerID, bool bRecursive, TArray<int32>& OutItems) const
+{
+    if (ContainerID != INDEX_NONE)
+    {
+        OutItems = bRecursive ? GetItemsInContainerRecursive(ContainerID) : GetItemsInContainer(ContainerID);
+        return;
+    }
+
+    OutItems.Reset(ItemStore.Num());
+    for (const FItemBaseInstance& Item : ItemStore)
+    {
+        OutItems.Add(Item.ItemID);
+    }
+}
+
+bool UInventoryKitItemSystem::CollectItemsInScope(const FInventoryKitItemIdSet& Items, bool bComplement, int32 ContainerID, bool bRecursive, TArray<int32>* OutItems) const
+{
+    bool bFound = false;
+    
+    // 返回是否继续查找
+    auto Emit = [&bFound, OutItems](int32 ItemId)
+    {
+        bFound = true;
+        if (OutItems)
+        {
+            OutItems->Add(ItemId);
+        }
+        return OutItems != nullptr;
+    };
+
+    if (bComplement)
+    {
+        // 取反的结果只能遍历范围内的所有物品
+        TArray<int32> ScopeItems;
+        GetItemsInScope(ContainerID, bRecursive, ScopeItems);
+        for (const int32 ItemId : ScopeItems)
+        {
+            if (!Items.Contains(ItemId) && !Emit(ItemId))
+            {
+                break;
+            }
+        }
+        return bFound;
+    }
+
+    // 限定单个容器时遍历容器和结果中较小的一方
+    const FInventoryKitItemIdSet* ContainerItems = ContainerID != INDEX_NONE && !bRecursive ? ContainerItemIndex.Find(ContainerID) : nullptr;
+    if (ContainerItems && ContainerItems->Num() < Items.Num())
+    {
+        for (const int32 ItemId : *ContainerItems)
+        {
+            if (Items.Contains(ItemId) && !Emit(ItemId))
+            {
+                break;
+            }
+        }
+        return bFound;
+    }
+    
+    for (const int32 ItemId : Items)
+    {
+        if (IsItemInScope(ItemId, ContainerID, bRecursive) && !Emit(ItemId))
+        {
+            break;
+        }
+    }
+    return bFound;
+}
+
+bool UInventoryKitItemSystem::MatchItemsInScope(const FGameplayTagQuery& Query, int32 ContainerID, bool bRecursive, TArray<int32>* OutItems) const
+{
+    TArray<int32> ScopeItems;
+    GetItemsInScope(ContainerID, bRecursive, ScopeItems);
+    
+    bool bFound = false;
+    FGameplayTagContainer Tags;
+    for (const int32 ItemId : ScopeItems)
+    {
+        GetItemTags(*ItemStore.Find(ItemId), Tags);
+        if (!Query.Matches(Tags))
+        {
+            continue;
+        }
+        
+        bFound = true;
+        if (!OutItems)
+        {
+            break;
+        }
+        OutItems->Add(ItemId);
+    }
+    return bFound;
+}
@@ -0,0 +1,486 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitJournal.h"
+
+#include "Core/InventoryKitSnapshot.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogInventoryKitJournal, Log, All);
+
+FArchive& operator<<(FArchive& Ar, FInventoryKitJournalRecord& Record)
+{
+    uint8 Op = static_cast<uint8>(Record.Op);
+    Ar << Op;
+    Record.Op = static_cast<EInventoryKitJournalOp>(Op);
+    Ar << Record.ItemID;
+
+    uint8 Rotated = Record.bRotated ? 1 : 0;
+    switch (Record.Op)
+    {
+    case EInventoryKitJournalOp::Create:
+        Ar << Record.Location.ContainerID;
+        Ar << Record.Location.SlotIndex;
+        Ar << Record.DefinitionID;
+        Ar << Record.Size;
+        Ar << Record.Quantity;
+        Ar << Rotated;
+        break;
+    case EInventoryKitJournalOp::Move:
+        Ar << Record.Location.ContainerID;
+        Ar << Record.Location.SlotIndex;
+        break;
+    case EInventoryKitJournalOp::Destroy:
+        break;
+    case EInventoryKitJournalOp::SetQuantity:
+        Ar << Record.Quantity;
+        break;
+    case EInventoryKitJournalOp::SetRotated:
+        Ar << Rotated;
+        break;
+    case EInventoryKitJournalOp::MoveBatch:
+        Ar << Record.BatchSize;
+        break;
+    case EInventoryKitJournalOp::AttachContainer:
+        Ar << Record.Location.ContainerID;
+        break;
+    case EInventoryKitJournalOp::Rearrange:
+        Ar << Record.Location.ContainerID;
+        Ar << Record.BatchSize;
+        break;
+    case EInventoryKitJournalOp::RegisterContainer:
+        Ar << Record.Location.ContainerID;
+        Ar << Record.ContainerKey;
+        break;
+    default:
+        Ar.SetError();
+        break;
+    }
+    Record.bRotated = Rotated != 0;
+    return Ar;
+}
+
+FInventoryKitJournalWriter::FInventoryKitJournalWriter(const FString& InJournalPath, const FString& InCheckpointPath, int32 InMaxQueuedBatches)
+    : JournalPath(InJournalPath)
+    , CheckpointPath(InCheckpointPath)
+    , MaxQueuedBatches(FMath::Max(1, InMaxQueuedBatches))
+{
+}
+
+FInventoryKitJournalWriter::~FInventoryKitJournalWriter()
+{
+    Shutdown();
+}
+
+bool FInventoryKitJournalWriter::Start()
+{
+    check(!Thread);
+
+    // 在已有文件的基础上继续递增序号, 新检查点的序号总是大于磁盘上所有旧文件
+    CheckpointSequence = FMath::Max3(PeekJournalSequence(JournalPath), PeekCheckpointSequence(CheckpointPath),
+                                     PeekCheckpointSequence(CheckpointPath + TEXT(".tmp")));
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(JournalPath));
+    JournalFile.Reset(PlatformFile.OpenWrite(*JournalPath, true, false));
+    if (!JournalFile)
+    {
+        UE_LOG(LogInventoryKitJournal, Error, TEXT("Failed to open journal file %s."), *JournalPath);
+        return false;
+    }
+
+    // 新文件写入文件头, 已有文件继续追加, 由之后的检查点清空
+    if (JournalFile->Size() == 0)
+    {
+        WriteJournalHeader();
+    }
+
+    bStopping = false;
+    WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    Thread = FRunnableThread::Create(this, TEXT("InventoryKitJournalWriter"), 0, TPri_BelowNormal);
+    if (!Thread)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+        WorkEvent = nullptr;
+        JournalFile.Reset();
+        return false;
+    }
+    return true;
+}
+
+void FInventoryKitJournalWriter::Shutdown()
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    // 退出前不受队列上限限制, 保证剩余记录全部写入
+    if (PendingBytes.Num() > 0)
+    {
+        FCommand Command;
+        Command.Type = ECommandType::Records;
+        Command.Data = MoveTemp(PendingBytes);
+        PendingBytes.Reset();
+        Commands.Enqueue(MoveTemp(Command));
+        ++NumQueuedBatches;
+    }
+
+    Thread->Kill(true);
+    delete Thread;
+    Thread = nullptr;
+    FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+    WorkEvent = nullptr;
+    JournalFile.Reset();
+}
+
+void FInventoryKitJournalWriter::Append(const FInventoryKitJournalRecord& Record)
+{
+    FInventoryKitJournalRecord RecordCopy = Record;
+    FMemoryWriter Writer(PendingBytes, false, true);
+    Writer << RecordCopy;
+    ++NumRecordsSinceCheckpoint;
+}
+
+bool FInventoryKitJournalWriter::SubmitPending()
+{
+    if (PendingBytes.Num() == 0)
+    {
+        return true;
+    }
+
+    if (NumQueuedBatches.load() >= MaxQueuedBatches)
+    {
+        UE_LOG(LogInventoryKitJournal, Verbose, TEXT("Journal queue full, %d bytes kept for next submit."), PendingBytes.Num());
+        return false;
+    }
+
+    FCommand Command;
+    Command.Type = ECommandType::Records;
+    Command.Data = MoveTemp(PendingBytes);
+    PendingBytes.Reset();
+    Commands.Enqueue(MoveTemp(Command));
+    ++NumQueuedBatches;
+    WorkEvent->Trigger();
+    return true;
+}
+
+void FInventoryKitJournalWriter::SubmitCheckpoint(TArray<uint8>&& SnapshotData)
+{
+    NumRecordsSinceCheckpoint = 0;
+
+    // 尚未提交的记录排在检查点之前写入日志, 检查点写入成功后随日志一起清空; 写入失败时日志仍然完整
+    // 与Shutdown相同, 不受队列上限限制
+    if (PendingBytes.Num() > 0)
+    {
+        FCommand RecordsCommand;
+        RecordsCommand.Type = ECommandType::Records;
+        RecordsCommand.Data = MoveTemp(PendingBytes);
+        PendingBytes.Reset();
+        Commands.Enqueue(MoveTemp(RecordsCommand));
+        ++NumQueuedBatches;
+    }
+
+    // 检查点很少提交, 不计入队列上限
+    FCommand Command;
+    Command.Type = ECommandType::Checkpoint;
+    Command.Data = MoveTemp(SnapshotData);
+    Commands.Enqueue(MoveTemp(Command));
+    WorkEvent->Trigger();
+}
+
+uint32 FInventoryKitJournalWriter::Run()
+{
+    while (!bStopping.load())
+    {
+        WorkEvent->Wait();
+        ProcessCommands();
+    }
+    ProcessCommands();
+    return 0;
+}
+
+void FInventoryKitJournalWriter::Stop()
+{
+    bStopping = true;
+    if (WorkEvent)
+    {
+        WorkEvent->Trigger();
+    }
+}
+
+void FInventoryKitJournalWriter::ProcessCommands()
+{
+    bool bWritten = false;
+    FCommand Command;
+    while (Commands.Dequeue(Command))
+    {
+        if (Command.Type == ECommandType::Checkpoint)
+        {
+            // 先保证已写入的记录落盘, 检查点写入成功后才能清空日志
+            if (bWritten && JournalFile)
+            {
+                JournalFile->Flush(true);
+                bWritten = false;
+            }
+            if (WriteCheckpoint(Command.Data))
+            {
+                ResetJournalFile();
+            }
+            continue;
+        }
+
+        --NumQueuedBatches;
+        if (!JournalFile)
+        {
+            continue;
+        }
+
+        int32 Size = Command.Data.Num();
+        uint32 Crc = FCrc::MemCrc32(Command.Data.GetData(), Size);
+        JournalFile->Write(reinterpret_cast<const uint8*>(&Size), sizeof(Size));
+        JournalFile->Write(reinterpret_cast<const uint8*>(&Crc), sizeof(Crc));
+        JournalFile->Write(Command.Data.GetData(), Size);
+        bWritten = true;
+    }
+
+    if (bWritten && JournalFile)
+    {
+        JournalFile->Flush(true);
+    }
+}
+
+bool FInventoryKitJournalWriter::ResetJournalFile()
+{
+    JournalFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*JournalPath, false, false));
+    if (!JournalFile)
+    {
+        UE_LOG(LogInventoryKitJournal, Error, TEXT("Failed to reset journal file %s."), *JournalPath);
+        return false;
+    }
+
+    WriteJournalHeader();
+    return true;
+}
+
+void FInventoryKitJournalWriter::WriteJournalHeader()
+{
+    uint32 Magic = FileMagic;
+    int32 Version = FileVersion;
+    uint64 Sequence = CheckpointSequence;
+    JournalFile->Write(reinterpret_cast<const uint8*>(&Magic), sizeof(Magic));
+    JournalFile->Write(reinterpret_cast<const uint8*>(&Version), sizeof(Version));
+    JournalFile->Write(reinterpret_cast<const uint8*>(&Sequence), sizeof(Sequence));
+    JournalFile->Flush(true);
+}
+
+bool FInventoryKitJournalWriter::WriteCheckpoint(const TArray<uint8>& SnapshotData)
+{
+    // 先完整写入临时文件再替换; 替换过程中崩溃时正式文件可能缺失, 恢复时会读取.tmp
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const FString TempPath = CheckpointPath + TEXT(".tmp");
+    uint32 Magic = CheckpointMagic;
+    int32 Version = CheckpointVersion;
+    uint64 Sequence = CheckpointSequence + 1;
+    uint32 Crc = FCrc::MemCrc32(SnapshotData.GetData(), SnapshotData.Num());
+    {
+        TUniquePtr<IFileHandle> TempFile(PlatformFile.OpenWrite(*TempPath, false, false));
+        if (!TempFile
+            || !TempFile->Write(reinterpret_cast<const uint8*>(&Magic), sizeof(Magic))
+            || !TempFile->Write(reinterpret_cast<const uint8*>(&Version), sizeof(Version))
+            || !TempFile->Write(reinterpret_cast<const uint8*>(&Sequence), sizeof(Sequence))
+            || !TempFile->Write(reinterpret_cast<const uint8*>(&Crc), sizeof(Crc))
+            || !TempFile->Write(SnapshotData.GetData(), SnapshotData.Num())
+            || !TempFile->Flush(true))
+        {
+            UE_LOG(LogInventoryKitJournal, Error, TEXT("Failed to write checkpoint %s."), *TempPath);
+            return false;
+        }
+    }
+
+    // 临时文件已完整落盘, 之后的日志都基于新序号; 即使替换失败, 恢复时也会选中序号更大的.tmp
+    CheckpointSequence = Sequence;
+    PlatformFile.DeleteFile(*CheckpointPath);
+    if (!PlatformFile.MoveFile(*CheckpointPath, *TempPath))
+    {
+        UE_LOG(LogInventoryKitJournal, Error, TEXT("Failed to replace checkpoint %s, recovery will use %s."), *CheckpointPath, *TempPath);
+    }
+    return true;
+}
+
+uint64 FInventoryKitJournalWriter::PeekCheckpointSequence(const FString& InPath)
+{
+    TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*InPath));
+    uint32 Magic = 0;
+    int32 Version = 0;
+    uint64 Sequence = 0;
+    if (!File
+        || !File->Read(reinterpret_cast<uint8*>(&Magic), sizeof(Magic))
+        || !File->Read(reinterpret_cast<uint8*>(&Version), sizeof(Version))
+        || !File->Read(reinterpret_cast<uint8*>(&Sequence), sizeof(Sequence)))
+    {
+        return 0;
+    }
+    return Magic == CheckpointMagic && Version == CheckpointVersion ? Sequence : 0;
+}
+
+uint64 FInventoryKitJournalWriter::PeekJournalSequence(const FString& InPath)
+{
+    TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*InPath));
+    uint32 Magic = 0;
+    int32 Version = 0;
+    uint64 Sequence = 0;
+    if (!File
+        || !File->Read(reinterpret_cast<uint8*>(&Magic), sizeof(Magic))
+        || !File->Read(reinterpret_cast<uint8*>(&Version), sizeof(Version))
+        || !File->Read(reinterpret_cast<uint8*>(&Sequence), sizeof(Sequence)))
+    {
+        return 0;
+    }
+    return Magic == FileMagic && Version >= 2 && Version <= FileVersion ? Sequence : 0;
+}
+
+bool FInventoryKitJournalWriter::ReadCheckpoint(const FString& InCheckpointPath, TArray<uint8>& OutSnapshotData, uint64& OutSequence)
+{
+    OutSnapshotData.Reset();
+    OutSequence = 0;
+
+    constexpr int32 HeaderSize = sizeof(uint32) + sizeof(int32) + sizeof(uint64) + sizeof(uint32);
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const FString Paths[] = { InCheckpointPath, InCheckpointPath + TEXT(".tmp") };
+    bool bAnyFile = false;
+    bool bFound = false;
+    for (const FString& Path : Paths)
+    {
+        TArray<uint8> FileData;
+        if (!PlatformFile.FileExists(*Path))
+        {
+            continue;
+        }
+        bAnyFile = true;
+        if (!FFileHelper::LoadFileToArray(FileData, *Path) || FileData.Num() < static_cast<int32>(sizeof(uint32)))
+        {
+            UE_LOG(LogInventoryKitJournal, Warning, TEXT("Checkpoint %s is unreadable, skipped."), *Path);
+            continue;
+        }
+
+        uint32 Magic = 0;
+        FMemory::Memcpy(&Magic, FileData.GetData(), sizeof(Magic));
+        if (Magic == FInventoryKitSnapshotHeader::ExpectedMagic)
+        {
+            // 旧格式: 整个文件就是快照
+            if (!bFound)
+            {
+                OutSnapshotData = MoveTemp(FileData);
+                bFound = true;
+            }
+            continue;
+        }
+
+        int32 Version = 0;
+        uint64 Sequence = 0;
+        uint32 Crc = 0;
+        if (FileData.Num() >= HeaderSize)
+        {
+            FMemory::Memcpy(&Version, FileData.GetData() + sizeof(Magic), sizeof(Version));
+            FMemory::Memcpy(&Sequence, FileData.GetData() + sizeof(Magic) + sizeof(Version), sizeof(Sequence));
+            FMemory::Memcpy(&Crc, FileData.GetData() + sizeof(Magic) + sizeof(Version) + sizeof(Sequence), sizeof(Crc));
+        }
+        if (Magic != CheckpointMagic || Version != CheckpointVersion
+            || FCrc::MemCrc32(FileData.GetData() + HeaderSize, FileData.Num() - HeaderSize) != Crc)
+        {
+            UE_LOG(LogInventoryKitJournal, Warning, TEXT("Checkpoint %s is incomplete, skipped."), *Path);
+            continue;
+        }
+
+        if (!bFound || Sequence > OutSequence)
+        {
+            OutSnapshotData = TArray<uint8>(FileData.GetData() + HeaderSize, FileData.Num() - HeaderSize);
+            OutSequence = Sequence;
+            bFound = true;
+        }
+    }
+
+    if (bAnyFile && !bFound)
+    {
+        UE_LOG(LogInventoryKitJournal, Error, TEXT("No complete checkpoint found at %s."), *InCheckpointPath);
+        return false;
+    }
+    return true;
+}
+
+bool FInventoryKitJournalWriter::ReadRecords(const FString& InJournalPath, TArray<FInventoryKitJournalRecord>& OutRecords, uint64& OutSequence)
+{
+    OutRecords.Reset();
+    OutSequence = 0;
+
+    TArray<uint8> FileData;
+    if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*InJournalPath))
+    {
+        return true;
+    }
+    if (!FFileHelper::LoadFileToArray(FileData, *InJournalPath))
+    {
+        UE_LOG(LogInventoryKitJournal, Error, TEXT("Failed to read journal file %s."), *InJournalPath);
+        return false;
+    }
+
+    // 版本1的文件头没有检查点序号, 视为0; 版本3只增加了记录类型, 文件头与版本2相同
+    constexpr int32 HeaderSizeV1 = sizeof(uint32) + sizeof(int32);
+    constexpr int32 HeaderSizeV2 = HeaderSizeV1 + sizeof(uint64);
+    constexpr int32 FrameHeaderSize = sizeof(int32) + sizeof(uint32);
+    uint32 Magic = 0;
+    int32 Version = 0;
+    if (FileData.Num() >= HeaderSizeV1)
+    {
+        FMemory::Memcpy(&Magic, FileData.GetData(), sizeof(Magic));
+        FMemory::Memcpy(&Version, FileData.GetData() + sizeof(Magic), sizeof(Version));
+    }
+    const int32 HeaderSize = Version == 1 ? HeaderSizeV1 : HeaderSizeV2;
+    if (Magic != FileMagic || Version < 1 || Version > FileVersion || FileData.Num() < HeaderSize)
+    {
+        UE_LOG(LogInventoryKitJournal, Error, TEXT("Invalid journal header in %s."), *InJournalPath);
+        return false;
+    }
+    if (Version >= 2)
+    {
+        FMemory::Memcpy(&OutSequence, FileData.GetData() + HeaderSizeV1, sizeof(OutSequence));
+    }
+
+    int32 Offset = HeaderSize;
+    while (Offset + FrameHeaderSize <= FileData.Num())
+    {
+        int32 Size = 0;
+        uint32 Crc = 0;
+        FMemory::Memcpy(&Size, FileData.GetData() + Offset, sizeof(Size));
+        FMemory::Memcpy(&Crc, FileData.GetData() + Offset + sizeof(Size), sizeof(Crc));
+        const int32 DataOffset = Offset + FrameHeaderSize;
+
+        // 崩溃时写了一半的帧及其之后的内容全部丢弃
+        if (Size < 0 || Size > FileData.Num() - DataOffset || FCrc::MemCrc32(FileData.GetData() + DataOffset, Size) != Crc)
+        {
+            UE_LOG(LogInventoryKitJournal, Warning, TEXT("Journal %s truncated at offset %d."), *InJournalPath, Offset);
+            break;
+        }
+
+        FMemoryReader Reader(FileData);
+        Reader.Seek(DataOffset);
+        const int64 FrameEnd = DataOffset + Size;
+        while (Reader.Tell() < FrameEnd && !Reader.IsError())
+        {
+            FInventoryKitJournalRecord Record;
+            Reader << Record;
+            if (!Reader.IsError())
+            {
+                OutRecords.Add(Record);
+            }
+        }
+        Offset = FrameEnd;
+    }
+    return true;
+}
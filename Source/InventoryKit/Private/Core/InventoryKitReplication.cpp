@@ -0,0 +1,82 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitReplication.h"
+
+#include "Core/InventoryKitBaseContainerComponent.h"
+
+void FInventoryKitReplicatedItem::PreReplicatedRemove(const FInventoryKitReplicatedItemArray& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->OnReplicatedItemRemoved(Item);
+    }
+}
+
+void FInventoryKitReplicatedItem::PostReplicatedAdd(const FInventoryKitReplicatedItemArray& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->OnReplicatedItemAdded(Item);
+    }
+}
+
+void FInventoryKitReplicatedItem::PostReplicatedChange(const FInventoryKitReplicatedItemArray& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->OnReplicatedItemChanged(Item);
+    }
+}
+
+void FInventoryKitReplicatedItemArray::AddOrUpdate(const FItemBaseInstance& InItem)
+{
+    if (const int32* Index = IndexByItemID.Find(InItem.ItemID))
+    {
+        FInventoryKitReplicatedItem& Entry = Items[*Index];
+        Entry.Item = InItem;
+        MarkItemDirty(Entry);
+        return;
+    }
+
+    const int32 Index = Items.AddDefaulted();
+    Items[Index].Item = InItem;
+    IndexByItemID.Add(InItem.ItemID, Index);
+    MarkItemDirty(Items[Index]);
+}
+
+void FInventoryKitReplicatedItemArray::Remove(int32 ItemId)
+{
+    int32 Index;
+    if (!IndexByItemID.RemoveAndCopyValue(ItemId, Index))
+    {
+        return;
+    }
+
+    // 与末尾元素交换, 客户端按ReplicationID识别条目, 顺序变化不会产生额外流量
+    Items.RemoveAtSwap(Index);
+    if (Index < Items.Num())
+    {
+        IndexByItemID[Items[Index].Item.ItemID] = Index;
+    }
+    MarkArrayDirty();
+}
+
+void FInventoryKitReplicatedItemArray::Reset()
+{
+    if (Items.Num() == 0)
+    {
+        return;
+    }
+
+    Items.Reset();
+    IndexByItemID.Reset();
+    MarkArrayDirty();
+}
+
+void FInventoryKitReplicatedItemArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+    if (Owner)
+    {
+        Owner->OnReplicatedItemsReceived();
+    }
+}
@@ -0,0 +1,250 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitTagIndex.h"
+
+namespace InventoryKitTagIndex
+{
+    // A ∪ B, 遍历较小的集合
+    FInventoryKitItemIdSet SetUnion(const FInventoryKitItemIdSet& A, const FInventoryKitItemIdSet& B)
+    {
+        const bool bAIsLarger = A.Num() >= B.Num();
+        FInventoryKitItemIdSet Result = bAIsLarger ? A : B;
+        for (const int32 ItemId : bAIsLarger ? B : A)
+        {
+            Result.Add(ItemId);
+        }
+        return Result;
+    }
+
+    // A ∩ B, 遍历较小的集合
+    FInventoryKitItemIdSet SetIntersect(const FInventoryKitItemIdSet& A, const FInventoryKitItemIdSet& B)
+    {
+        const FInventoryKitItemIdSet& Smaller = A.Num() <= B.Num() ? A : B;
+        const FInventoryKitItemIdSet& Larger = A.Num() <= B.Num() ? B : A;
+        FInventoryKitItemIdSet Result;
+        for (const int32 ItemId : Smaller)
+        {
+            if (Larger.Contains(ItemId))
+            {
+                Result.Add(ItemId);
+            }
+        }
+        return Result;
+    }
+
+    // A \ B
+    FInventoryKitItemIdSet SetDifference(const FInventoryKitItemIdSet& A, const FInventoryKitItemIdSet& B)
+    {
+        FInventoryKitItemIdSet Result;
+        for (const int32 ItemId : A)
+        {
+            if (!B.Contains(ItemId))
+            {
+                Result.Add(ItemId);
+            }
+        }
+        return Result;
+    }
+}
+
+void FInventoryKitTagIndex::AddItem(int32 ItemId, const FGameplayTagContainer& Tags)
+{
+    if (Tags.IsEmpty())
+    {
+        return;
+    }
+
+    for (const FGameplayTag& Tag : Tags.GetGameplayTagParents())
+    {
+        Postings.FindOrAdd(Tag).Add(ItemId);
+    }
+}
+
+void FInventoryKitTagIndex::RemoveItem(int32 ItemId, const FGameplayTagContainer& Tags)
+{
+    if (Tags.IsEmpty())
+    {
+        return;
+    }
+
+    for (const FGameplayTag& Tag : Tags.GetGameplayTagParents())
+    {
+        FInventoryKitItemIdSet* Posting = Postings.Find(Tag);
+        if (Posting && Posting->Remove(ItemId) && Posting->Num() == 0)
+        {
+            Postings.Remove(Tag);
+        }
+    }
+}
+
+void FInventoryKitTagIndex::Reset()
+{
+    Postings.Reset();
+}
+
+const FInventoryKitItemIdSet* FInventoryKitTagIndex::Find(const FGameplayTag& Tag) const
+{
+    return Postings.Find(Tag);
+}
+
+bool FInventoryKitTagIndex::Evaluate(const FGameplayTagQuery& Query, FResult& OutResult) const
+{
+    OutResult = FResult();
+
+    // 空查询不匹配任何物品, 与FGameplayTagQuery::Matches一致
+    if (Query.IsEmpty())
+    {
+        return true;
+    }
+
+    FGameplayTagQueryExpression Expr;
+    Query.GetQueryExpr(Expr);
+    return EvaluateExpr(Expr, OutResult);
+}
+
+bool FInventoryKitTagIndex::EvaluateExpr(const FGameplayTagQueryExpression& Expr, FResult& OutResult) const
+{
+    // 空表达式集合的结果与FGameplayTagQuery::Matches一致: Any为假, All和No为真
+    switch (Expr.ExprType)
+    {
+    case EGameplayTagQueryExprType::AnyTagsMatch:
+    case EGameplayTagQueryExprType::NoTagsMatch:
+        {
+            OutResult = FResult();
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                if (const FInventoryKitItemIdSet* Posting = Postings.Find(Tag))
+                {
+                    OutResult.Items = InventoryKitTagIndex::SetUnion(OutResult.Items, *Posting);
+                }
+            }
+            OutResult.bComplement = Expr.ExprType == EGameplayTagQueryExprType::NoTagsMatch;
+            return true;
+        }
+    case EGameplayTagQueryExprType::AllTagsMatch:
+        {
+            OutResult = FResult();
+            if (Expr.TagSet.Num() == 0)
+            {
+                OutResult.bComplement = true;
+                return true;
+            }
+
+            // 从最短的倒排表开始求交, 任一标签没有物品时结果为空
+            TArray<const FInventoryKitItemIdSet*, TInlineAllocator<8>> TagPostings;
+            for (const FGameplayTag& Tag : Expr.TagSet)
+            {
+                const FInventoryKitItemIdSet* Posting = Postings.Find(Tag);
+                if (!Posting)
+                {
+                    return true;
+                }
+                TagPostings.Add(Posting);
+            }
+            TagPostings.Sort([](const FInventoryKitItemIdSet& A, const FInventoryKitItemIdSet& B)
+            {
+                return A.Num() < B.Num();
+            });
+
+            for (const int32 ItemId : *TagPostings[0])
+            {
+                bool bInAll = true;
+                for (int32 Index = 1; Index < TagPostings.Num() && bInAll; ++Index)
+                {
+                    bInAll = TagPostings[Index]->Contains(ItemId);
+                }
+                if (bInAll)
+                {
+                    OutResult.Items.Add(ItemId);
+                }
+            }
+            return true;
+        }
+    case EGameplayTagQueryExprType::AnyExprMatch:
+    case EGameplayTagQueryExprType::NoExprMatch:
+        {
+            OutResult = FResult();
+            FResult SubResult;
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                if (!EvaluateExpr(SubExpr, SubResult))
+                {
+                    return false;
+                }
+                Union(OutResult, SubResult);
+            }
+            if (Expr.ExprType == EGameplayTagQueryExprType::NoExprMatch)
+            {
+                OutResult.bComplement = !OutResult.bComplement;
+            }
+            return true;
+        }
+    case EGameplayTagQueryExprType::AllExprMatch:
+        {
+            OutResult = FResult();
+            OutResult.bComplement = true;
+            FResult SubResult;
+            for (const FGameplayTagQueryExpression& SubExpr : Expr.ExprSet)
+            {
+                if (!EvaluateExpr(SubExpr, SubResult))
+                {
+                    return false;
+                }
+                Intersect(OutResult, SubResult);
+            }
+            return true;
+        }
+    default:
+        return false;
+    }
+}
+
+void FInventoryKitTagIndex::Union(FResult& A, const FResult& B)
+{
+    using namespace InventoryKitTagIndex;
+    if (!A.bComplement && !B.bComplement)
+    {
+        A.Items = SetUnion(A.Items, B.Items);
+    }
+    else if (!A.bComplement)
+    {
+        // A ∪ ~B = ~(B \ A)
+        A.Items = SetDifference(B.Items, A.Items);
+        A.bComplement = true;
+    }
+    else if (!B.bComplement)
+    {
+        // ~A ∪ B = ~(A \ B)
+        A.Items = SetDifference(A.Items, B.Items);
+    }
+    else
+    {
+        // ~A ∪ ~B = ~(A ∩ B)
+        A.Items = SetIntersect(A.Items, B.Items);
+    }
+}
+
+void FInventoryKitTagIndex::Intersect(FResult& A, const FResult& B)
+{
+    using namespace InventoryKitTagIndex;
+    if (!A.bComplement && !B.bComplement)
+    {
+        A.Items = SetIntersect(A.Items, B.Items);
+    }
+    else if (!A.bComplement)
+    {
+        // A ∩ ~B = A \ B
+        A.Items = SetDifference(A.Items, B.Items);
+    }
+    else if (!B.bComplement)
+    {
+        // ~A ∩ B = B \ A
+        A.Items = SetDifference(B.Items, A.Items);
+        A.bComplement = false;
+    }
+    else
+    {
+        // ~A ∩ ~B = ~(A ∪ B)
+        A.Items = SetUnion(A.Items, B.Items);
+    }
+}
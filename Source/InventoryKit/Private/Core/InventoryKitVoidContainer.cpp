@@ -14,6 +14,11 @@ const int32 UInventoryKitVoidContainer::GetContainerID() const
 	return ID;
 }
 
+FString UInventoryKitVoidContainer::GetPersistentKey() const
+{
+	return TEXT("InventoryKit.Void");
+}
+
 bool UInventoryKitVoidContainer::CanAddItem(const FItemBaseInstance& InItem, int32 DstSlotIndex)
 {
 	return true;
@@ -27,30 +32,147 @@ bool UInventoryKitVoidContainer::CanMoveItem(const FItemBaseInstance& InItem, in
 void UInventoryKitVoidContainer::OnItemAdded(const FItemBaseInstance& InItem)
 {
 	// 如果物品已经在背包中，不重复添加
-	if (!ItemIds.Contains(InItem.ItemID))
+	if (ItemIds.Add(InItem.ItemID) && bTrackEnterTimes)
+	{
+		RecordEnter(InItem.ItemID, FPlatformTime::Seconds());
+	}
+}
+
+void UInventoryKitVoidContainer::RecordEnter(int32 ItemId, double Now)
+{
+	EnterTimes.Add(ItemId, Now);
+	EntryQueue.Add({ ItemId, Now });
+}
+
+void UInventoryKitVoidContainer::CompactEntryQueue()
+{
+	int32 NumKept = 0;
+	for (int32 Index = EntryHead; Index < EntryQueue.Num(); ++Index)
+	{
+		const FVoidEntry& Entry = EntryQueue[Index];
+		const double* EnterTime = EnterTimes.Find(Entry.ItemId);
+		if (EnterTime && *EnterTime == Entry.EnterTime)
+		{
+			EntryQueue[NumKept++] = Entry;
+		}
+	}
+	EntryQueue.SetNum(NumKept);
+	EntryHead = 0;
+	NumStaleEntries = 0;
+}
+
+void UInventoryKitVoidContainer::SetTrackEnterTimes(bool bInTrackEnterTimes)
+{
+	if (bTrackEnterTimes == bInTrackEnterTimes)
 	{
-		ItemIds.Add(InItem.ItemID);
+		return;
+	}
+
+	bTrackEnterTimes = bInTrackEnterTimes;
+	EntryQueue.Reset();
+	EntryHead = 0;
+	EnterTimes.Reset();
+	NumStaleEntries = 0;
+	if (bTrackEnterTimes)
+	{
+		const double Now = FPlatformTime::Seconds();
+		for (const int32 ItemId : ItemIds.GetItems())
+		{
+			RecordEnter(ItemId, Now);
+		}
 	}
 }
 
+int32 UInventoryKitVoidContainer::CollectExpiredItems(double Now, double MaxAge, int32 MaxEntries, TArray<int32>& OutItemIds)
+{
+	// 跳过的过期记录同样计入预算, 大量物品进出虚空后单次调用的耗时仍有上限
+	int32 NumCollected = 0;
+	const int32 EntryEnd = EntryHead + FMath::Min(MaxEntries, EntryQueue.Num() - EntryHead);
+	while (EntryHead < EntryEnd)
+	{
+		const FVoidEntry& Entry = EntryQueue[EntryHead];
+		if (Now - Entry.EnterTime < MaxAge)
+		{
+			break;
+		}
+		++EntryHead;
+
+		// 物品离开后又重新进入时以最近一次的记录为准
+		const double* EnterTime = EnterTimes.Find(Entry.ItemId);
+		if (EnterTime && *EnterTime == Entry.EnterTime)
+		{
+			OutItemIds.Add(Entry.ItemId);
+			++NumCollected;
+		}
+		else
+		{
+			--NumStaleEntries;
+		}
+	}
+
+	// 已检查的部分超过一半时整体前移, 队列长度与虚空中的记录数成正比
+	if (EntryHead == EntryQueue.Num())
+	{
+		EntryQueue.Reset();
+		EntryHead = 0;
+	}
+	else if (EntryHead >= 1024 && EntryHead * 2 >= EntryQueue.Num())
+	{
+		EntryQueue.RemoveAt(0, EntryHead);
+		EntryHead = 0;
+	}
+	return NumCollected;
+}
+
 void UInventoryKitVoidContainer::OnItemMoved(const FItemLocation& OldLocation, const FItemBaseInstance& InItem)
 {
 }
 
 void UInventoryKitVoidContainer::OnItemRemoved(const FItemBaseInstance& InItem)
 {
-	if (ItemIds.Contains(InItem.ItemID))
+	if (ItemIds.Remove(InItem.ItemID) && EnterTimes.Remove(InItem.ItemID) > 0)
 	{
-		ItemIds.Remove(InItem.ItemID);
+		// 离开的物品在队列中留下一条失效记录, 失效记录过多时压缩, 队列长度与虚空中的物品数成正比
+		++NumStaleEntries;
+		if (NumStaleEntries >= 1024 && NumStaleEntries * 2 >= EntryQueue.Num() - EntryHead)
+		{
+			CompactEntryQueue();
+		}
 	}
 }
 
 const TArray<int32>& UInventoryKitVoidContainer::GetAllItems() const
 {
-	return ItemIds;
+	return ItemIds.GetItems();
 }
 
 UContainerSpaceManager* UInventoryKitVoidContainer::GetSpaceManager()
 {
 	return SpaceManager;
 }
+
+bool UInventoryKitVoidContainer::ContainsItem(int32 ItemId) const
+{
+	return ItemIds.Contains(ItemId);
+}
+
+void UInventoryKitVoidContainer::RestoreContents(TConstArrayView<int32> InItemIds)
+{
+	ItemIds.Reset();
+	ItemIds.Reserve(InItemIds.Num());
+	EntryQueue.Reset(InItemIds.Num());
+	EntryHead = 0;
+	EnterTimes.Reset();
+	NumStaleEntries = 0;
+
+	// 快照不保存进入时间, 加载的物品从加载时开始计时
+	const double Now = FPlatformTime::Seconds();
+	for (const int32 ItemId : InItemIds)
+	{
+		ItemIds.Add(ItemId);
+		if (bTrackEnterTimes)
+		{
+			RecordEnter(ItemId, Now);
+		}
+	}
+}
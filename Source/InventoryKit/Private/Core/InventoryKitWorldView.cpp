@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitWorldView.h"
+
+#include "Core/InventoryKitSlotMap.h"
+#include "Interfaces/ContainerInterfaces.h"
+
+const FItemBaseInstance* FInventoryKitWorldView::FindItem(int32 ItemId) const
+{
+    if (ItemId < 0)
+    {
+        return nullptr;
+    }
+
+    const int32 EntryIndex = TInventoryKitSlotMap<FItemBaseInstance>::GetEntryIndex(ItemId);
+    const int32 ChunkIndex = EntryIndex >> ChunkBits;
+    if (!Chunks.IsValidIndex(ChunkIndex) || !Chunks[ChunkIndex])
+    {
+        return nullptr;
+    }
+
+    // 条目被新物品复用时世代不同, 比较完整的ID
+    const FItemBaseInstance& Item = (*Chunks[ChunkIndex])[EntryIndex & (ChunkSize - 1)];
+    return Item.ItemID == ItemId ? &Item : nullptr;
+}
+
+const FInventoryKitWorldView::FContainerEntry* FInventoryKitWorldView::FindContainer(int32 ContainerID) const
+{
+    if (ContainerID < 0)
+    {
+        return nullptr;
+    }
+
+    const int32 EntryIndex = TInventoryKitSlotMap<IInventoryKitContainerInterface*>::GetEntryIndex(ContainerID);
+    const int32 ChunkIndex = EntryIndex >> ContainerChunkBits;
+    if (!ContainerChunks.IsValidIndex(ChunkIndex) || !ContainerChunks[ChunkIndex])
+    {
+        return nullptr;
+    }
+
+    const FContainerEntry& Entry = (*ContainerChunks[ChunkIndex])[EntryIndex & (ContainerChunkSize - 1)];
+    return Entry.ContainerID == ContainerID ? &Entry : nullptr;
+}
+
+TConstArrayView<int32> FInventoryKitWorldView::GetItemsInContainer(int32 ContainerID) const
+{
+    const FContainerEntry* Entry = FindContainer(ContainerID);
+    return Entry && Entry->Items ? TConstArrayView<int32>(*Entry->Items) : TConstArrayView<int32>();
+}
+
+uint64 FInventoryKitWorldView::GetContainerVersion(int32 ContainerID) const
+{
+    const FContainerEntry* Entry = FindContainer(ContainerID);
+    return Entry ? Entry->Version : 0;
+}
+
+int32 FInventoryKitWorldView::GetParentContainerID(int32 ContainerID) const
+{
+    const int32* HostItemId = ContainerHostItems ? ContainerHostItems->Find(ContainerID) : nullptr;
+    if (!HostItemId)
+    {
+        return INDEX_NONE;
+    }
+    const FItemBaseInstance* HostItem = FindItem(*HostItemId);
+    return HostItem ? HostItem->ItemLocation.ContainerID : INDEX_NONE;
+}
+
+int32 FInventoryKitWorldView::GetHostedContainerID(int32 ItemId) const
+{
+    const int32* HostedContainerID = ItemHostedContainers ? ItemHostedContainers->Find(ItemId) : nullptr;
+    return HostedContainerID ? *HostedContainerID : INDEX_NONE;
+}
+
+TArray<int32> FInventoryKitWorldView::GetItemsInContainerRecursive(int32 ContainerID) const
+{
+    TArray<int32> Result;
+    TArray<int32, TInlineAllocator<16>> PendingContainers;
+    TSet<int32, DefaultKeyFuncs<int32>, TInlineSetAllocator<16>> VisitedContainers;
+    PendingContainers.Add(ContainerID);
+    VisitedContainers.Add(ContainerID);
+    const bool bHasNesting = ItemHostedContainers && ItemHostedContainers->Num() > 0;
+    for (int32 Index = 0; Index < PendingContainers.Num(); ++Index)
+    {
+        const TConstArrayView<int32> Items = GetItemsInContainer(PendingContainers[Index]);
+        Result.Append(Items);
+        if (!bHasNesting)
+        {
+            continue;
+        }
+
+        // 每个子容器只展开一次, 嵌套关系意外成环时也能结束
+        for (const int32 ItemId : Items)
+        {
+            const int32* HostedContainerID = ItemHostedContainers->Find(ItemId);
+            bool bAlreadyVisited = true;
+            if (HostedContainerID)
+            {
+                VisitedContainers.Add(*HostedContainerID, &bAlreadyVisited);
+            }
+            if (!bAlreadyVisited)
+            {
+                PendingContainers.Add(*HostedContainerID);
+            }
+        }
+    }
+    return Result;
+}
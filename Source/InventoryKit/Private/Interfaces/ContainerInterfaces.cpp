@@ -4,29 +4,51 @@
 #include "ContainerSpace/GridSpaceManager.h"
 #include "ContainerSpace/UnorderedSpaceManager.h"
 
-UContainerSpaceManager* IInventoryKitContainerInterface::CreateSpaceManager(UObject* InOuter,
-                                                                            const FContainerSpaceConfig& InConfig)
+void IInventoryKitContainerInterface::OnItemsAdded(TConstArrayView<FItemBaseInstance> InItems)
+{
+	for (const FItemBaseInstance& Item : InItems)
+	{
+		OnItemAdded(Item);
+	}
+}
+
+void IInventoryKitContainerInterface::OnItemsMoved(TConstArrayView<FItemLocation> OldLocations,
+                                                   TConstArrayView<FItemBaseInstance> InItems)
+{
+	check(OldLocations.Num() == InItems.Num());
+	for (int32 Index = 0; Index < InItems.Num(); ++Index)
+	{
+		OnItemMoved(OldLocations[Index], InItems[Index]);
+	}
+}
+
+void IInventoryKitContainerInterface::OnItemsRemoved(TConstArrayView<FItemBaseInstance> InItems)
+{
+	for (const FItemBaseInstance& Item : InItems)
+	{
+		OnItemRemoved(Item);
+	}
+}
+
+UClass* IInventoryKitContainerInterface::GetSpaceManagerClass(EContainerSpaceType InSpaceType)
 {
-	UContainerSpaceManager* Ret = nullptr;
-	switch (InConfig.SpaceType) {
+	switch (InSpaceType) {
 		case EContainerSpaceType::Unordered:
-			{
-				Ret = NewObject<UUnorderedSpaceManager>(InOuter);
-			}
-			break;
+			return UUnorderedSpaceManager::StaticClass();
 		case EContainerSpaceType::Fixed:
-			{
-				Ret = NewObject<UFixedSlotSpaceManager>(InOuter);
-			}
-			break;
+			return UFixedSlotSpaceManager::StaticClass();
 		case EContainerSpaceType::Grid:
-			{
-				Ret = NewObject<UGridSpaceManager>(InOuter);
-			}
-			break;
+			return UGridSpaceManager::StaticClass();
 	}
+	return nullptr;
+}
 
-	check(Ret);
+UContainerSpaceManager* IInventoryKitContainerInterface::CreateSpaceManager(UObject* InOuter,
+                                                                            const FContainerSpaceConfig& InConfig)
+{
+	UClass* SpaceManagerClass = GetSpaceManagerClass(InConfig.SpaceType);
+	check(SpaceManagerClass);
+	UContainerSpaceManager* Ret = NewObject<UContainerSpaceManager>(InOuter, SpaceManagerClass);
 	Ret->Initialize(InConfig);
 
 	return Ret;
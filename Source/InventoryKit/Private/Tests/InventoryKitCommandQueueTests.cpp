@@ -0,0 +1,245 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitCommandQueue.h"
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitCommandQueueTests
+{
+    constexpr int32 NumProducers = 8;
+    constexpr int32 NumCommandsPerProducer = 2000;
+    constexpr int32 NumCommands = NumProducers * NumCommandsPerProducer;
+
+    // 物品ID记录生产者, 槽位记录生产者内的提交序号
+    FInventoryKitTransaction MakeTransaction(int32 Producer, int32 Sequence)
+    {
+        FInventoryKitTransaction Transaction;
+        Transaction.StageMove(Producer, FItemLocation(0, Sequence));
+        return Transaction;
+    }
+
+    /**
+     * 每个生产者独占一个线程, 偶数序号以Future方式提交, 奇数序号以回调方式提交
+     * 回调在消费线程执行, 即调用Drain或CancelAll的测试线程
+     */
+    struct FProducers
+    {
+        TArray<TArray<TFuture<FInventoryKitCommandResult>>> Futures;
+        TArray<TFuture<void>> Threads;
+        std::atomic<int32> NumFinished { 0 };
+        int32 NumCallbacks = 0;
+        int32 NumFailedCallbacks = 0;
+
+        void Start(FInventoryKitCommandQueue& Queue)
+        {
+            Futures.SetNum(NumProducers);
+            for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+            {
+                Threads.Add(Async(EAsyncExecution::Thread, [this, &Queue, Producer]()
+                {
+                    Futures[Producer].Reserve(NumCommandsPerProducer / 2);
+                    for (int32 Sequence = 0; Sequence < NumCommandsPerProducer; ++Sequence)
+                    {
+                        if (Sequence % 2 == 0)
+                        {
+                            Futures[Producer].Add(Queue.Submit(MakeTransaction(Producer, Sequence)));
+                            continue;
+                        }
+                        Queue.Submit(MakeTransaction(Producer, Sequence), [this](const FInventoryKitCommandResult& Result)
+                        {
+                            ++NumCallbacks;
+                            NumFailedCallbacks += Result.bSucceeded ? 0 : 1;
+                        });
+                    }
+                    NumFinished.fetch_add(1);
+                }));
+            }
+        }
+
+        bool IsFinished() const
+        {
+            return NumFinished.load() == NumProducers;
+        }
+
+        void Wait()
+        {
+            for (TFuture<void>& Thread : Threads)
+            {
+                Thread.Wait();
+            }
+        }
+    };
+
+    // 校验每个生产者的命令按提交顺序执行, 并记录执行结果
+    struct FConsumer
+    {
+        TArray<int32> NextSequence;
+        int32 NumExecuted = 0;
+        bool bInOrder = true;
+
+        FConsumer()
+        {
+            NextSequence.Init(0, NumProducers);
+        }
+
+        // 每4条命令中有1条执行失败
+        static bool ShouldSucceed(int32 Sequence)
+        {
+            return Sequence % 4 != 2;
+        }
+
+        bool Execute(const FInventoryKitTransaction& Transaction, TArray<int32>& OutCreatedItemIds)
+        {
+            const FInventoryKitTransaction::FOp& Op = Transaction.GetOps()[0];
+            bInOrder &= NextSequence.IsValidIndex(Op.ItemID) && Op.Location.SlotIndex == NextSequence[Op.ItemID]++;
+            ++NumExecuted;
+            OutCreatedItemIds.Add(Op.ItemID);
+            return ShouldSucceed(Op.Location.SlotIndex);
+        }
+    };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitCommandQueueMultiProducerTest, "InventoryKit.CommandQueue.MultiProducer",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitCommandQueueMultiProducerTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitCommandQueueTests;
+
+    FInventoryKitCommandQueue Queue;
+    FProducers Producers;
+    FConsumer Consumer;
+    auto Execute = [&Consumer](const FInventoryKitTransaction& Transaction, TArray<int32>& OutCreatedItemIds)
+    {
+        return Consumer.Execute(Transaction, OutCreatedItemIds);
+    };
+
+    // 生产者提交的同时按预算成批处理, 直到所有命令都处理完
+    constexpr int32 DrainBudget = 64;
+    bool bBudgetRespected = true;
+    Producers.Start(Queue);
+    while (!Producers.IsFinished() || Queue.GetNumPending() > 0)
+    {
+        const int32 NumProcessed = Queue.Drain(Execute, DrainBudget);
+        bBudgetRespected &= NumProcessed <= DrainBudget;
+        if (NumProcessed == 0)
+        {
+            FPlatformProcess::Yield();
+        }
+    }
+    Producers.Wait();
+
+    TestTrue(TEXT("Drain never exceeds its budget"), bBudgetRespected);
+    TestTrue(TEXT("Commands of each producer run in submission order"), Consumer.bInOrder);
+    TestEqual(TEXT("Every command is executed once"), Consumer.NumExecuted, NumCommands);
+    TestEqual(TEXT("Every callback is invoked"), Producers.NumCallbacks, NumCommands / 2);
+    TestEqual(TEXT("No command is left pending"), Queue.GetNumPending(), 0);
+
+    int32 NumNotReady = 0;
+    int32 NumWrongResults = 0;
+    for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+    {
+        for (int32 Index = 0; Index < Producers.Futures[Producer].Num(); ++Index)
+        {
+            const TFuture<FInventoryKitCommandResult>& Future = Producers.Futures[Producer][Index];
+            if (!Future.IsReady())
+            {
+                ++NumNotReady;
+                continue;
+            }
+            const FInventoryKitCommandResult& Result = Future.Get();
+            const bool bExpectedSuccess = FConsumer::ShouldSucceed(Index * 2);
+            if (Result.bSucceeded != bExpectedSuccess || Result.CreatedItemIds.Num() != 1 || Result.CreatedItemIds[0] != Producer)
+            {
+                ++NumWrongResults;
+            }
+        }
+    }
+    TestEqual(TEXT("Every future is completed"), NumNotReady, 0);
+    TestEqual(TEXT("Every future carries its own result"), NumWrongResults, 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitCommandQueueCancelAllTest, "InventoryKit.CommandQueue.CancelAll",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitCommandQueueCancelAllTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitCommandQueueTests;
+
+    FInventoryKitCommandQueue Queue;
+    FProducers Producers;
+    FConsumer Consumer;
+    auto Execute = [&Consumer](const FInventoryKitTransaction& Transaction, TArray<int32>& OutCreatedItemIds)
+    {
+        return Consumer.Execute(Transaction, OutCreatedItemIds);
+    };
+
+    // 提交期间只处理一小部分, 模拟物品系统在命令未处理完时关闭
+    Producers.Start(Queue);
+    while (!Producers.IsFinished())
+    {
+        Queue.Drain(Execute, 8);
+        FPlatformProcess::Yield();
+    }
+    Producers.Wait();
+
+    // 生产者结束后待处理数量固定, 预算内的命令全部处理
+    const int32 NumPendingBeforeDrain = Queue.GetNumPending();
+    TestEqual(TEXT("Drain processes exactly its budget"), Queue.Drain(Execute, 5), FMath::Min(5, NumPendingBeforeDrain));
+    TestEqual(TEXT("Pending count drops by the processed amount"), Queue.GetNumPending(), NumPendingBeforeDrain - FMath::Min(5, NumPendingBeforeDrain));
+
+    const int32 NumExecutedBeforeCancel = Consumer.NumExecuted;
+    Queue.CancelAll();
+    TestEqual(TEXT("CancelAll leaves nothing pending"), Queue.GetNumPending(), 0);
+    TestEqual(TEXT("CancelAll does not execute commands"), Consumer.NumExecuted, NumExecutedBeforeCancel);
+    TestEqual(TEXT("Drain after CancelAll processes nothing"), Queue.Drain(Execute), 0);
+    TestTrue(TEXT("Commands of each producer run in submission order"), Consumer.bInOrder);
+    TestEqual(TEXT("Every callback is invoked"), Producers.NumCallbacks, NumCommands / 2);
+
+    // 已执行的命令带有执行结果, 被取消的命令以失败结果完成
+    int32 NumNotReady = 0;
+    int32 NumCancelled = 0;
+    int32 NumWrongResults = 0;
+    for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+    {
+        for (int32 Index = 0; Index < Producers.Futures[Producer].Num(); ++Index)
+        {
+            const TFuture<FInventoryKitCommandResult>& Future = Producers.Futures[Producer][Index];
+            if (!Future.IsReady())
+            {
+                ++NumNotReady;
+                continue;
+            }
+            const FInventoryKitCommandResult& Result = Future.Get();
+            const bool bExecuted = Index * 2 < Consumer.NextSequence[Producer];
+            if (!bExecuted)
+            {
+                ++NumCancelled;
+                NumWrongResults += Result.bSucceeded || Result.CreatedItemIds.Num() > 0 ? 1 : 0;
+            }
+            else if (Result.bSucceeded != FConsumer::ShouldSucceed(Index * 2) || Result.CreatedItemIds.Num() != 1)
+            {
+                ++NumWrongResults;
+            }
+        }
+    }
+    TestEqual(TEXT("Every future is completed"), NumNotReady, 0);
+    TestEqual(TEXT("Every future carries the expected result"), NumWrongResults, 0);
+
+    // 每个生产者从下一个待执行的序号起全部被取消
+    int32 NumExpectedCancelled = 0;
+    for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+    {
+        NumExpectedCancelled += NumCommandsPerProducer - Consumer.NextSequence[Producer];
+    }
+    TestEqual(TEXT("Executed and cancelled commands add up"), Consumer.NumExecuted + NumExpectedCancelled, NumCommands);
+
+    // 回调方式提交的都是奇数序号, 执行时总是成功, 失败的回调都来自取消
+    TestEqual(TEXT("Cancelled callbacks report failure"), Producers.NumFailedCallbacks, NumExpectedCancelled - NumCancelled);
+    return true;
+}
+
+#endif
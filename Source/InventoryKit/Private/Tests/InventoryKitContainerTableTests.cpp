@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "Core/InventoryKitSlotMap.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitContainerRecyclingTest, "InventoryKit.ContainerTable.Recycling",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitContainerRecyclingTest::RunTest(const FString& Parameters)
+{
+    using FContainerTable = TInventoryKitSlotMap<IInventoryKitContainerInterface*>;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 注销带有物品的容器, 物品按默认策略移入虚空
+    UInventoryKitBaseContainerComponent* Chest = TestWorld.SpawnGridContainer(5, 5);
+    const int32 StaleID = Chest->GetContainerID();
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < 3; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(StaleID, Slot)));
+    }
+    if (!TestFalse(TEXT("Items are created"), ItemIds.Contains(INDEX_NONE)))
+    {
+        return false;
+    }
+
+    TestWorld.DestroyContainer(Chest);
+    TestNull(TEXT("Unregistered container is not found"), ItemSystem->FindContainer(StaleID));
+    TestEqual(TEXT("Unregistered container has no items"), ItemSystem->GetItemsInContainerView(StaleID).Num(), 0);
+    int32 NumNotInVoid = 0;
+    for (const int32 ItemId : ItemIds)
+    {
+        FItemLocation Location;
+        NumNotInVoid += ItemSystem->GetItemLocation(ItemId, Location) && Location.ContainerID == ItemSystem->GetVoidContainerID() ? 0 : 1;
+    }
+    TestEqual(TEXT("Orphan items move to the void"), NumNotInVoid, 0);
+
+    // 新容器复用同一条目, 世代不同, 旧ID不会命中新容器
+    UInventoryKitBaseContainerComponent* Replacement = TestWorld.SpawnGridContainer(5, 5);
+    const int32 RecycledID = Replacement->GetContainerID();
+    TestEqual(TEXT("Freed entry is reused"), FContainerTable::GetEntryIndex(RecycledID), FContainerTable::GetEntryIndex(StaleID));
+    TestNotEqual(TEXT("Reused entry has a new generation"), FContainerTable::GetGeneration(RecycledID), FContainerTable::GetGeneration(StaleID));
+    TestNull(TEXT("Stale ID still misses"), ItemSystem->FindContainer(StaleID));
+    TestNotNull(TEXT("Recycled ID resolves"), ItemSystem->FindContainer(RecycledID));
+    TestFalse(TEXT("Move into a stale container fails"), ItemSystem->MoveItem(ItemIds[0], FItemLocation(StaleID, 0)));
+    TestTrue(TEXT("Move into the recycled container succeeds"), ItemSystem->MoveItem(ItemIds[0], FItemLocation(RecycledID, 0)));
+    TestWorld.DestroyContainer(Replacement);
+
+    // 反复注册和注销超过一轮世代, 分配出的ID从不重复
+    TSet<int32> IssuedIds;
+    IssuedIds.Add(StaleID);
+    IssuedIds.Add(RecycledID);
+    int32 NumDuplicates = 0;
+    for (int32 Cycle = 0; Cycle < 2 * (FContainerTable::MaxGeneration + 1); ++Cycle)
+    {
+        UInventoryKitBaseContainerComponent* Container = TestWorld.SpawnGridContainer(1, 1);
+        bool bAlreadyIssued = false;
+        IssuedIds.Add(Container->GetContainerID(), &bAlreadyIssued);
+        NumDuplicates += bAlreadyIssued ? 1 : 0;
+        TestWorld.DestroyContainer(Container);
+    }
+    TestEqual(TEXT("Container IDs are never reissued"), NumDuplicates, 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitMoveItemBenchmarkTest, "InventoryKit.ContainerTable.MoveItemBenchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitMoveItemBenchmarkTest::RunTest(const FString& Parameters)
+{
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 两个32x32的容器之间来回移动, 每次移动都要解析源容器和目标容器
+    constexpr int32 GridSize = 32;
+    constexpr int32 NumItems = GridSize * GridSize;
+    constexpr int32 NumRounds = 20;
+    const int32 ContainerIds[2] = {
+        TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID(),
+        TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID()
+    };
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < NumItems; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(ContainerIds[0], Slot)));
+    }
+
+    int32 NumFailed = 0;
+    const double StartTime = FPlatformTime::Seconds();
+    for (int32 Round = 0; Round < NumRounds; ++Round)
+    {
+        const int32 TargetID = ContainerIds[(Round + 1) % 2];
+        for (int32 Slot = 0; Slot < NumItems; ++Slot)
+        {
+            NumFailed += ItemSystem->MoveItem(ItemIds[Slot], FItemLocation(TargetID, Slot)) ? 0 : 1;
+        }
+    }
+    const double MoveTime = FPlatformTime::Seconds() - StartTime;
+    TestEqual(TEXT("Every move succeeds"), NumFailed, 0);
+
+    // 对比: 同样次数的源容器和目标容器解析, 分别用替换前的TMap和容器槽位表
+    // 每次交替两个容器的ID, 避免查找被提到循环外
+    TMap<int32, IInventoryKitContainerInterface*> ContainerByID;
+    for (const int32 ContainerID : ContainerIds)
+    {
+        ContainerByID.Add(ContainerID, ItemSystem->FindContainer(ContainerID));
+    }
+
+    int32 NumMapMisses = 0;
+    double LookupStartTime = FPlatformTime::Seconds();
+    for (int32 Round = 0; Round < NumRounds; ++Round)
+    {
+        for (int32 Slot = 0; Slot < NumItems; ++Slot)
+        {
+            NumMapMisses += ContainerByID.FindRef(ContainerIds[(Round + Slot) % 2]) && ContainerByID.FindRef(ContainerIds[(Round + Slot + 1) % 2]) ? 0 : 1;
+        }
+    }
+    const double MapLookupTime = FPlatformTime::Seconds() - LookupStartTime;
+
+    int32 NumTableMisses = 0;
+    LookupStartTime = FPlatformTime::Seconds();
+    for (int32 Round = 0; Round < NumRounds; ++Round)
+    {
+        for (int32 Slot = 0; Slot < NumItems; ++Slot)
+        {
+            NumTableMisses += ItemSystem->FindContainer(ContainerIds[(Round + Slot) % 2]) && ItemSystem->FindContainer(ContainerIds[(Round + Slot + 1) % 2]) ? 0 : 1;
+        }
+    }
+    const double TableLookupTime = FPlatformTime::Seconds() - LookupStartTime;
+    TestEqual(TEXT("TMap resolves every container"), NumMapMisses, 0);
+    TestEqual(TEXT("Container table resolves every container"), NumTableMisses, 0);
+
+    constexpr int32 NumMoves = NumRounds * NumItems;
+    AddInfo(FString::Printf(TEXT("%d moves between two %dx%d grids: %.3f us per MoveItem; resolving both containers: TMap %.3f ns, container table %.3f ns"),
+                            NumMoves, GridSize, GridSize, MoveTime * 1e6 / NumMoves, MapLookupTime * 1e9 / NumMoves, TableLookupTime * 1e9 / NumMoves));
+    return true;
+}
+
+#endif
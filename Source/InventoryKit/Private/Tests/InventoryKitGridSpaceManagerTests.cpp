@@ -0,0 +1,252 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ContainerSpace/GridSpaceManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitGridSpaceManagerTests
+{
+    UGridSpaceManager* MakeGrid(int32 Width, int32 Height)
+    {
+        FContainerSpaceConfig Config;
+        Config.SpaceType = EContainerSpaceType::Grid;
+        Config.GridWidth = Width;
+        Config.GridHeight = Height;
+
+        UGridSpaceManager* Grid = NewObject<UGridSpaceManager>();
+        Grid->Initialize(Config);
+        return Grid;
+    }
+
+    /**
+     * 逐格记录占用的参考实现, 按槽位索引顺序暴力查找
+     */
+    struct FReferenceGrid
+    {
+        int32 Width;
+        int32 Height;
+        TArray<bool> Occupied;
+
+        FReferenceGrid(int32 InWidth, int32 InHeight)
+            : Width(InWidth)
+            , Height(InHeight)
+        {
+            Occupied.Init(false, Width * Height);
+        }
+
+        bool CanPlace(int32 X, int32 Y, const FIntPoint& Footprint) const
+        {
+            if (X < 0 || Y < 0 || X + Footprint.X > Width || Y + Footprint.Y > Height)
+            {
+                return false;
+            }
+            for (int32 Row = Y; Row < Y + Footprint.Y; ++Row)
+            {
+                for (int32 Column = X; Column < X + Footprint.X; ++Column)
+                {
+                    if (Occupied[Row * Width + Column])
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        int32 FindFirstFit(const FIntPoint& Footprint) const
+        {
+            for (int32 Index = 0; Index < Occupied.Num(); ++Index)
+            {
+                if (CanPlace(Index % Width, Index / Width, Footprint))
+                {
+                    return Index;
+                }
+            }
+            return INDEX_NONE;
+        }
+
+        void Fill(int32 Index, const FIntPoint& Footprint)
+        {
+            for (int32 Row = 0; Row < Footprint.Y; ++Row)
+            {
+                for (int32 Column = 0; Column < Footprint.X; ++Column)
+                {
+                    Occupied[Index + Row * Width + Column] = true;
+                }
+            }
+        }
+    };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitGridFirstFitTest, "InventoryKit.GridSpaceManager.FirstFit",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitGridFirstFitTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitGridSpaceManagerTests;
+
+    // 100x100的网格随机占满97%, 空位分散在各行, 行尾跨越64位字的边界
+    constexpr int32 GridSize = 100;
+    UGridSpaceManager* Grid = MakeGrid(GridSize, GridSize);
+    FReferenceGrid Reference(GridSize, GridSize);
+    FRandomStream Random(6);
+    for (int32 Index = 0; Index < GridSize * GridSize; ++Index)
+    {
+        if (Random.FRand() < 0.97f)
+        {
+            Grid->UpdateSlotState(Index, 1);
+            Reference.Fill(Index, FIntPoint(1, 1));
+        }
+    }
+
+    int32 NumMismatches = 0;
+    for (int32 Index = 0; Index < GridSize * GridSize; ++Index)
+    {
+        NumMismatches += Grid->IsSlotAvailable(Index) == !Reference.Occupied[Index] ? 0 : 1;
+    }
+    TestEqual(TEXT("Slot availability matches the reference"), NumMismatches, 0);
+
+    constexpr int32 NumQueries = 10000;
+    bool bRotated = false;
+    int32 FirstFit = INDEX_NONE;
+    const double StartTime = FPlatformTime::Seconds();
+    for (int32 Query = 0; Query < NumQueries; ++Query)
+    {
+        FirstFit = Grid->FindFirstFit(FIntPoint(1, 1), false, bRotated);
+    }
+    const double QueryTime = FPlatformTime::Seconds() - StartTime;
+    TestEqual(TEXT("First fit on a near-full grid"), FirstFit, Reference.FindFirstFit(FIntPoint(1, 1)));
+    AddInfo(FString::Printf(TEXT("First fit on a 97%% full %dx%d grid: %.3f us per query"), GridSize, GridSize, QueryTime * 1e6 / NumQueries));
+
+    // 逐个填满剩余空位, 每一步都与参考实现一致, 填满后找不到位置
+    NumMismatches = 0;
+    for (int32 Slot = Grid->GetRecommendedSlotIndex(); Slot != INDEX_NONE; Slot = Grid->GetRecommendedSlotIndex())
+    {
+        NumMismatches += Slot == Reference.FindFirstFit(FIntPoint(1, 1)) ? 0 : 1;
+        if (!Grid->IsSlotAvailable(Slot))
+        {
+            AddError(FString::Printf(TEXT("Recommended slot %d is occupied"), Slot));
+            break;
+        }
+        Grid->UpdateSlotState(Slot, 1);
+        Reference.Fill(Slot, FIntPoint(1, 1));
+    }
+    TestEqual(TEXT("Recommended slots follow the reference order"), NumMismatches, 0);
+    TestEqual(TEXT("Full grid has no first fit"), Grid->FindFirstFit(FIntPoint(1, 1), false, bRotated), INDEX_NONE);
+
+    // 释放最后一格后只有这一格可用
+    const int32 LastSlot = GridSize * GridSize - 1;
+    Grid->UpdateSlotState(LastSlot, 0);
+    TestEqual(TEXT("Freed last slot is found"), Grid->GetRecommendedSlotIndex(), LastSlot);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitGridFootprintTest, "InventoryKit.GridSpaceManager.Footprint",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitGridFootprintTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitGridSpaceManagerTests;
+
+    // 允许旋转时取两个方向中位置更靠前的一个, 与参考实现逐格比较
+    auto ExpectedFirstFit = [](const FReferenceGrid& Reference, const FIntPoint& Size, bool& bOutRotated)
+    {
+        const int32 Index = Reference.FindFirstFit(Size);
+        const int32 RotatedIndex = Size.X != Size.Y ? Reference.FindFirstFit(FIntPoint(Size.Y, Size.X)) : INDEX_NONE;
+        bOutRotated = RotatedIndex != INDEX_NONE && (Index == INDEX_NONE || RotatedIndex < Index);
+        return bOutRotated ? RotatedIndex : Index;
+    };
+
+    // 20x50的网格随机放入1x1到4x4的物品直到放不下
+    constexpr int32 GridWidth = 20;
+    constexpr int32 GridHeight = 50;
+    UGridSpaceManager* Grid = MakeGrid(GridWidth, GridHeight);
+    FReferenceGrid Reference(GridWidth, GridHeight);
+    FRandomStream Random(7);
+    TArray<TPair<int32, FIntPoint>> PlacedItems;
+    int32 NumMismatches = 0;
+    for (int32 Attempt = 0; Attempt < 2000; ++Attempt)
+    {
+        const FIntPoint Size(Random.RandRange(1, 4), Random.RandRange(1, 4));
+        bool bRotated = false;
+        bool bExpectedRotated = false;
+        const int32 Slot = Grid->FindFirstFit(Size, true, bRotated);
+        NumMismatches += Slot == ExpectedFirstFit(Reference, Size, bExpectedRotated) && bRotated == bExpectedRotated ? 0 : 1;
+        if (Slot == INDEX_NONE)
+        {
+            continue;
+        }
+
+        const FIntPoint Footprint = bRotated ? FIntPoint(Size.Y, Size.X) : Size;
+        Grid->UpdateFootprintState(Slot, Footprint, 1);
+        Reference.Fill(Slot, Footprint);
+        PlacedItems.Add(TPair<int32, FIntPoint>(Slot, Footprint));
+    }
+    TestEqual(TEXT("First fit with rotation matches the reference"), NumMismatches, 0);
+    AddInfo(FString::Printf(TEXT("Placed %d items on a %dx%d grid"), PlacedItems.Num(), GridWidth, GridHeight));
+
+    // 任意位置的放置检查, 包括越界的区域
+    NumMismatches = 0;
+    for (int32 Sample = 0; Sample < 4000; ++Sample)
+    {
+        const int32 X = Random.RandRange(-1, GridWidth);
+        const int32 Y = Random.RandRange(-1, GridHeight);
+        const FIntPoint Footprint(Random.RandRange(1, 5), Random.RandRange(1, 5));
+        NumMismatches += Grid->CanPlaceAt(X, Y, Footprint) == Reference.CanPlace(X, Y, Footprint) ? 0 : 1;
+    }
+    TestEqual(TEXT("CanPlaceAt matches the reference"), NumMismatches, 0);
+
+    // 物品自身占用的区域在容器内移动时视为空闲
+    TArray<int32> FootprintSlots;
+    NumMismatches = 0;
+    for (const TPair<int32, FIntPoint>& Item : PlacedItems)
+    {
+        NumMismatches += Grid->IsFootprintAvailable(Item.Key, Item.Value) ? 1 : 0;
+        NumMismatches += Grid->IsFootprintAvailable(Item.Key, Item.Value, Item.Key, Item.Value) ? 0 : 1;
+        NumMismatches += Grid->GetFootprintSlots(Item.Key, Item.Value, FootprintSlots) && FootprintSlots.Num() == Item.Value.X * Item.Value.Y ? 0 : 1;
+    }
+    TestEqual(TEXT("Placed footprints are occupied except for themselves"), NumMismatches, 0);
+    TestFalse(TEXT("Footprint past the right edge has no slots"), Grid->GetFootprintSlots(GridWidth - 1, FIntPoint(2, 1), FootprintSlots));
+
+    // 移除一半物品后重新比较查找结果
+    for (int32 Index = 0; Index < PlacedItems.Num(); Index += 2)
+    {
+        const TPair<int32, FIntPoint>& Item = PlacedItems[Index];
+        Grid->UpdateFootprintState(Item.Key, Item.Value, 0);
+        for (int32 Row = 0; Row < Item.Value.Y; ++Row)
+        {
+            for (int32 Column = 0; Column < Item.Value.X; ++Column)
+            {
+                Reference.Occupied[Item.Key + Row * GridWidth + Column] = false;
+            }
+        }
+    }
+    NumMismatches = 0;
+    for (int32 Width = 1; Width <= 5; ++Width)
+    {
+        for (int32 Height = 1; Height <= 5; ++Height)
+        {
+            bool bRotated = false;
+            bool bExpectedRotated = false;
+            const int32 Slot = Grid->FindFirstFit(FIntPoint(Width, Height), true, bRotated);
+            NumMismatches += Slot == ExpectedFirstFit(Reference, FIntPoint(Width, Height), bExpectedRotated) && bRotated == bExpectedRotated ? 0 : 1;
+        }
+    }
+    TestEqual(TEXT("First fit after removals matches the reference"), NumMismatches, 0);
+
+    constexpr int32 NumQueries = 10000;
+    bool bRotated = false;
+    const double StartTime = FPlatformTime::Seconds();
+    for (int32 Query = 0; Query < NumQueries; ++Query)
+    {
+        Grid->FindFirstFit(FIntPoint(3, 2), true, bRotated);
+    }
+    const double QueryTime = FPlatformTime::Seconds() - StartTime;
+    AddInfo(FString::Printf(TEXT("3x2 first fit with rotation on a dense %dx%d grid: %.3f us per query"), GridWidth, GridHeight, QueryTime * 1e6 / NumQueries));
+    return true;
+}
+
+#endif
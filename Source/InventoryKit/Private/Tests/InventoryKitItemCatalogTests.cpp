@@ -0,0 +1,213 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "Core/InventoryKitItemCatalog.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "NativeGameplayTags.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitItemCatalogTests
+{
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Catalog_Consumable, "InventoryKit.Test.Catalog.Consumable");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Catalog_Potion, "InventoryKit.Test.Catalog.Consumable.Potion");
+
+    FString GetCatalogPath(const TCHAR* Name)
+    {
+        return FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("InventoryKit"), FString(Name) + TEXT(".catalog"));
+    }
+
+    FInventoryKitCatalogEntry MakeEntry(int32 DefinitionID, const FString& Name, int32 MaxStackSize = 1, const FIntPoint& Size = FIntPoint(1, 1))
+    {
+        FInventoryKitCatalogEntry Entry;
+        Entry.DefinitionID = DefinitionID;
+        Entry.MaxStackSize = MaxStackSize;
+        Entry.Weight = 0.5f * DefinitionID;
+        Entry.Volume = 0.25f * DefinitionID;
+        Entry.Size = Size;
+        Entry.Name = Name;
+        return Entry;
+    }
+
+    // 目录中的记录与生成时的定义不一致的字段数
+    int32 CountMismatches(const FInventoryKitItemCatalog& Catalog, const FInventoryKitCatalogEntry& Entry)
+    {
+        const FInventoryKitCatalogRecord* Record = Catalog.Find(Entry.DefinitionID);
+        if (!Record)
+        {
+            return 1;
+        }
+
+        FGameplayTagContainer Tags;
+        Catalog.GetTags(*Record, Tags);
+        int32 NumMismatches = 0;
+        NumMismatches += Record->DefinitionID == Entry.DefinitionID ? 0 : 1;
+        NumMismatches += Record->MaxStackSize == Entry.MaxStackSize ? 0 : 1;
+        NumMismatches += Record->Weight == Entry.Weight && Record->Volume == Entry.Volume ? 0 : 1;
+        NumMismatches += Record->GetSize() == Entry.Size ? 0 : 1;
+        NumMismatches += Catalog.GetName(*Record) == Entry.Name ? 0 : 1;
+        NumMismatches += Tags == Entry.Tags ? 0 : 1;
+        return NumMismatches;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitItemCatalogRoundTripTest, "InventoryKit.ItemCatalog.RoundTrip",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitItemCatalogRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitItemCatalogTests;
+
+    // 稀疏的定义ID走二分查找, 名称含非ASCII字符, 标签字符串在池中共享
+    TArray<FInventoryKitCatalogEntry> Entries;
+    Entries.Add(MakeEntry(40, TEXT("Longsword"), 1, FIntPoint(1, 3)));
+    Entries.Add(MakeEntry(7, TEXT("治疗药水"), 20));
+    Entries.Last().Tags.AddTag(TAG_Test_Catalog_Potion.GetTag());
+    Entries.Add(MakeEntry(12, TEXT("Bread"), 10));
+    Entries.Last().Tags.AddTag(TAG_Test_Catalog_Consumable.GetTag());
+    Entries.Add(MakeEntry(1000, FString(), 1, FIntPoint(2, 2)));
+    Entries.Last().Tags.AddTag(TAG_Test_Catalog_Consumable.GetTag());
+    Entries.Last().Tags.AddTag(TAG_Test_Catalog_Potion.GetTag());
+
+    const FString SparsePath = GetCatalogPath(TEXT("Sparse"));
+    if (!TestTrue(TEXT("Sparse catalog is written"), FInventoryKitItemCatalog::Write(SparsePath, Entries)))
+    {
+        return false;
+    }
+    {
+        TUniquePtr<FInventoryKitItemCatalog> Catalog = FInventoryKitItemCatalog::Open(SparsePath);
+        if (!TestNotNull(TEXT("Sparse catalog opens"), Catalog.Get()))
+        {
+            return false;
+        }
+        TestEqual(TEXT("Sparse catalog has every entry"), Catalog->Num(), Entries.Num());
+        int32 NumMismatches = 0;
+        for (const FInventoryKitCatalogEntry& Entry : Entries)
+        {
+            NumMismatches += CountMismatches(*Catalog, Entry);
+        }
+        TestEqual(TEXT("Sparse records match their entries"), NumMismatches, 0);
+
+        bool bSorted = true;
+        const TConstArrayView<FInventoryKitCatalogRecord> Records = Catalog->GetRecords();
+        for (int32 Index = 1; Index < Records.Num(); ++Index)
+        {
+            bSorted &= Records[Index - 1].DefinitionID < Records[Index].DefinitionID;
+        }
+        TestTrue(TEXT("Records are sorted by definition id"), bSorted);
+        TestNull(TEXT("Missing id between records is not found"), Catalog->Find(8));
+        TestNull(TEXT("Id past the last record is not found"), Catalog->Find(1001));
+    }
+
+    // 连续的定义ID按下标访问
+    TArray<FInventoryKitCatalogEntry> DenseEntries;
+    for (int32 DefinitionID = 100; DefinitionID < 164; ++DefinitionID)
+    {
+        DenseEntries.Add(MakeEntry(DefinitionID, FString::Printf(TEXT("Item_%d"), DefinitionID), DefinitionID % 5 + 1));
+    }
+    const FString DensePath = GetCatalogPath(TEXT("Dense"));
+    TestTrue(TEXT("Dense catalog is written"), FInventoryKitItemCatalog::Write(DensePath, DenseEntries));
+    {
+        TUniquePtr<FInventoryKitItemCatalog> Catalog = FInventoryKitItemCatalog::Open(DensePath);
+        if (!TestNotNull(TEXT("Dense catalog opens"), Catalog.Get()))
+        {
+            return false;
+        }
+        int32 NumMismatches = 0;
+        for (const FInventoryKitCatalogEntry& Entry : DenseEntries)
+        {
+            NumMismatches += CountMismatches(*Catalog, Entry);
+        }
+        TestEqual(TEXT("Dense records match their entries"), NumMismatches, 0);
+        TestNull(TEXT("Id before the first record is not found"), Catalog->Find(99));
+        TestNull(TEXT("Id after the last record is not found"), Catalog->Find(164));
+    }
+
+    // 物品系统从目录读取堆叠上限和负重
+    {
+        FInventoryKitTestWorld TestWorld;
+        UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+        if (TestNotNull(TEXT("Item system"), ItemSystem) && TestTrue(TEXT("Catalog is loaded"), ItemSystem->LoadItemCatalog(SparsePath)))
+        {
+            TestEqual(TEXT("Stack size comes from the catalog"), ItemSystem->GetMaxStackSize(7), 20);
+            TestEqual(TEXT("Unknown definition is not stackable"), ItemSystem->GetMaxStackSize(8), 1);
+
+            FItemBaseInstance Item;
+            Item.DefinitionID = 12;
+            Item.Quantity = 4;
+            const FInventoryKitLoad Load = ItemSystem->GetItemLoad(Item);
+            TestEqual(TEXT("Weight scales with quantity"), Load.Weight, 24.0);
+            TestEqual(TEXT("Volume scales with quantity"), Load.Volume, 12.0);
+        }
+    }
+
+    // 被截断或损坏的文件头拒绝打开
+    TArray<uint8> FileData;
+    FFileHelper::LoadFileToArray(FileData, *SparsePath);
+    const FString CorruptPath = GetCatalogPath(TEXT("Corrupt"));
+    TArray<uint8> Truncated(FileData.GetData(), FileData.Num() / 2);
+    FFileHelper::SaveArrayToFile(Truncated, *CorruptPath);
+    TestNull(TEXT("Truncated catalog is rejected"), FInventoryKitItemCatalog::Open(CorruptPath).Get());
+    FileData[0] ^= 0xFF;
+    FFileHelper::SaveArrayToFile(FileData, *CorruptPath);
+    TestNull(TEXT("Catalog with a bad magic is rejected"), FInventoryKitItemCatalog::Open(CorruptPath).Get());
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.DeleteFile(*SparsePath);
+    PlatformFile.DeleteFile(*DensePath);
+    PlatformFile.DeleteFile(*CorruptPath);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitItemCatalogOpenBenchmarkTest, "InventoryKit.ItemCatalog.OpenBenchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitItemCatalogOpenBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitItemCatalogTests;
+
+    // 打开只校验文件头, 耗时不应随目录大小增长
+    for (const int32 NumEntries : { 1000, 100000 })
+    {
+        TArray<FInventoryKitCatalogEntry> Entries;
+        Entries.Reserve(NumEntries);
+        for (int32 DefinitionID = 0; DefinitionID < NumEntries; ++DefinitionID)
+        {
+            Entries.Add(MakeEntry(DefinitionID, FString::Printf(TEXT("Item_%d"), DefinitionID)));
+        }
+        const FString Path = GetCatalogPath(TEXT("Benchmark"));
+        if (!TestTrue(TEXT("Catalog is written"), FInventoryKitItemCatalog::Write(Path, Entries)))
+        {
+            return false;
+        }
+
+        double StartTime = FPlatformTime::Seconds();
+        TUniquePtr<FInventoryKitItemCatalog> Catalog = FInventoryKitItemCatalog::Open(Path);
+        const double OpenTime = FPlatformTime::Seconds() - StartTime;
+        if (!TestNotNull(TEXT("Catalog opens"), Catalog.Get()))
+        {
+            return false;
+        }
+
+        StartTime = FPlatformTime::Seconds();
+        int32 NumFound = 0;
+        for (int32 DefinitionID = 0; DefinitionID < NumEntries; ++DefinitionID)
+        {
+            NumFound += Catalog->Find(DefinitionID) ? 1 : 0;
+        }
+        const double FindTime = FPlatformTime::Seconds() - StartTime;
+        TestEqual(TEXT("Every definition is found"), NumFound, NumEntries);
+
+        AddInfo(FString::Printf(TEXT("%d definitions: open %.3f ms, %.3f ns per Find"),
+                                NumEntries, OpenTime * 1000.0, FindTime * 1e9 / NumEntries));
+        Catalog.Reset();
+        FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Path);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,200 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "Core/InventoryKitJournal.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitJournalTests
+{
+    // 每个测试使用独立的临时目录, 开始和结束时清空
+    struct FScopedJournalDir
+    {
+        FString Dir;
+
+        explicit FScopedJournalDir(const TCHAR* Name)
+            : Dir(FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("InventoryKit"), Name))
+        {
+            IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+            PlatformFile.DeleteDirectoryRecursively(*Dir);
+            PlatformFile.CreateDirectoryTree(*Dir);
+        }
+
+        ~FScopedJournalDir()
+        {
+            FPlatformFileManager::Get().GetPlatformFile().DeleteDirectoryRecursively(*Dir);
+        }
+
+        FString GetJournalPath() const
+        {
+            return FPaths::Combine(Dir, TEXT("Inventory.journal"));
+        }
+
+        FString GetCheckpointPath() const
+        {
+            return FPaths::Combine(Dir, TEXT("Inventory.checkpoint"));
+        }
+    };
+
+    // 每次提交形成日志中的一帧
+    void WriteFrame(FInventoryKitJournalWriter& Writer, int32 FirstItemId, int32 NumItems)
+    {
+        for (int32 ItemId = FirstItemId; ItemId < FirstItemId + NumItems; ++ItemId)
+        {
+            Writer.Append(FInventoryKitJournalRecord::MakeDestroy(ItemId));
+        }
+        Writer.SubmitPending();
+    }
+
+    TArray<int32> GetRecordItemIds(const TArray<FInventoryKitJournalRecord>& Records)
+    {
+        TArray<int32> ItemIds;
+        for (const FInventoryKitJournalRecord& Record : Records)
+        {
+            ItemIds.Add(Record.ItemID);
+        }
+        return ItemIds;
+    }
+
+    // 去掉文件末尾的若干字节, 模拟写到一半时崩溃
+    bool TruncateFile(const FString& Path, int32 NumBytes)
+    {
+        TArray<uint8> FileData;
+        if (!FFileHelper::LoadFileToArray(FileData, *Path) || FileData.Num() < NumBytes)
+        {
+            return false;
+        }
+        FileData.SetNum(FileData.Num() - NumBytes);
+        return FFileHelper::SaveArrayToFile(FileData, *Path);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitJournalTornFrameTest, "InventoryKit.Journal.TornFrame",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitJournalTornFrameTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitJournalTests;
+
+    FScopedJournalDir JournalDir(TEXT("TornFrame"));
+    const FString JournalPath = JournalDir.GetJournalPath();
+    {
+        FInventoryKitJournalWriter Writer(JournalPath, JournalDir.GetCheckpointPath());
+        if (!TestTrue(TEXT("Writer starts"), Writer.Start()))
+        {
+            return false;
+        }
+        WriteFrame(Writer, 0, 3);
+        WriteFrame(Writer, 3, 2);
+        WriteFrame(Writer, 5, 4);
+        Writer.Shutdown();
+    }
+
+    TArray<FInventoryKitJournalRecord> Records;
+    uint64 Sequence = 0;
+    TestTrue(TEXT("Complete journal is read"), FInventoryKitJournalWriter::ReadRecords(JournalPath, Records, Sequence));
+    TestEqual(TEXT("Every record is read"), Records.Num(), 9);
+
+    // 最后一帧缺了几个字节: 之前的帧完整保留, 残缺的帧整体丢弃
+    if (!TestTrue(TEXT("Journal is truncated"), TruncateFile(JournalPath, 3)))
+    {
+        return false;
+    }
+    TestTrue(TEXT("Torn journal is read"), FInventoryKitJournalWriter::ReadRecords(JournalPath, Records, Sequence));
+    TestEqual(TEXT("Torn frame is dropped"), GetRecordItemIds(Records), TArray<int32>({ 0, 1, 2, 3, 4 }));
+
+    // 第二帧的数据损坏: CRC不符, 从这一帧起全部丢弃
+    constexpr int32 HeaderSize = sizeof(uint32) + sizeof(int32) + sizeof(uint64);
+    constexpr int32 FrameHeaderSize = sizeof(int32) + sizeof(uint32);
+    TArray<uint8> FileData;
+    FFileHelper::LoadFileToArray(FileData, *JournalPath);
+    int32 FirstFrameSize = 0;
+    FMemory::Memcpy(&FirstFrameSize, FileData.GetData() + HeaderSize, sizeof(FirstFrameSize));
+    FileData[HeaderSize + FrameHeaderSize + FirstFrameSize + FrameHeaderSize] ^= 0xFF;
+    FFileHelper::SaveArrayToFile(FileData, *JournalPath);
+    TestTrue(TEXT("Corrupted journal is read"), FInventoryKitJournalWriter::ReadRecords(JournalPath, Records, Sequence));
+    TestEqual(TEXT("Frames from the corrupted one are dropped"), GetRecordItemIds(Records), TArray<int32>({ 0, 1, 2 }));
+
+    // 物品系统恢复: 日志的唯一一帧残缺时退回检查点的状态, 完整时回放出相同的物品
+    FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*JournalPath);
+    TArray<int32> CreatedItemIds;
+    {
+        FInventoryKitTestWorld SourceWorld;
+        const int32 ContainerID = SourceWorld.SpawnGridContainer(5, 5, TEXT("Test.Chest"))->GetContainerID();
+        if (!TestTrue(TEXT("Journal opens"), SourceWorld.GetItemSystem()->OpenJournal(JournalPath, JournalDir.GetCheckpointPath(), 0)))
+        {
+            return false;
+        }
+        for (int32 Slot = 0; Slot < 4; ++Slot)
+        {
+            CreatedItemIds.Add(SourceWorld.CreateItem(FItemLocation(ContainerID, Slot)));
+        }
+        SourceWorld.GetItemSystem()->CloseJournal();
+        CreatedItemIds.Sort();
+    }
+
+    {
+        FInventoryKitTestWorld RecoveredWorld;
+        const int32 ContainerID = RecoveredWorld.SpawnGridContainer(5, 5, TEXT("Test.Chest"))->GetContainerID();
+        TestTrue(TEXT("Complete journal is recovered"), RecoveredWorld.GetItemSystem()->RecoverFromJournal(JournalPath, JournalDir.GetCheckpointPath()));
+        TArray<int32> RecoveredItemIds(RecoveredWorld.GetItemSystem()->GetItemsInContainerView(ContainerID));
+        RecoveredItemIds.Sort();
+        TestEqual(TEXT("Journal replays every item"), RecoveredItemIds, CreatedItemIds);
+    }
+
+    TruncateFile(JournalPath, 1);
+    {
+        FInventoryKitTestWorld RecoveredWorld;
+        const int32 ContainerID = RecoveredWorld.SpawnGridContainer(5, 5, TEXT("Test.Chest"))->GetContainerID();
+        TestTrue(TEXT("Torn journal is recovered"), RecoveredWorld.GetItemSystem()->RecoverFromJournal(JournalPath, JournalDir.GetCheckpointPath()));
+        TestEqual(TEXT("Torn frame is not replayed"), RecoveredWorld.GetItemSystem()->GetItemsInContainerView(ContainerID).Num(), 0);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitJournalCheckpointFailureTest, "InventoryKit.Journal.CheckpointFailure",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitJournalCheckpointFailureTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitJournalTests;
+
+    // 检查点的临时文件路径被目录占用, 写入检查点必然失败
+    FScopedJournalDir JournalDir(TEXT("CheckpointFailure"));
+    const FString JournalPath = JournalDir.GetJournalPath();
+    FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*(JournalDir.GetCheckpointPath() + TEXT(".tmp")));
+
+    {
+        FInventoryKitJournalWriter Writer(JournalPath, JournalDir.GetCheckpointPath());
+        if (!TestTrue(TEXT("Writer starts"), Writer.Start()))
+        {
+            return false;
+        }
+        WriteFrame(Writer, 0, 2);
+
+        // 本帧的记录没有单独提交, 直接随检查点提交
+        Writer.Append(FInventoryKitJournalRecord::MakeDestroy(2));
+        Writer.Append(FInventoryKitJournalRecord::MakeDestroy(3));
+        Writer.SubmitCheckpoint(TArray<uint8>({ 1, 2, 3 }));
+        Writer.Shutdown();
+    }
+
+    // 检查点没有写成, 日志不能丢掉任何记录
+    TArray<FInventoryKitJournalRecord> Records;
+    uint64 Sequence = 0;
+    TestTrue(TEXT("Journal is read"), FInventoryKitJournalWriter::ReadRecords(JournalPath, Records, Sequence));
+    TestEqual(TEXT("Records pending at the failed checkpoint are kept"), GetRecordItemIds(Records), TArray<int32>({ 0, 1, 2, 3 }));
+    TestEqual(TEXT("Journal still refers to the previous checkpoint"), Sequence, static_cast<uint64>(0));
+
+    TArray<uint8> SnapshotData;
+    uint64 CheckpointSequence = 0;
+    FInventoryKitJournalWriter::ReadCheckpoint(JournalDir.GetCheckpointPath(), SnapshotData, CheckpointSequence);
+    TestEqual(TEXT("No checkpoint is written"), SnapshotData.Num(), 0);
+    return true;
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitMoveItemsTest, "InventoryKit.ItemSystem.MoveItems",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitMoveItemsTest::RunTest(const FString& Parameters)
+{
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    constexpr int32 GridWidth = 25;
+    constexpr int32 GridHeight = 20;
+    constexpr int32 NumItems = GridWidth * GridHeight;
+    const int32 SourceID = TestWorld.SpawnGridContainer(GridWidth, GridHeight)->GetContainerID();
+    const int32 TargetID = TestWorld.SpawnGridContainer(GridWidth, GridHeight)->GetContainerID();
+
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < NumItems; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(SourceID, Slot)));
+    }
+    if (!TestFalse(TEXT("All items are created"), ItemIds.Contains(INDEX_NONE)))
+    {
+        return false;
+    }
+
+    // 逆序放入目标容器
+    TArray<FItemMoveRequest> Requests;
+    for (int32 Index = 0; Index < NumItems; ++Index)
+    {
+        Requests.Add(FItemMoveRequest(ItemIds[Index], FItemLocation(TargetID, NumItems - 1 - Index)));
+    }
+
+    // 批次内两个物品争用同一槽位时整体失败, 不移动任何物品
+    TArray<FItemMoveRequest> ConflictingRequests = Requests;
+    ConflictingRequests.Last().TargetLocation = ConflictingRequests[0].TargetLocation;
+    TestFalse(TEXT("Conflicting batch is rejected"), ItemSystem->MoveItems(ConflictingRequests));
+    TestEqual(TEXT("Rejected batch leaves the source intact"), ItemSystem->GetItemsInContainerView(SourceID).Num(), NumItems);
+    TestEqual(TEXT("Rejected batch leaves the target empty"), ItemSystem->GetItemsInContainerView(TargetID).Num(), 0);
+
+    double StartTime = FPlatformTime::Seconds();
+    const bool bBatchMoved = ItemSystem->MoveItems(Requests);
+    const double BatchTime = FPlatformTime::Seconds() - StartTime;
+    TestTrue(TEXT("Batch move succeeds"), bBatchMoved);
+    TestEqual(TEXT("Target holds every item"), ItemSystem->GetItemsInContainerView(TargetID).Num(), NumItems);
+    TestEqual(TEXT("Source is empty"), ItemSystem->GetItemsInContainerView(SourceID).Num(), 0);
+
+    int32 NumMisplaced = 0;
+    for (const FItemMoveRequest& Request : Requests)
+    {
+        FItemLocation Location;
+        NumMisplaced += ItemSystem->GetItemLocation(Request.ItemID, Location)
+            && Location.ContainerID == Request.TargetLocation.ContainerID && Location.SlotIndex == Request.TargetLocation.SlotIndex ? 0 : 1;
+    }
+    TestEqual(TEXT("Every item lands on its requested slot"), NumMisplaced, 0);
+
+    // 同样的迁移逐个调用MoveItem, 作为对比
+    StartTime = FPlatformTime::Seconds();
+    bool bLoopMoved = true;
+    for (int32 Index = 0; Index < NumItems; ++Index)
+    {
+        bLoopMoved &= ItemSystem->MoveItem(ItemIds[Index], FItemLocation(SourceID, Index));
+    }
+    const double LoopTime = FPlatformTime::Seconds() - StartTime;
+    TestTrue(TEXT("Per-item moves succeed"), bLoopMoved);
+    TestEqual(TEXT("Source holds every item again"), ItemSystem->GetItemsInContainerView(SourceID).Num(), NumItems);
+
+    // 容器内互换位置只能整批应用, 逐个移动时中间状态会重叠
+    TArray<FItemMoveRequest> SwapRequests;
+    SwapRequests.Add(FItemMoveRequest(ItemIds[0], FItemLocation(SourceID, 1)));
+    SwapRequests.Add(FItemMoveRequest(ItemIds[1], FItemLocation(SourceID, 0)));
+    TestFalse(TEXT("Single move onto an occupied slot fails"), ItemSystem->MoveItem(ItemIds[0], FItemLocation(SourceID, 1)));
+    TestTrue(TEXT("Batch swap succeeds"), ItemSystem->MoveItems(SwapRequests));
+    FItemLocation SwappedLocation;
+    TestTrue(TEXT("Swapped item is found"), ItemSystem->GetItemLocation(ItemIds[0], SwappedLocation));
+    TestEqual(TEXT("Swapped item takes the other slot"), SwappedLocation.SlotIndex, 1);
+
+    AddInfo(FString::Printf(TEXT("%d items: MoveItems %.3f ms, MoveItem loop %.3f ms"), NumItems, BatchTime * 1000.0, LoopTime * 1000.0));
+    return true;
+}
+
+#endif
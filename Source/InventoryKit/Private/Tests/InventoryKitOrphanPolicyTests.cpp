@@ -0,0 +1,181 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "ContainerSpace/ContainerSpaceManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitOrphanPolicyTests
+{
+    // 填满一个网格容器, 返回物品ID
+    TArray<int32> FillContainer(FInventoryKitTestWorld& TestWorld, int32 ContainerID, int32 NumSlots)
+    {
+        TArray<int32> ItemIds;
+        for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+        {
+            ItemIds.Add(TestWorld.CreateItem(FItemLocation(ContainerID, Slot)));
+        }
+        return ItemIds;
+    }
+
+    // 位于指定容器中的物品数, 已销毁的物品不计
+    int32 CountItemsIn(const UInventoryKitItemSystem& ItemSystem, TConstArrayView<int32> ItemIds, int32 ContainerID)
+    {
+        int32 NumInContainer = 0;
+        for (const int32 ItemId : ItemIds)
+        {
+            FItemLocation Location;
+            NumInContainer += ItemSystem.GetItemLocation(ItemId, Location) && Location.ContainerID == ContainerID ? 1 : 0;
+        }
+        return NumInContainer;
+    }
+
+    // 仍然存在的物品数
+    int32 CountLiveItems(const UInventoryKitItemSystem& ItemSystem, TConstArrayView<int32> ItemIds)
+    {
+        int32 NumLive = 0;
+        for (const int32 ItemId : ItemIds)
+        {
+            FItemLocation Location;
+            NumLive += ItemSystem.GetItemLocation(ItemId, Location) ? 1 : 0;
+        }
+        return NumLive;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitOrphanPolicyTest, "InventoryKit.OrphanPolicy.Policies",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitOrphanPolicyTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitOrphanPolicyTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+    const int32 VoidID = ItemSystem->GetVoidContainerID();
+
+    // 移入虚空: 物品保留, 全部指向虚空容器
+    UInventoryKitBaseContainerComponent* Chest = TestWorld.SpawnGridContainer(3, 3);
+    const int32 ChestID = Chest->GetContainerID();
+    const TArray<int32> ChestItems = FillContainer(TestWorld, ChestID, 9);
+    ItemSystem->UnregisterContainer(Chest, EInventoryKitOrphanPolicy::MoveToVoid);
+    TestNull(TEXT("Chest is unregistered"), ItemSystem->FindContainer(ChestID));
+    TestEqual(TEXT("Chest items move to the void"), CountItemsIn(*ItemSystem, ChestItems, VoidID), ChestItems.Num());
+    TestEqual(TEXT("Chest leaves no items behind"), ItemSystem->GetItemsInContainerView(ChestID).Num(), 0);
+
+    // 销毁: 物品及其ID全部释放
+    UInventoryKitBaseContainerComponent* Crate = TestWorld.SpawnGridContainer(3, 3);
+    const int32 CrateID = Crate->GetContainerID();
+    const TArray<int32> CrateItems = FillContainer(TestWorld, CrateID, 9);
+    const int32 NumLiveBefore = ItemSystem->GetItemIdStats().NumLive;
+    ItemSystem->UnregisterContainer(Crate, EInventoryKitOrphanPolicy::Destroy);
+    TestEqual(TEXT("Crate items are destroyed"), CountLiveItems(*ItemSystem, CrateItems), 0);
+    TestEqual(TEXT("Destroyed items are released"), ItemSystem->GetItemIdStats().NumLive, NumLiveBefore - CrateItems.Num());
+
+    // 转交: 接收容器只有3个空位, 放得下的物品转交, 其余移入虚空, 接收容器的占用随之更新
+    UInventoryKitBaseContainerComponent* Corpse = TestWorld.SpawnGridContainer(3, 3);
+    const int32 CorpseID = Corpse->GetContainerID();
+    const TArray<int32> CorpseItems = FillContainer(TestWorld, CorpseID, 9);
+    const int32 LootID = TestWorld.SpawnGridContainer(3, 1)->GetContainerID();
+    const int32 NumInVoidBefore = ItemSystem->GetItemsInContainerView(VoidID).Num();
+    ItemSystem->UnregisterContainer(Corpse, EInventoryKitOrphanPolicy::HandOff, LootID);
+    TestEqual(TEXT("Hand-off container takes what fits"), CountItemsIn(*ItemSystem, CorpseItems, LootID), 3);
+    TestEqual(TEXT("Overflow moves to the void"), CountItemsIn(*ItemSystem, CorpseItems, VoidID), 6);
+    TestEqual(TEXT("Void gains only the overflow"), ItemSystem->GetItemsInContainerView(VoidID).Num(), NumInVoidBefore + 6);
+    int32 NumFreeLootSlots = 0;
+    for (int32 Slot = 0; Slot < 3; ++Slot)
+    {
+        NumFreeLootSlots += ItemSystem->FindContainer(LootID)->GetSpaceManager()->IsSlotAvailable(Slot) ? 1 : 0;
+    }
+    TestEqual(TEXT("Hand-off fills the receiving container"), NumFreeLootSlots, 0);
+
+    // 转交的目标不存在时按移入虚空处理
+    UInventoryKitBaseContainerComponent* Pouch = TestWorld.SpawnGridContainer(2, 1);
+    const TArray<int32> PouchItems = FillContainer(TestWorld, Pouch->GetContainerID(), 2);
+    ItemSystem->UnregisterContainer(Pouch, EInventoryKitOrphanPolicy::HandOff, ChestID);
+    TestEqual(TEXT("Missing hand-off target falls back to the void"), CountItemsIn(*ItemSystem, PouchItems, VoidID), PouchItems.Num());
+
+    // 组件销毁时按其配置的策略处理, 默认移入虚空
+    UInventoryKitBaseContainerComponent* Barrel = TestWorld.SpawnGridContainer(2, 2);
+    const TArray<int32> BarrelItems = FillContainer(TestWorld, Barrel->GetContainerID(), 4);
+    TestWorld.DestroyContainer(Barrel);
+    TestEqual(TEXT("Destroyed component moves its items to the void"), CountItemsIn(*ItemSystem, BarrelItems, VoidID), BarrelItems.Num());
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitOrphanPolicyBenchmarkTest, "InventoryKit.OrphanPolicy.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitOrphanPolicyBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitOrphanPolicyTests;
+
+    // 注销一个放满256个物品的容器, 分别在空世界和另有16k个物品的世界中计时
+    // 耗时只与被注销容器的物品数相关, 两种世界中应当接近
+    constexpr int32 OrphanGridSize = 16;
+    constexpr int32 NumOrphans = OrphanGridSize * OrphanGridSize;
+    constexpr int32 BackgroundGridSize = 32;
+    constexpr int32 NumRounds = 10;
+    const EInventoryKitOrphanPolicy Policies[] = { EInventoryKitOrphanPolicy::MoveToVoid, EInventoryKitOrphanPolicy::Destroy, EInventoryKitOrphanPolicy::HandOff };
+    const TCHAR* PolicyNames[] = { TEXT("MoveToVoid"), TEXT("Destroy"), TEXT("HandOff") };
+
+    for (const int32 NumBackgroundContainers : { 0, 16 })
+    {
+        FInventoryKitTestWorld TestWorld;
+        UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+        if (!TestNotNull(TEXT("Item system"), ItemSystem))
+        {
+            return false;
+        }
+        for (int32 Index = 0; Index < NumBackgroundContainers; ++Index)
+        {
+            const int32 BackgroundID = TestWorld.SpawnGridContainer(BackgroundGridSize, BackgroundGridSize)->GetContainerID();
+            FillContainer(TestWorld, BackgroundID, BackgroundGridSize * BackgroundGridSize);
+        }
+
+        for (int32 PolicyIndex = 0; PolicyIndex < UE_ARRAY_COUNT(Policies); ++PolicyIndex)
+        {
+            int32 NumMisplaced = 0;
+            double UnregisterTime = 0.0;
+            for (int32 Round = 0; Round < NumRounds; ++Round)
+            {
+                UInventoryKitBaseContainerComponent* Container = TestWorld.SpawnGridContainer(OrphanGridSize, OrphanGridSize);
+                const TArray<int32> ItemIds = FillContainer(TestWorld, Container->GetContainerID(), NumOrphans);
+                const int32 HandOffID = Policies[PolicyIndex] == EInventoryKitOrphanPolicy::HandOff
+                    ? TestWorld.SpawnGridContainer(OrphanGridSize, OrphanGridSize)->GetContainerID()
+                    : INDEX_NONE;
+
+                const double StartTime = FPlatformTime::Seconds();
+                ItemSystem->UnregisterContainer(Container, Policies[PolicyIndex], HandOffID);
+                UnregisterTime += FPlatformTime::Seconds() - StartTime;
+
+                switch (Policies[PolicyIndex])
+                {
+                case EInventoryKitOrphanPolicy::MoveToVoid:
+                    NumMisplaced += NumOrphans - CountItemsIn(*ItemSystem, ItemIds, ItemSystem->GetVoidContainerID());
+                    break;
+                case EInventoryKitOrphanPolicy::Destroy:
+                    NumMisplaced += CountLiveItems(*ItemSystem, ItemIds);
+                    break;
+                case EInventoryKitOrphanPolicy::HandOff:
+                    NumMisplaced += NumOrphans - CountItemsIn(*ItemSystem, ItemIds, HandOffID);
+                    break;
+                }
+            }
+            TestEqual(FString::Printf(TEXT("%s handles every item"), PolicyNames[PolicyIndex]), NumMisplaced, 0);
+
+            AddInfo(FString::Printf(TEXT("%s, %d other items: %.3f us per %d-item container"),
+                                    PolicyNames[PolicyIndex], NumBackgroundContainers * BackgroundGridSize * BackgroundGridSize,
+                                    UnregisterTime * 1e6 / NumRounds, NumOrphans));
+        }
+    }
+    return true;
+}
+
+#endif
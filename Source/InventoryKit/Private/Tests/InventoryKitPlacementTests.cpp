@@ -0,0 +1,242 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "ContainerSpace/ContainerSpaceManager.h"
+#include "Core/InventoryKitItemCatalog.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "NativeGameplayTags.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitPlacementTests
+{
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Placement_Weapon, "InventoryKit.Test.Placement.Weapon");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Placement_Weapon_Sword, "InventoryKit.Test.Placement.Weapon.Sword");
+
+    constexpr int32 PlainDefinitionID = 1;
+    constexpr int32 SwordDefinitionID = 2;
+
+    // 网格中重叠或越界的格子数, 物品按当前位置和占用尺寸展开
+    int32 CountOverlaps(const UInventoryKitItemSystem& ItemSystem, int32 ContainerID, int32 Width, int32 Height)
+    {
+        TArray<bool> Occupied;
+        Occupied.Init(false, Width * Height);
+        int32 NumOverlaps = 0;
+        for (const int32 ItemId : ItemSystem.GetItemsInContainerView(ContainerID))
+        {
+            const FItemBaseInstance Item = ItemSystem.GetItemBaseInstance(ItemId);
+            const FIntPoint Footprint = Item.GetFootprint();
+            const int32 X = Item.ItemLocation.SlotIndex % Width;
+            const int32 Y = Item.ItemLocation.SlotIndex / Width;
+            for (int32 CellY = Y; CellY < Y + Footprint.Y; ++CellY)
+            {
+                for (int32 CellX = X; CellX < X + Footprint.X; ++CellX)
+                {
+                    if (CellX >= Width || CellY >= Height)
+                    {
+                        ++NumOverlaps;
+                        continue;
+                    }
+                    NumOverlaps += Occupied[CellY * Width + CellX] ? 1 : 0;
+                    Occupied[CellY * Width + CellX] = true;
+                }
+            }
+        }
+        return NumOverlaps;
+    }
+
+    // 不在指定容器中的物品数
+    int32 CountNotInContainer(const UInventoryKitItemSystem& ItemSystem, TConstArrayView<int32> ItemIds, int32 ContainerID)
+    {
+        int32 NumNotInContainer = 0;
+        for (const int32 ItemId : ItemIds)
+        {
+            FItemLocation Location;
+            NumNotInContainer += ItemSystem.GetItemLocation(ItemId, Location) && Location.ContainerID == ContainerID ? 0 : 1;
+        }
+        return NumNotInContainer;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitPlacementAutoLootTest, "InventoryKit.Placement.AutoLoot",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitPlacementAutoLootTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitPlacementTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 10x10的背包第一行已满, 剩余90格; 先拾取5个2x2的物品, 再拾取80个1x1的物品, 最后10个放不下
+    constexpr int32 GridSize = 10;
+    const int32 BackpackID = TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID();
+    const int32 GroundID = TestWorld.SpawnGridContainer(20, 20)->GetContainerID();
+    for (int32 Slot = 0; Slot < GridSize; ++Slot)
+    {
+        TestWorld.CreateItem(FItemLocation(BackpackID, Slot));
+    }
+
+    TArray<int32> LootIds;
+    for (int32 Index = 0; Index < 5; ++Index)
+    {
+        LootIds.Add(TestWorld.CreateItem(FItemLocation(GroundID, Index * 2), FIntPoint(2, 2)));
+    }
+    for (int32 Index = 0; Index < 80; ++Index)
+    {
+        LootIds.Add(TestWorld.CreateItem(FItemLocation(GroundID, 40 + Index)));
+    }
+    if (!TestFalse(TEXT("Loot is created"), LootIds.Contains(INDEX_NONE)))
+    {
+        return false;
+    }
+
+    const TArray<int32> MovedIds = ItemSystem->MoveItemsToContainer(LootIds, BackpackID);
+    TestEqual(TEXT("Every item that fits is moved"), MovedIds.Num(), 75);
+    TestEqual(TEXT("Backpack holds every moved item"), ItemSystem->GetItemsInContainerView(BackpackID).Num(), GridSize + 75);
+    TestEqual(TEXT("Placed items never overlap"), CountOverlaps(*ItemSystem, BackpackID, GridSize, GridSize), 0);
+    TestEqual(TEXT("Moved items are in the backpack"), CountNotInContainer(*ItemSystem, MovedIds, BackpackID), 0);
+    TestEqual(TEXT("Items that do not fit stay on the ground"), ItemSystem->GetItemsInContainerView(GroundID).Num(), 10);
+    TestEqual(TEXT("Unmoved items are the last ones"), CountNotInContainer(*ItemSystem, TConstArrayView<int32>(LootIds).Right(10), GroundID), 0);
+
+    // 物品已在目标容器中时不移动
+    FItemLocation BeforeLocation;
+    ItemSystem->GetItemLocation(MovedIds[0], BeforeLocation);
+    TestTrue(TEXT("Item already in the container is accepted"), ItemSystem->MoveItemToContainer(MovedIds[0], BackpackID));
+    FItemLocation AfterLocation;
+    ItemSystem->GetItemLocation(MovedIds[0], AfterLocation);
+    TestTrue(TEXT("Item already in the container keeps its slot"), BeforeLocation == AfterLocation);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitPlacementSpaceTypesTest, "InventoryKit.Placement.SpaceTypes",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitPlacementSpaceTypesTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitPlacementTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 物品标签来自目录: 剑带有武器的子标签, 普通物品没有标签
+    TArray<FInventoryKitCatalogEntry> Entries;
+    Entries.AddDefaulted(2);
+    Entries[0].DefinitionID = PlainDefinitionID;
+    Entries[1].DefinitionID = SwordDefinitionID;
+    Entries[1].Tags.AddTag(TAG_Test_Placement_Weapon_Sword.GetTag());
+    const FString CatalogPath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("InventoryKit"), TEXT("Placement.catalog"));
+    if (!TestTrue(TEXT("Catalog is written"), FInventoryKitItemCatalog::Write(CatalogPath, Entries))
+        || !TestTrue(TEXT("Catalog is loaded"), ItemSystem->LoadItemCatalog(CatalogPath)))
+    {
+        return false;
+    }
+
+    const int32 GroundID = TestWorld.SpawnGridContainer(10, 10)->GetContainerID();
+    TArray<int32> Swords;
+    TArray<int32> PlainItems;
+    for (int32 Index = 0; Index < 3; ++Index)
+    {
+        Swords.Add(TestWorld.CreateItem(FItemLocation(GroundID, Index), FIntPoint(1, 1), SwordDefinitionID));
+        PlainItems.Add(TestWorld.CreateItem(FItemLocation(GroundID, 10 + Index), FIntPoint(1, 1), PlainDefinitionID));
+    }
+
+    // 固定槽位: 两个武器槽和两个通用槽; 剑先占武器槽, 武器槽满后退到通用槽
+    FContainerSpaceConfig FixedConfig;
+    FixedConfig.SpaceType = EContainerSpaceType::Fixed;
+    FixedConfig.FixedSlotTypes = { TAG_Test_Placement_Weapon.GetTag(), FGameplayTag(), TAG_Test_Placement_Weapon.GetTag(), FGameplayTag() };
+    const int32 EquipmentID = TestWorld.SpawnContainer(FixedConfig)->GetContainerID();
+    TestEqual(TEXT("Every fixed slot counts towards capacity"), ItemSystem->FindContainer(EquipmentID)->GetSpaceManager()->GetCapacity(), 4);
+
+    TestTrue(TEXT("Plain item is placed"), ItemSystem->MoveItemToContainer(PlainItems[0], EquipmentID));
+    TestTrue(TEXT("First sword is placed"), ItemSystem->MoveItemToContainer(Swords[0], EquipmentID));
+    TestTrue(TEXT("Second sword is placed"), ItemSystem->MoveItemToContainer(Swords[1], EquipmentID));
+    TestTrue(TEXT("Third sword is placed"), ItemSystem->MoveItemToContainer(Swords[2], EquipmentID));
+    TestFalse(TEXT("Full container rejects the item"), ItemSystem->MoveItemToContainer(PlainItems[1], EquipmentID));
+
+    const int32 ExpectedSlots[][2] = { { PlainItems[0], 1 }, { Swords[0], 0 }, { Swords[1], 2 }, { Swords[2], 3 } };
+    int32 NumMisplaced = 0;
+    for (const int32 (&Expected)[2] : ExpectedSlots)
+    {
+        FItemLocation Location;
+        NumMisplaced += ItemSystem->GetItemLocation(Expected[0], Location) && Location == FItemLocation(EquipmentID, Expected[1]) ? 0 : 1;
+    }
+    TestEqual(TEXT("Typed slots are used before untyped ones"), NumMisplaced, 0);
+    TestEqual(TEXT("Rejected item stays on the ground"), CountNotInContainer(*ItemSystem, { PlainItems[1] }, GroundID), 0);
+
+    // 无序容器: 按容量接收, 其余物品保持原位
+    FContainerSpaceConfig UnorderedConfig;
+    UnorderedConfig.SpaceType = EContainerSpaceType::Unordered;
+    UnorderedConfig.Capacity = 1;
+    const int32 PouchID = TestWorld.SpawnContainer(UnorderedConfig)->GetContainerID();
+    const TArray<int32> MovedIds = ItemSystem->MoveItemsToContainer({ PlainItems[1], PlainItems[2] }, PouchID);
+    TestEqual(TEXT("Unordered container takes items up to its capacity"), MovedIds, TArray<int32>({ PlainItems[1] }));
+    TestEqual(TEXT("Item over capacity stays on the ground"), CountNotInContainer(*ItemSystem, { PlainItems[2] }, GroundID), 0);
+
+    FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*CatalogPath);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitPlacementBenchmarkTest, "InventoryKit.Placement.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitPlacementBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitPlacementTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 100x100的背包前90行已满, 自动拾取100个物品
+    constexpr int32 GridSize = 100;
+    constexpr int32 NumFullRows = 90;
+    constexpr int32 NumLoot = 100;
+    const int32 BackpackID = TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID();
+    const int32 GroundID = TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID();
+    for (int32 Slot = 0; Slot < NumFullRows * GridSize; ++Slot)
+    {
+        TestWorld.CreateItem(FItemLocation(BackpackID, Slot));
+    }
+    TArray<int32> LootIds;
+    for (int32 Slot = 0; Slot < NumLoot; ++Slot)
+    {
+        LootIds.Add(TestWorld.CreateItem(FItemLocation(GroundID, Slot)));
+    }
+
+    // 对照: 调用方逐个槽位探测找到第一个空位
+    UContainerSpaceManager* SpaceManager = ItemSystem->FindContainer(BackpackID)->GetSpaceManager();
+    double StartTime = FPlatformTime::Seconds();
+    int32 ProbedSlot = 0;
+    while (ProbedSlot < GridSize * GridSize && !SpaceManager->IsSlotAvailable(ProbedSlot))
+    {
+        ++ProbedSlot;
+    }
+    const double ProbeTime = FPlatformTime::Seconds() - StartTime;
+    TestEqual(TEXT("Probe finds the first free slot"), ProbedSlot, NumFullRows * GridSize);
+
+    StartTime = FPlatformTime::Seconds();
+    const TArray<int32> MovedIds = ItemSystem->MoveItemsToContainer(LootIds, BackpackID);
+    const double LootTime = FPlatformTime::Seconds() - StartTime;
+    TestEqual(TEXT("Every item is looted"), MovedIds.Num(), NumLoot);
+
+    AddInfo(FString::Printf(TEXT("Auto-loot of %d items into a %dx%d grid with %d full rows: %.3f us per item; one slot-by-slot probe: %.3f us"),
+                            NumLoot, GridSize, GridSize, NumFullRows, LootTime * 1e6 / NumLoot, ProbeTime * 1e6));
+    return true;
+}
+
+#endif
@@ -0,0 +1,167 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "Core/InventoryKitReplication.h"
+#include "Misc/AutomationTest.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "UObject/CoreNet.h"
+#include "UObject/UnrealType.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitReplicationTests
+{
+    /**
+     * 序列化快速数组中的单个条目
+     * 引擎的FNetSerializeCB依赖网络驱动按FRepLayout序列化, 测试中没有网络驱动, 条目内容改用结构体的二进制序列化;
+     * 数组头、条目的ReplicationID和ReplicationKey以及删除列表仍由FastArrayDeltaSerialize写出
+     */
+    class FTestNetSerializeCB : public INetSerializeCB
+    {
+    public:
+        int32 NumItemsWritten = 0;
+
+        virtual void NetSerializeStruct(FNetDeltaSerializeInfo& Params) override
+        {
+            check(Params.Writer);
+            CastChecked<UScriptStruct>(Params.Struct)->SerializeBin(*Params.Writer, Params.Data);
+            ++NumItemsWritten;
+        }
+
+        // 条目中没有对象引用, 以下回调不会被调用
+        virtual void GatherGuidReferencesForFastArray(FFastArrayDeltaSerializeParams& Params) override
+        {
+        }
+
+        virtual bool MoveGuidToUnmappedForFastArray(FFastArrayDeltaSerializeParams& Params) override
+        {
+            return false;
+        }
+
+        virtual void UpdateUnmappedGuidsForFastArray(FFastArrayDeltaSerializeParams& Params) override
+        {
+        }
+
+        virtual bool NetDeltaSerializeForFastArray(FFastArrayDeltaSerializeParams& Params) override
+        {
+            return false;
+        }
+    };
+
+    /**
+     * 模拟一个连接
+     * 与网络驱动相同, 每个连接保存上次发送时FastArrayDeltaSerialize生成的基准状态, 下次发送以它为OldState计算增量
+     * 每次发送都视为已确认
+     */
+    struct FSimulatedConnection
+    {
+        TSharedPtr<INetDeltaBaseState> BaseState;
+
+        int32 NumChanged = 0;
+        int32 NumDeleted = 0;
+
+        // 发送一次更新, 返回写出的位数, 没有变化时为0
+        int64 Update(FInventoryKitReplicatedItemArray& Array)
+        {
+            FTestNetSerializeCB NetSerializeCB;
+            FNetBitWriter Writer(nullptr, 8192);
+            TSharedPtr<INetDeltaBaseState> NewState;
+
+            FNetDeltaSerializeInfo Parms;
+            Parms.Writer = &Writer;
+            Parms.OldState = BaseState.Get();
+            Parms.NewState = &NewState;
+            Parms.NetSerializeCB = &NetSerializeCB;
+            const bool bWritten = Array.NetDeltaSerialize(Parms);
+
+            NumChanged = NetSerializeCB.NumItemsWritten;
+            NumDeleted = 0;
+            if (NewState.IsValid())
+            {
+                // 旧基准中有而新基准中没有的ReplicationID即为本次发送的删除
+                const FNetFastTArrayBaseState* OldBase = static_cast<const FNetFastTArrayBaseState*>(BaseState.Get());
+                const FNetFastTArrayBaseState* NewBase = static_cast<const FNetFastTArrayBaseState*>(NewState.Get());
+                if (OldBase)
+                {
+                    for (const TPair<int32, int32>& Acked : OldBase->IDToCLMap)
+                    {
+                        NumDeleted += NewBase->IDToCLMap.Contains(Acked.Key) ? 0 : 1;
+                    }
+                }
+                BaseState = NewState;
+            }
+            return bWritten ? Writer.GetNumBits() : 0;
+        }
+    };
+
+    // 容器组件的同步数组, 通过反射读取, 不对外公开
+    FInventoryKitReplicatedItemArray& GetReplicatedItems(UInventoryKitBaseContainerComponent* Container)
+    {
+        const FStructProperty* Property = FindFProperty<FStructProperty>(UInventoryKitBaseContainerComponent::StaticClass(), TEXT("ReplicatedItems"));
+        check(Property && Property->Struct == FInventoryKitReplicatedItemArray::StaticStruct());
+        return *Property->ContainerPtrToValuePtr<FInventoryKitReplicatedItemArray>(Container);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitReplicationDeltaTest, "InventoryKit.Replication.Delta",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitReplicationDeltaTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitReplicationTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 两个各有100个物品的容器, 只修改其中一个
+    constexpr int32 NumItems = 100;
+    UInventoryKitBaseContainerComponent* Backpack = TestWorld.SpawnGridContainer(10, 20);
+    UInventoryKitBaseContainerComponent* Stash = TestWorld.SpawnGridContainer(10, 20);
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < NumItems; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(Backpack->GetContainerID(), Slot)));
+        TestWorld.CreateItem(FItemLocation(Stash->GetContainerID(), Slot));
+    }
+    FInventoryKitReplicatedItemArray& BackpackItems = GetReplicatedItems(Backpack);
+    FInventoryKitReplicatedItemArray& StashItems = GetReplicatedItems(Stash);
+    if (!TestEqual(TEXT("Backpack replicates every item"), BackpackItems.GetItems().Num(), NumItems))
+    {
+        return false;
+    }
+
+    FSimulatedConnection BackpackConnections[2];
+    FSimulatedConnection StashConnection;
+    const int64 InitialBits = BackpackConnections[0].Update(BackpackItems);
+    BackpackConnections[1].Update(BackpackItems);
+    StashConnection.Update(StashItems);
+    TestEqual(TEXT("Initial update sends every item"), BackpackConnections[0].NumChanged, NumItems);
+
+    // 容器内移动一个物品: 只发送这一个条目, 没有变化的容器不发送
+    TestTrue(TEXT("Item is moved"), ItemSystem->MoveItem(ItemIds[0], FItemLocation(Backpack->GetContainerID(), NumItems)));
+    const int64 MoveBits = BackpackConnections[0].Update(BackpackItems);
+    TestEqual(TEXT("Move sends one entry"), BackpackConnections[0].NumChanged, 1);
+    TestEqual(TEXT("Move deletes nothing"), BackpackConnections[0].NumDeleted, 0);
+    TestEqual(TEXT("Unchanged container sends nothing"), StashConnection.Update(StashItems), static_cast<int64>(0));
+    TestEqual(TEXT("Up-to-date connection sends nothing"), BackpackConnections[0].Update(BackpackItems), static_cast<int64>(0));
+
+    // 销毁一个物品: 第一个连接只收到删除, 尚未更新的第二个连接同时收到之前的移动
+    TestTrue(TEXT("Item is destroyed"), ItemSystem->DestroyItem(ItemIds[1]));
+    const int64 DestroyBits = BackpackConnections[0].Update(BackpackItems);
+    TestEqual(TEXT("Destroy sends no entries"), BackpackConnections[0].NumChanged, 0);
+    TestEqual(TEXT("Destroy sends one deletion"), BackpackConnections[0].NumDeleted, 1);
+    const int64 CatchUpBits = BackpackConnections[1].Update(BackpackItems);
+    TestEqual(TEXT("Lagging connection receives the move"), BackpackConnections[1].NumChanged, 1);
+    TestEqual(TEXT("Lagging connection receives the deletion"), BackpackConnections[1].NumDeleted, 1);
+    TestTrue(TEXT("Delta is much smaller than a full resend"), MoveBits * 10 < InitialBits);
+
+    AddInfo(FString::Printf(TEXT("%d items: full update %lld bits, move %lld bits, destroy %lld bits, lagging connection %lld bits"),
+                            NumItems, InitialBits, MoveBits, DestroyBits, CatchUpBits));
+    return true;
+}
+
+#endif
@@ -0,0 +1,160 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitSlotMap.h"
+#include "Core/InventoryKitTypes.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSlotMapGenerationTest, "InventoryKit.SlotMap.Generation",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitSlotMapGenerationTest::RunTest(const FString& Parameters)
+{
+    using FSlotMap = TInventoryKitSlotMap<int32>;
+
+    FSlotMap SlotMap;
+    TArray<int32> IDs;
+    for (int32 Index = 0; Index < 16; ++Index)
+    {
+        int32 ID;
+        *SlotMap.AddDefaulted(ID) = Index;
+        IDs.Add(ID);
+    }
+
+    // 删除后元素仍然连续, 其余ID不受影响
+    TestTrue(TEXT("Remove live element"), SlotMap.Remove(IDs[3]));
+    TestFalse(TEXT("Remove stale ID"), SlotMap.Remove(IDs[3]));
+    TestEqual(TEXT("Dense element count"), SlotMap.GetElements().Num(), 15);
+    for (int32 Index = 0; Index < IDs.Num(); ++Index)
+    {
+        const int32* Value = SlotMap.Find(IDs[Index]);
+        if (Index == 3)
+        {
+            TestNull(TEXT("Stale ID misses"), Value);
+        }
+        else if (TestNotNull(TEXT("Live ID hits"), Value))
+        {
+            TestEqual(TEXT("Live ID keeps its element"), *Value, Index);
+        }
+    }
+
+    // 复用同一条目时世代不同, 旧ID不会命中新元素
+    int32 ReusedID;
+    *SlotMap.AddDefaulted(ReusedID) = 100;
+    TestEqual(TEXT("Freed entry is reused"), FSlotMap::GetEntryIndex(ReusedID), FSlotMap::GetEntryIndex(IDs[3]));
+    TestEqual(TEXT("Reused entry bumps generation"), FSlotMap::GetGeneration(ReusedID), FSlotMap::GetGeneration(IDs[3]) + 1);
+    TestFalse(TEXT("Old ID does not alias the new element"), SlotMap.Contains(IDs[3]));
+    for (int32 DenseIndex = 0; DenseIndex < SlotMap.Num(); ++DenseIndex)
+    {
+        TestEqual(TEXT("Dense index maps back to its ID"), *SlotMap.Find(SlotMap.GetIDAt(DenseIndex)), SlotMap.GetElements()[DenseIndex]);
+    }
+
+    // 同一条目反复分配释放, 世代用尽后退役, 期间ID不会重复
+    FSlotMap CycleMap;
+    TSet<int32> SeenIDs;
+    bool bAllUnique = true;
+    for (int32 Cycle = 0; Cycle <= FSlotMap::MaxGeneration; ++Cycle)
+    {
+        int32 ID;
+        CycleMap.AddDefaulted(ID);
+        bool bAlreadySeen = false;
+        SeenIDs.Add(ID, &bAlreadySeen);
+        bAllUnique &= !bAlreadySeen && FSlotMap::GetEntryIndex(ID) == 0;
+        CycleMap.Remove(ID);
+    }
+    TestTrue(TEXT("Every cycle reuses entry 0 with a fresh ID"), bAllUnique);
+    TestEqual(TEXT("Exhausted entry is retired"), CycleMap.GetNumRetired(), 1);
+    TestEqual(TEXT("Retired entry is not free"), CycleMap.GetNumFree(), 0);
+    TestEqual(TEXT("Remaining allocations exclude the retired entry"), CycleMap.GetRemainingAllocations(),
+              static_cast<int64>(FSlotMap::MaxEntries - 1) * (FSlotMap::MaxGeneration + 1));
+
+    int32 NextID;
+    CycleMap.AddDefaulted(NextID);
+    TestEqual(TEXT("Allocation after retirement uses a new entry"), FSlotMap::GetEntryIndex(NextID), 1);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSlotMapBenchmarkTest, "InventoryKit.SlotMap.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitSlotMapBenchmarkTest::RunTest(const FString& Parameters)
+{
+    // 与替换前的TMap<int32, FItemBaseInstance>对比按ID查找和遍历的耗时
+    for (const int32 NumItems : { 10000, 100000, 1000000 })
+    {
+        TMap<int32, FItemBaseInstance> ItemMap;
+        TInventoryKitSlotMap<FItemBaseInstance> ItemStore;
+        ItemMap.Reserve(NumItems);
+        ItemStore.Reserve(NumItems);
+
+        TArray<int32> MapIDs;
+        TArray<int32> StoreIDs;
+        MapIDs.Reserve(NumItems);
+        StoreIDs.Reserve(NumItems);
+        for (int32 Index = 0; Index < NumItems; ++Index)
+        {
+            FItemBaseInstance& MapItem = ItemMap.Add(Index);
+            MapItem.ItemID = Index;
+            MapItem.Quantity = Index & 7;
+            MapIDs.Add(Index);
+
+            int32 ID;
+            FItemBaseInstance* StoreItem = ItemStore.AddDefaulted(ID);
+            StoreItem->ItemID = ID;
+            StoreItem->Quantity = Index & 7;
+            StoreIDs.Add(ID);
+        }
+
+        // 两边按相同的随机顺序查找
+        FRandomStream Random(NumItems);
+        for (int32 Index = NumItems - 1; Index > 0; --Index)
+        {
+            const int32 SwapIndex = Random.RandRange(0, Index);
+            MapIDs.Swap(Index, SwapIndex);
+            StoreIDs.Swap(Index, SwapIndex);
+        }
+
+        int64 MapSum = 0;
+        double StartTime = FPlatformTime::Seconds();
+        for (const int32 ID : MapIDs)
+        {
+            MapSum += ItemMap.FindChecked(ID).Quantity;
+        }
+        const double MapLookupTime = FPlatformTime::Seconds() - StartTime;
+
+        int64 StoreSum = 0;
+        StartTime = FPlatformTime::Seconds();
+        for (const int32 ID : StoreIDs)
+        {
+            StoreSum += ItemStore.Find(ID)->Quantity;
+        }
+        const double StoreLookupTime = FPlatformTime::Seconds() - StartTime;
+        TestEqual(TEXT("Lookups visit the same items"), StoreSum, MapSum);
+
+        StartTime = FPlatformTime::Seconds();
+        MapSum = 0;
+        for (const TPair<int32, FItemBaseInstance>& Pair : ItemMap)
+        {
+            MapSum += Pair.Value.Quantity;
+        }
+        const double MapIterateTime = FPlatformTime::Seconds() - StartTime;
+
+        StartTime = FPlatformTime::Seconds();
+        StoreSum = 0;
+        for (const FItemBaseInstance& Item : ItemStore)
+        {
+            StoreSum += Item.Quantity;
+        }
+        const double StoreIterateTime = FPlatformTime::Seconds() - StartTime;
+        TestEqual(TEXT("Iteration visits the same items"), StoreSum, MapSum);
+
+        AddInfo(FString::Printf(TEXT("%d items: lookup TMap %.2f ms, slot map %.2f ms; iterate TMap %.2f ms, slot map %.2f ms"),
+                                NumItems, MapLookupTime * 1000.0, StoreLookupTime * 1000.0, MapIterateTime * 1000.0, StoreIterateTime * 1000.0));
+    }
+    return true;
+}
+
+#endif
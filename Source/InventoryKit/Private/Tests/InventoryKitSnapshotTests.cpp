@@ -0,0 +1,217 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "ContainerSpace/ContainerSpaceManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitSnapshotTests
+{
+    // 容器中每个物品的ID、槽位和尺寸, 按物品ID排序后比较
+    TArray<FIntVector4> DescribeContents(const UInventoryKitItemSystem* ItemSystem, int32 ContainerID)
+    {
+        TArray<FIntVector4> Contents;
+        for (const int32 ItemId : ItemSystem->GetItemsInContainerView(ContainerID))
+        {
+            const FItemBaseInstance Item = ItemSystem->GetItemBaseInstance(ItemId);
+            Contents.Add(FIntVector4(Item.ItemID, Item.ItemLocation.SlotIndex, Item.Size.X, Item.Size.Y));
+        }
+        Contents.Sort([](const FIntVector4& A, const FIntVector4& B) { return A.X < B.X; });
+        return Contents;
+    }
+
+    // 网格中被占用的槽位
+    TArray<int32> GetOccupiedSlots(UInventoryKitBaseContainerComponent* Container)
+    {
+        TArray<int32> OccupiedSlots;
+        const UContainerSpaceManager* SpaceManager = Container->GetSpaceManager();
+        for (int32 Slot = 0; Slot < SpaceManager->GetCapacity(); ++Slot)
+        {
+            if (!SpaceManager->IsSlotAvailable(Slot))
+            {
+                OccupiedSlots.Add(Slot);
+            }
+        }
+        return OccupiedSlots;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSnapshotRoundTripTest, "InventoryKit.Snapshot.RoundTrip",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitSnapshotRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitSnapshotTests;
+
+    // 保存方: 10x10背包中放入几个多格物品, 4x4小包挂接在背包中的物品上
+    FInventoryKitTestWorld SourceWorld;
+    UInventoryKitItemSystem* SourceSystem = SourceWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Source item system"), SourceSystem))
+    {
+        return false;
+    }
+    UInventoryKitBaseContainerComponent* SourceBackpack = SourceWorld.SpawnGridContainer(10, 10, TEXT("Test.Backpack"));
+    UInventoryKitBaseContainerComponent* SourcePouch = SourceWorld.SpawnGridContainer(4, 4, TEXT("Test.Pouch"));
+    const int32 SourceBackpackID = SourceBackpack->GetContainerID();
+    const int32 SourcePouchID = SourcePouch->GetContainerID();
+
+    const int32 HostItemId = SourceWorld.CreateItem(FItemLocation(SourceBackpackID, 0), FIntPoint(2, 2));
+    const int32 WideItemId = SourceWorld.CreateItem(FItemLocation(SourceBackpackID, 2), FIntPoint(3, 1));
+    const int32 TallItemId = SourceWorld.CreateItem(FItemLocation(SourceBackpackID, 55), FIntPoint(1, 3));
+    const int32 PouchItemId = SourceWorld.CreateItem(FItemLocation(SourcePouchID, 5), FIntPoint(2, 2));
+    if (!TestTrue(TEXT("Source items are created"), HostItemId != INDEX_NONE && WideItemId != INDEX_NONE && TallItemId != INDEX_NONE && PouchItemId != INDEX_NONE)
+        || !TestTrue(TEXT("Pouch is attached to its host item"), SourceSystem->AttachContainerToItem(SourcePouchID, HostItemId)))
+    {
+        return false;
+    }
+
+    TArray<uint8> SnapshotData;
+    if (!TestTrue(TEXT("Snapshot is saved"), SourceSystem->SaveSnapshot(SnapshotData)))
+    {
+        return false;
+    }
+
+    // 加载方: 先注册一个无关容器并倒序注册, 两个容器分到的ID与保存时不同
+    FInventoryKitTestWorld TargetWorld;
+    UInventoryKitItemSystem* TargetSystem = TargetWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Target item system"), TargetSystem))
+    {
+        return false;
+    }
+    UInventoryKitBaseContainerComponent* Decoy = TargetWorld.SpawnGridContainer(10, 10, TEXT("Test.Decoy"));
+    UInventoryKitBaseContainerComponent* TargetPouch = TargetWorld.SpawnGridContainer(4, 4, TEXT("Test.Pouch"));
+    UInventoryKitBaseContainerComponent* TargetBackpack = TargetWorld.SpawnGridContainer(10, 10, TEXT("Test.Backpack"));
+    const int32 TargetBackpackID = TargetBackpack->GetContainerID();
+    const int32 TargetPouchID = TargetPouch->GetContainerID();
+    TestNotEqual(TEXT("Backpack is registered under a different ID"), TargetBackpackID, SourceBackpackID);
+
+    if (!TestTrue(TEXT("Snapshot is loaded"), TargetSystem->LoadSnapshot(SnapshotData)))
+    {
+        return false;
+    }
+
+    // 物品按持久化标识回到对应的容器, 保留ID、槽位和尺寸
+    TestEqual(TEXT("Backpack contents survive the round trip"), DescribeContents(TargetSystem, TargetBackpackID), DescribeContents(SourceSystem, SourceBackpackID));
+    TestEqual(TEXT("Pouch contents survive the round trip"), DescribeContents(TargetSystem, TargetPouchID), DescribeContents(SourceSystem, SourcePouchID));
+    TestEqual(TEXT("Unrelated container stays empty"), TargetSystem->GetItemsInContainerView(Decoy->GetContainerID()).Num(), 0);
+    TestEqual(TEXT("Container caches are restored"), TargetBackpack->GetAllItems().Num(), 3);
+
+    // 网格占用整体恢复, 已占用的区域不能再放入物品
+    TestEqual(TEXT("Backpack occupancy survives the round trip"), GetOccupiedSlots(TargetBackpack), GetOccupiedSlots(SourceBackpack));
+    TestEqual(TEXT("Pouch occupancy survives the round trip"), GetOccupiedSlots(TargetPouch), GetOccupiedSlots(SourcePouch));
+    TestEqual(TEXT("Restored occupancy blocks new items"), TargetWorld.CreateItem(FItemLocation(TargetBackpackID, 11)), INDEX_NONE);
+    TestNotEqual(TEXT("Free cells accept new items"), TargetWorld.CreateItem(FItemLocation(TargetBackpackID, 99)), INDEX_NONE);
+
+    // 挂接关系映射到加载方的容器ID
+    TestEqual(TEXT("Host item carries the pouch"), TargetSystem->GetHostedContainerID(HostItemId), TargetPouchID);
+    TestEqual(TEXT("Pouch host item is restored"), TargetSystem->GetHostItemID(TargetPouchID), HostItemId);
+    TestEqual(TEXT("Pouch parent is the backpack"), TargetSystem->GetParentContainerID(TargetPouchID), TargetBackpackID);
+    TestTrue(TEXT("Recursive query reaches the pouch item"), TargetSystem->GetItemsInContainerRecursive(TargetBackpackID).Contains(PouchItemId));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSnapshotOccupancyRebuildTest, "InventoryKit.Snapshot.OccupancyRebuild",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitSnapshotOccupancyRebuildTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitSnapshotTests;
+
+    FInventoryKitTestWorld SourceWorld;
+    UInventoryKitItemSystem* SourceSystem = SourceWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Source item system"), SourceSystem))
+    {
+        return false;
+    }
+    const int32 SourceBackpackID = SourceWorld.SpawnGridContainer(10, 10, TEXT("Test.Backpack"))->GetContainerID();
+    SourceWorld.CreateItem(FItemLocation(SourceBackpackID, 0), FIntPoint(2, 2));
+    SourceWorld.CreateItem(FItemLocation(SourceBackpackID, 55), FIntPoint(1, 3));
+    TArray<uint8> SnapshotData;
+    if (!TestTrue(TEXT("Snapshot is saved"), SourceSystem->SaveSnapshot(SnapshotData)))
+    {
+        return false;
+    }
+
+    // 加载方的背包改成了12x10, 保存的位图不能直接使用; 另一个容器不在快照中, 但加载前已有物品
+    FInventoryKitTestWorld TargetWorld;
+    UInventoryKitItemSystem* TargetSystem = TargetWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Target item system"), TargetSystem))
+    {
+        return false;
+    }
+    UInventoryKitBaseContainerComponent* Resized = TargetWorld.SpawnGridContainer(12, 10, TEXT("Test.Backpack"));
+    UInventoryKitBaseContainerComponent* Unsaved = TargetWorld.SpawnGridContainer(4, 4, TEXT("Test.Unsaved"));
+    TestNotEqual(TEXT("Unsaved container holds an item before loading"), TargetWorld.CreateItem(FItemLocation(Unsaved->GetContainerID(), 5), FIntPoint(2, 2)), INDEX_NONE);
+    if (!TestTrue(TEXT("Snapshot is loaded"), TargetSystem->LoadSnapshot(SnapshotData)))
+    {
+        return false;
+    }
+
+    // 占用按恢复的物品重建, 与物品的实际区域一致
+    TArray<int32> ExpectedSlots;
+    TArray<int32> FootprintSlots;
+    for (const int32 ItemId : TargetSystem->GetItemsInContainerView(Resized->GetContainerID()))
+    {
+        const FItemBaseInstance Item = TargetSystem->GetItemBaseInstance(ItemId);
+        Resized->GetSpaceManager()->GetFootprintSlots(Item.ItemLocation.SlotIndex, Item.GetFootprint(), FootprintSlots);
+        ExpectedSlots.Append(FootprintSlots);
+    }
+    ExpectedSlots.Sort();
+    TestEqual(TEXT("Resized container keeps its items"), TargetSystem->GetItemsInContainerView(Resized->GetContainerID()).Num(), 2);
+    TestEqual(TEXT("Resized container occupancy is rebuilt from items"), GetOccupiedSlots(Resized), ExpectedSlots);
+    TestEqual(TEXT("Unsaved container is emptied"), TargetSystem->GetItemsInContainerView(Unsaved->GetContainerID()).Num(), 0);
+    TestEqual(TEXT("Unsaved container keeps no stale occupancy"), GetOccupiedSlots(Unsaved).Num(), 0);
+    TestNotEqual(TEXT("Freed cells of the unsaved container accept items"), TargetWorld.CreateItem(FItemLocation(Unsaved->GetContainerID(), 5), FIntPoint(2, 2)), INDEX_NONE);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSnapshotLoadTimeTest, "InventoryKit.Snapshot.LoadTime",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitSnapshotLoadTimeTest::RunTest(const FString& Parameters)
+{
+    // 1000x1000的网格放满1x1物品, 共100万个
+    constexpr int32 GridSize = 1000;
+    constexpr int32 NumItems = GridSize * GridSize;
+    constexpr int32 ItemsPerTransaction = 10000;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+    const int32 ContainerID = TestWorld.SpawnGridContainer(GridSize, GridSize, TEXT("Test.Stash"))->GetContainerID();
+    ItemSystem->ReserveItems(NumItems);
+
+    for (int32 FirstSlot = 0; FirstSlot < NumItems; FirstSlot += ItemsPerTransaction)
+    {
+        FInventoryKitTransaction Transaction;
+        for (int32 Slot = FirstSlot; Slot < FirstSlot + ItemsPerTransaction; ++Slot)
+        {
+            Transaction.StageCreate(FItemLocation(ContainerID, Slot));
+        }
+        if (!TestTrue(TEXT("Items are created"), ItemSystem->CommitTransaction(Transaction)))
+        {
+            return false;
+        }
+    }
+
+    double StartTime = FPlatformTime::Seconds();
+    TArray<uint8> SnapshotData;
+    TestTrue(TEXT("Snapshot is saved"), ItemSystem->SaveSnapshot(SnapshotData));
+    const double SaveTime = FPlatformTime::Seconds() - StartTime;
+
+    StartTime = FPlatformTime::Seconds();
+    TestTrue(TEXT("Snapshot is loaded"), ItemSystem->LoadSnapshot(SnapshotData));
+    const double LoadTime = FPlatformTime::Seconds() - StartTime;
+    TestEqual(TEXT("Every item is restored"), ItemSystem->GetItemsInContainerView(ContainerID).Num(), NumItems);
+
+    AddInfo(FString::Printf(TEXT("%d items: snapshot %.1f MB, save %.1f ms, load %.1f ms"),
+                            NumItems, SnapshotData.Num() / (1024.0 * 1024.0), SaveTime * 1000.0, LoadTime * 1000.0));
+    return true;
+}
+
+#endif
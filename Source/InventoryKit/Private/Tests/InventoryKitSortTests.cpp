@@ -0,0 +1,196 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "ContainerSpace/ContainerSpaceManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitSortTests
+{
+    constexpr int32 GridWidth = 10;
+    constexpr int32 GridHeight = 20;
+
+    // 容器中的物品按槽位排列
+    TArray<FItemBaseInstance> GetItemsBySlot(const UInventoryKitItemSystem& ItemSystem, int32 ContainerID)
+    {
+        TArray<FItemBaseInstance> Items;
+        for (const int32 ItemId : ItemSystem.GetItemsInContainerView(ContainerID))
+        {
+            Items.Add(ItemSystem.GetItemBaseInstance(ItemId));
+        }
+        Items.Sort([](const FItemBaseInstance& A, const FItemBaseInstance& B)
+        {
+            return A.ItemLocation.SlotIndex < B.ItemLocation.SlotIndex;
+        });
+        return Items;
+    }
+
+    /**
+     * 空间管理器的占用与物品位置不一致的格子数
+     * 物品占用的格子必须已占用且只被一个物品覆盖, 其余格子必须空闲
+     */
+    int32 CountOccupancyMismatches(UInventoryKitItemSystem& ItemSystem, int32 ContainerID)
+    {
+        TArray<int32> Coverage;
+        Coverage.Init(0, GridWidth * GridHeight);
+        for (const FItemBaseInstance& Item : GetItemsBySlot(ItemSystem, ContainerID))
+        {
+            const FIntPoint Footprint = Item.GetFootprint();
+            const int32 X = Item.ItemLocation.SlotIndex % GridWidth;
+            const int32 Y = Item.ItemLocation.SlotIndex / GridWidth;
+            for (int32 CellY = Y; CellY < FMath::Min(Y + Footprint.Y, GridHeight); ++CellY)
+            {
+                for (int32 CellX = X; CellX < FMath::Min(X + Footprint.X, GridWidth); ++CellX)
+                {
+                    ++Coverage[CellY * GridWidth + CellX];
+                }
+            }
+        }
+
+        const UContainerSpaceManager* SpaceManager = ItemSystem.FindContainer(ContainerID)->GetSpaceManager();
+        int32 NumMismatches = 0;
+        for (int32 Slot = 0; Slot < Coverage.Num(); ++Slot)
+        {
+            NumMismatches += Coverage[Slot] > 1 || SpaceManager->IsSlotAvailable(Slot) != (Coverage[Slot] == 0) ? 1 : 0;
+        }
+        return NumMismatches;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSortCorrectnessTest, "InventoryKit.Sort.Correctness",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitSortCorrectnessTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitSortTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 每隔一格放一个物品, 定义ID随机
+    const int32 BagID = TestWorld.SpawnGridContainer(GridWidth, GridHeight)->GetContainerID();
+    FRandomStream Random(20);
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < GridWidth * GridHeight; Slot += 2)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(BagID, Slot), FIntPoint(1, 1), Random.RandRange(0, 9)));
+    }
+    if (!TestFalse(TEXT("Items are created"), ItemIds.Contains(INDEX_NONE)))
+    {
+        return false;
+    }
+    ItemIds.Sort();
+
+    // 整理: 物品从第一个槽位起连续放置, 按定义ID升序, 同定义的物品保持原先的先后顺序
+    const TArray<FItemBaseInstance> BeforeSort = GetItemsBySlot(*ItemSystem, BagID);
+    TestTrue(TEXT("Container is sorted"), ItemSystem->SortContainer(BagID));
+    const TArray<FItemBaseInstance> AfterSort = GetItemsBySlot(*ItemSystem, BagID);
+    TArray<FItemBaseInstance> ExpectedOrder = BeforeSort;
+    ExpectedOrder.StableSort([](const FItemBaseInstance& A, const FItemBaseInstance& B)
+    {
+        return A.DefinitionID < B.DefinitionID;
+    });
+    int32 NumMisplaced = AfterSort.Num() == ExpectedOrder.Num() ? 0 : 1;
+    for (int32 Index = 0; Index < FMath::Min(AfterSort.Num(), ExpectedOrder.Num()); ++Index)
+    {
+        NumMisplaced += AfterSort[Index].ItemID == ExpectedOrder[Index].ItemID && AfterSort[Index].ItemLocation.SlotIndex == Index ? 0 : 1;
+    }
+    TestEqual(TEXT("Items are packed in sorted order"), NumMisplaced, 0);
+    TestEqual(TEXT("Occupancy matches the sorted items"), CountOccupancyMismatches(*ItemSystem, BagID), 0);
+
+    TArray<int32> SortedIds(ItemSystem->GetItemsInContainerView(BagID));
+    SortedIds.Sort();
+    TestEqual(TEXT("Sorting keeps every item"), SortedIds, ItemIds);
+
+    // 紧凑: 销毁一部分物品留下空隙, 剩余物品保持先后顺序前移
+    for (int32 Index = 0; Index < AfterSort.Num(); Index += 3)
+    {
+        ItemSystem->DestroyItem(AfterSort[Index].ItemID);
+    }
+    const TArray<FItemBaseInstance> BeforeCompact = GetItemsBySlot(*ItemSystem, BagID);
+    TestTrue(TEXT("Container is compacted"), ItemSystem->CompactContainer(BagID));
+    const TArray<FItemBaseInstance> AfterCompact = GetItemsBySlot(*ItemSystem, BagID);
+    NumMisplaced = AfterCompact.Num() == BeforeCompact.Num() ? 0 : 1;
+    for (int32 Index = 0; Index < FMath::Min(AfterCompact.Num(), BeforeCompact.Num()); ++Index)
+    {
+        NumMisplaced += AfterCompact[Index].ItemID == BeforeCompact[Index].ItemID && AfterCompact[Index].ItemLocation.SlotIndex == Index ? 0 : 1;
+    }
+    TestEqual(TEXT("Compaction closes gaps in order"), NumMisplaced, 0);
+    TestEqual(TEXT("Occupancy matches the compacted items"), CountOccupancyMismatches(*ItemSystem, BagID), 0);
+
+    // 按要求的顺序放不下时不做任何修改: 3x2的区域中先放两个1x1物品, 2x2物品就放不下了
+    const int32 PouchID = TestWorld.SpawnGridContainer(3, 2)->GetContainerID();
+    const int32 LargeItem = TestWorld.CreateItem(FItemLocation(PouchID, 0), FIntPoint(2, 2));
+    TestWorld.CreateItem(FItemLocation(PouchID, 2));
+    TestWorld.CreateItem(FItemLocation(PouchID, 5));
+    TArray<FItemLocation> PouchLocations;
+    for (const int32 ItemId : ItemSystem->GetItemsInContainerView(PouchID))
+    {
+        PouchLocations.Add(ItemSystem->GetItemBaseInstance(ItemId).ItemLocation);
+    }
+    TestFalse(TEXT("Sort that cannot fit fails"), ItemSystem->SortContainerBy(PouchID, [LargeItem](const FItemBaseInstance& A, const FItemBaseInstance& B)
+    {
+        return A.ItemID != LargeItem && B.ItemID == LargeItem;
+    }));
+    int32 NumMoved = 0;
+    int32 LocationIndex = 0;
+    for (const int32 ItemId : ItemSystem->GetItemsInContainerView(PouchID))
+    {
+        NumMoved += ItemSystem->GetItemBaseInstance(ItemId).ItemLocation == PouchLocations[LocationIndex++] ? 0 : 1;
+    }
+    TestEqual(TEXT("Failed sort moves nothing"), NumMoved, 0);
+    TestTrue(TEXT("Failed sort keeps the occupancy"), !ItemSystem->FindContainer(PouchID)->GetSpaceManager()->IsSlotAvailable(4));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitSortBenchmarkTest, "InventoryKit.Sort.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitSortBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitSortTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 放满200格的网格, 交替按定义ID升序和降序整理, 每次整理都会移动几乎所有物品
+    constexpr int32 NumSlots = GridWidth * GridHeight;
+    constexpr int32 NumRounds = 100;
+    const int32 BagID = TestWorld.SpawnGridContainer(GridWidth, GridHeight)->GetContainerID();
+    FRandomStream Random(200);
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        TestWorld.CreateItem(FItemLocation(BagID, Slot), FIntPoint(1, 1), Random.RandRange(0, 49));
+    }
+
+    int32 NumFailed = 0;
+    double SortTime = 0.0;
+    for (int32 Round = 0; Round < NumRounds; ++Round)
+    {
+        const bool bAscending = Round % 2 == 0;
+        const double StartTime = FPlatformTime::Seconds();
+        NumFailed += ItemSystem->SortContainerBy(BagID, [bAscending](const FItemBaseInstance& A, const FItemBaseInstance& B)
+        {
+            return bAscending ? A.DefinitionID < B.DefinitionID : A.DefinitionID > B.DefinitionID;
+        }) ? 0 : 1;
+        SortTime += FPlatformTime::Seconds() - StartTime;
+    }
+    TestEqual(TEXT("Every sort succeeds"), NumFailed, 0);
+    TestEqual(TEXT("Occupancy matches the items"), CountOccupancyMismatches(*ItemSystem, BagID), 0);
+
+    AddInfo(FString::Printf(TEXT("Sorting a full %dx%d grid: %.3f us per sort"), GridWidth, GridHeight, SortTime * 1e6 / NumRounds));
+    return true;
+}
+
+#endif
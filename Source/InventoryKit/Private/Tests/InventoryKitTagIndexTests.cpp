@@ -0,0 +1,182 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/InventoryKitTagIndex.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "NativeGameplayTags.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitTagIndexTests
+{
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Weapon, "InventoryKit.Test.Weapon");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Weapon_Sword, "InventoryKit.Test.Weapon.Sword");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Weapon_Bow, "InventoryKit.Test.Weapon.Bow");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Armor, "InventoryKit.Test.Armor");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Armor_Helmet, "InventoryKit.Test.Armor.Helmet");
+    UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Test_Quest, "InventoryKit.Test.Quest");
+
+    // 从父标签和叶子标签中随机取0到3个
+    FGameplayTagContainer MakeRandomTags(FRandomStream& Random)
+    {
+        const FGameplayTag Pool[] = {
+            TAG_Test_Weapon.GetTag(), TAG_Test_Weapon_Sword.GetTag(), TAG_Test_Weapon_Bow.GetTag(),
+            TAG_Test_Armor.GetTag(), TAG_Test_Armor_Helmet.GetTag(), TAG_Test_Quest.GetTag()
+        };
+        FGameplayTagContainer Tags;
+        const int32 NumTags = Random.RandRange(0, 3);
+        for (int32 Index = 0; Index < NumTags; ++Index)
+        {
+            Tags.AddTag(Pool[Random.RandRange(0, UE_ARRAY_COUNT(Pool) - 1)]);
+        }
+        return Tags;
+    }
+
+    // 覆盖各种表达式类型的查询, 包括嵌套和取反
+    TArray<FGameplayTagQuery> MakeQueries()
+    {
+        TArray<FGameplayTagQuery> Queries;
+        Queries.Add(FGameplayTagQuery::MakeQuery_MatchAnyTags(FGameplayTagContainer(TAG_Test_Weapon.GetTag())));
+        Queries.Add(FGameplayTagQuery::MakeQuery_MatchAnyTags(FGameplayTagContainer::CreateFromArray(TArray<FGameplayTag>{ TAG_Test_Weapon_Sword.GetTag(), TAG_Test_Armor_Helmet.GetTag() })));
+        Queries.Add(FGameplayTagQuery::MakeQuery_MatchAllTags(FGameplayTagContainer::CreateFromArray(TArray<FGameplayTag>{ TAG_Test_Weapon.GetTag(), TAG_Test_Quest.GetTag() })));
+        Queries.Add(FGameplayTagQuery::MakeQuery_MatchNoTags(FGameplayTagContainer(TAG_Test_Armor.GetTag())));
+
+        // 武器且不是任务物品
+        FGameplayTagQueryExpression AnyWeapon;
+        AnyWeapon.AnyTagsMatch().AddTag(TAG_Test_Weapon.GetTag());
+        FGameplayTagQueryExpression NoQuest;
+        NoQuest.NoTagsMatch().AddTag(TAG_Test_Quest.GetTag());
+        FGameplayTagQueryExpression WeaponNotQuest;
+        WeaponNotQuest.AllExprMatch().AddExpr(AnyWeapon).AddExpr(NoQuest);
+        Queries.Add(FGameplayTagQuery::BuildQuery(WeaponNotQuest));
+
+        // 同时是护甲和任务物品, 或者不是弓
+        FGameplayTagQueryExpression ArmorAndQuest;
+        ArmorAndQuest.AllTagsMatch().AddTag(TAG_Test_Armor.GetTag()).AddTag(TAG_Test_Quest.GetTag());
+        FGameplayTagQueryExpression AnyBow;
+        AnyBow.AnyTagsMatch().AddTag(TAG_Test_Weapon_Bow.GetTag());
+        FGameplayTagQueryExpression NotBow;
+        NotBow.NoExprMatch().AddExpr(AnyBow);
+        FGameplayTagQueryExpression ArmorQuestOrNotBow;
+        ArmorQuestOrNotBow.AnyExprMatch().AddExpr(ArmorAndQuest).AddExpr(NotBow);
+        Queries.Add(FGameplayTagQuery::BuildQuery(ArmorQuestOrNotBow));
+        return Queries;
+    }
+
+    // 索引求值结果与逐个调用Matches不一致的物品数
+    int32 CountMismatches(const FInventoryKitTagIndex& Index, const FGameplayTagQuery& Query, const TMap<int32, FGameplayTagContainer>& ItemTags)
+    {
+        FInventoryKitTagIndex::FResult Result;
+        if (!Index.Evaluate(Query, Result))
+        {
+            return ItemTags.Num();
+        }
+
+        int32 NumMismatches = 0;
+        for (const TPair<int32, FGameplayTagContainer>& Item : ItemTags)
+        {
+            const bool bIndexed = Result.Items.Contains(Item.Key) != Result.bComplement;
+            NumMismatches += bIndexed == Query.Matches(Item.Value) ? 0 : 1;
+        }
+        return NumMismatches;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitTagIndexQueryTest, "InventoryKit.TagIndex.Query",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitTagIndexQueryTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitTagIndexTests;
+
+    constexpr int32 NumItems = 2000;
+    FRandomStream Random(16);
+    FInventoryKitTagIndex Index;
+    TMap<int32, FGameplayTagContainer> ItemTags;
+    for (int32 ItemId = 0; ItemId < NumItems; ++ItemId)
+    {
+        const FGameplayTagContainer& Tags = ItemTags.Add(ItemId, MakeRandomTags(Random));
+        Index.AddItem(ItemId, Tags);
+    }
+
+    const TArray<FGameplayTagQuery> Queries = MakeQueries();
+    int32 NumMismatches = 0;
+    for (const FGameplayTagQuery& Query : Queries)
+    {
+        NumMismatches += CountMismatches(Index, Query, ItemTags);
+    }
+    TestEqual(TEXT("Indexed queries match a linear scan"), NumMismatches, 0);
+
+    // 父标签的倒排表包含子标签的物品
+    int32 NumWeapons = 0;
+    for (const TPair<int32, FGameplayTagContainer>& Item : ItemTags)
+    {
+        NumWeapons += Item.Value.HasTag(TAG_Test_Weapon.GetTag()) ? 1 : 0;
+    }
+    const FInventoryKitItemIdSet* Weapons = Index.Find(TAG_Test_Weapon.GetTag());
+    TestEqual(TEXT("Parent tag posting covers child tags"), Weapons ? Weapons->Num() : 0, NumWeapons);
+
+    // 移除一半物品后结果仍一致
+    for (int32 ItemId = 0; ItemId < NumItems; ItemId += 2)
+    {
+        Index.RemoveItem(ItemId, ItemTags.FindAndRemoveChecked(ItemId));
+    }
+    NumMismatches = 0;
+    for (const FGameplayTagQuery& Query : Queries)
+    {
+        NumMismatches += CountMismatches(Index, Query, ItemTags);
+    }
+    TestEqual(TEXT("Indexed queries match a linear scan after removals"), NumMismatches, 0);
+
+    // 精确匹配不走索引, 由调用方退回逐个匹配
+    FGameplayTagQueryExpression ExactMatch;
+    ExactMatch.AnyTagsExactMatch().AddTag(TAG_Test_Weapon.GetTag());
+    FInventoryKitTagIndex::FResult Result;
+    TestFalse(TEXT("Exact match is not evaluated by the index"), Index.Evaluate(FGameplayTagQuery::BuildQuery(ExactMatch), Result));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitTagIndexBenchmarkTest, "InventoryKit.TagIndex.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInventoryKitTagIndexBenchmarkTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitTagIndexTests;
+
+    constexpr int32 NumItems = 100000;
+    FRandomStream Random(100);
+    FInventoryKitTagIndex Index;
+    TArray<FGameplayTagContainer> ItemTags;
+    ItemTags.Reserve(NumItems);
+    for (int32 ItemId = 0; ItemId < NumItems; ++ItemId)
+    {
+        Index.AddItem(ItemId, ItemTags.Add_GetRef(MakeRandomTags(Random)));
+    }
+
+    const TArray<FGameplayTagQuery> Queries = MakeQueries();
+    for (int32 QueryIndex = 0; QueryIndex < Queries.Num(); ++QueryIndex)
+    {
+        const FGameplayTagQuery& Query = Queries[QueryIndex];
+        double StartTime = FPlatformTime::Seconds();
+        FInventoryKitTagIndex::FResult Result;
+        Index.Evaluate(Query, Result);
+        const double IndexTime = FPlatformTime::Seconds() - StartTime;
+        const int32 NumIndexed = Result.bComplement ? NumItems - Result.Items.Num() : Result.Items.Num();
+
+        StartTime = FPlatformTime::Seconds();
+        int32 NumScanned = 0;
+        for (const FGameplayTagContainer& Tags : ItemTags)
+        {
+            NumScanned += Query.Matches(Tags) ? 1 : 0;
+        }
+        const double ScanTime = FPlatformTime::Seconds() - StartTime;
+
+        TestEqual(TEXT("Indexed and scanned counts agree"), NumIndexed, NumScanned);
+        AddInfo(FString::Printf(TEXT("Query %d on %d items: %d matches, index %.3f ms, linear scan %.3f ms"),
+                                QueryIndex, NumItems, NumScanned, IndexTime * 1000.0, ScanTime * 1000.0));
+    }
+    return true;
+}
+
+#endif
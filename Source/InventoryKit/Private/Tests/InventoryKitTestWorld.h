@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Core/InventoryKitBaseContainerComponent.h"
+#include "Core/InventoryKitItemSystem.h"
+#include "Core/InventoryKitTransaction.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+/**
+ * 自动化测试用的独立游戏世界
+ * 构造时创建世界并开始游戏, 物品系统随世界初始化; 析构时销毁世界
+ */
+class FInventoryKitTestWorld
+{
+public:
+    FInventoryKitTestWorld()
+    {
+        World = UWorld::CreateWorld(EWorldType::Game, false);
+        FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+        WorldContext.SetCurrentWorld(World);
+        World->InitializeActorsForPlay(FURL());
+        World->BeginPlay();
+        ItemSystem = World->GetSubsystem<UInventoryKitItemSystem>();
+    }
+
+    ~FInventoryKitTestWorld()
+    {
+        GEngine->DestroyWorldContext(World);
+        World->DestroyWorld(false);
+    }
+
+    UInventoryKitItemSystem* GetItemSystem() const
+    {
+        return ItemSystem;
+    }
+
+    /**
+     * 生成一个带网格容器的Actor
+     * 世界已开始游戏, 组件注册时直接调用BeginPlay, 返回时容器已在物品系统中注册
+     *
+     * @param PersistentKey 快照中标识容器的持久化标识, 为空时使用组件路径
+     */
+    UInventoryKitBaseContainerComponent* SpawnGridContainer(int32 Width, int32 Height, const FString& PersistentKey = FString())
+    {
+        FContainerSpaceConfig Config;
+        Config.SpaceType = EContainerSpaceType::Grid;
+        Config.GridWidth = Width;
+        Config.GridHeight = Height;
+        return SpawnContainer(Config, PersistentKey);
+    }
+
+    // 按任意空间配置生成容器
+    UInventoryKitBaseContainerComponent* SpawnContainer(const FContainerSpaceConfig& Config, const FString& PersistentKey = FString())
+    {
+        AActor* Actor = World->SpawnActor<AActor>();
+        UInventoryKitBaseContainerComponent* Container = NewObject<UInventoryKitBaseContainerComponent>(Actor);
+        Container->SetSpaceConfig(Config);
+        Container->SetPersistentKey(PersistentKey);
+        Container->RegisterComponent();
+        return Container;
+    }
+
+    // 销毁容器所在的Actor, 容器按其孤儿策略注销
+    void DestroyContainer(UInventoryKitBaseContainerComponent* Container)
+    {
+        Container->GetOwner()->Destroy();
+    }
+
+    /**
+     * 通过事务按模板创建物品
+     *
+     * @return 新物品ID, 创建失败时返回-1
+     */
+    int32 CreateItem(const FItemLocation& Location, const FIntPoint& Size = FIntPoint(1, 1), int32 DefinitionID = 0)
+    {
+        FItemBaseInstance Template;
+        Template.DefinitionID = DefinitionID;
+        Template.Size = Size;
+
+        FInventoryKitTransaction Transaction;
+        Transaction.StageCreate(Template, Location);
+        TArray<int32> CreatedItemIds;
+        return ItemSystem->CommitTransaction(Transaction, &CreatedItemIds) ? CreatedItemIds[0] : INDEX_NONE;
+    }
+
+private:
+    UWorld* World = nullptr;
+    UInventoryKitItemSystem* ItemSystem = nullptr;
+};
+
+#endif
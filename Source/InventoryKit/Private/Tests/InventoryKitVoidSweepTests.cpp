@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "ContainerSpace/ContainerSpaceManager.h"
+#include "Core/InventoryKitVoidContainer.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitVoidDestroyTest, "InventoryKit.Void.Destroy",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitVoidDestroyTest::RunTest(const FString& Parameters)
+{
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    const int32 BagID = TestWorld.SpawnGridContainer(5, 5)->GetContainerID();
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < 10; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(BagID, Slot)));
+    }
+    const FInventoryKitItemIdStats Before = ItemSystem->GetItemIdStats();
+
+    // 单个销毁: 物品从容器和存储中移除, 槽位释放, 旧ID不再命中
+    TestTrue(TEXT("Item is destroyed"), ItemSystem->DestroyItem(ItemIds[0]));
+    FItemLocation Location;
+    TestFalse(TEXT("Destroyed item is gone"), ItemSystem->GetItemLocation(ItemIds[0], Location));
+    TestFalse(TEXT("Destroying twice fails"), ItemSystem->DestroyItem(ItemIds[0]));
+    TestTrue(TEXT("Slot is released"), ItemSystem->FindContainer(BagID)->GetSpaceManager()->IsSlotAvailable(0));
+
+    // 批量销毁跳过不存在的物品
+    TArray<int32> BatchIds(TConstArrayView<int32>(ItemIds).Slice(1, 5));
+    BatchIds.Add(ItemIds[0]);
+    TestEqual(TEXT("Batch destroys the live items"), ItemSystem->DestroyItems(BatchIds), 5);
+    TestEqual(TEXT("Container keeps the rest"), ItemSystem->GetItemsInContainerView(BagID).Num(), 4);
+
+    // 释放的条目回到存储, 新物品复用而不是新分配
+    const FInventoryKitItemIdStats AfterDestroy = ItemSystem->GetItemIdStats();
+    TestEqual(TEXT("Live count drops"), AfterDestroy.NumLive, Before.NumLive - 6);
+    TestEqual(TEXT("Freed entries are reusable"), AfterDestroy.NumFree + AfterDestroy.NumRetired, Before.NumFree + Before.NumRetired + 6);
+    for (int32 Slot = 0; Slot < 6; ++Slot)
+    {
+        TestWorld.CreateItem(FItemLocation(BagID, Slot));
+    }
+    TestEqual(TEXT("New items reuse freed entries"), ItemSystem->GetItemIdStats().NumEntries, AfterDestroy.NumEntries);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitVoidSweepTest, "InventoryKit.Void.Sweep",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitVoidSweepTest::RunTest(const FString& Parameters)
+{
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    constexpr double MaxAge = 60.0;
+    constexpr int32 EntriesPerSlice = 4;
+    ItemSystem->SetVoidSweep(MaxAge, EntriesPerSlice);
+    const int32 VoidID = ItemSystem->GetVoidContainerID();
+    UInventoryKitVoidContainer* VoidContainer = static_cast<UInventoryKitVoidContainer*>(ItemSystem->FindContainer(VoidID));
+
+    // 8个物品依次进入虚空, 前5个随后离开, 在队列头部留下5条失效记录
+    const int32 BagID = TestWorld.SpawnGridContainer(5, 5)->GetContainerID();
+    TArray<int32> ItemIds;
+    for (int32 Slot = 0; Slot < 8; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(BagID, Slot)));
+    }
+    for (const int32 ItemId : ItemIds)
+    {
+        TestTrue(TEXT("Item enters the void"), ItemSystem->MoveItemToContainer(ItemId, VoidID));
+    }
+    for (int32 Index = 0; Index < 5; ++Index)
+    {
+        TestTrue(TEXT("Item leaves the void"), ItemSystem->MoveItem(ItemIds[Index], FItemLocation(BagID, Index)));
+    }
+
+    TArray<int32> Collected;
+    TestEqual(TEXT("Nothing expires early"), VoidContainer->CollectExpiredItems(FPlatformTime::Seconds(), MaxAge, EntriesPerSlice, Collected), 0);
+
+    // 失效记录同样计入每次的预算: 第一片只检查了4条失效记录, 第二片跳过最后一条后取出剩余物品
+    const double Later = FPlatformTime::Seconds() + 2 * MaxAge;
+    TestEqual(TEXT("Stale entries use the slice budget"), VoidContainer->CollectExpiredItems(Later, MaxAge, EntriesPerSlice, Collected), 0);
+    TestEqual(TEXT("Second slice collects after the last stale entry"), VoidContainer->CollectExpiredItems(Later, MaxAge, EntriesPerSlice, Collected), 3);
+    TestEqual(TEXT("Expired items are collected in entry order"), Collected, TArray<int32>({ ItemIds[5], ItemIds[6], ItemIds[7] }));
+    TestEqual(TEXT("Queue is drained"), VoidContainer->CollectExpiredItems(Later, MaxAge, EntriesPerSlice, Collected), 0);
+
+    // 取出的物品交给DestroyItems销毁
+    TestEqual(TEXT("Collected items are destroyed"), ItemSystem->DestroyItems(Collected), 3);
+    TestEqual(TEXT("Void is empty"), ItemSystem->GetItemsInContainerView(VoidID).Num(), 0);
+    return true;
+}
+
+#endif
@@ -0,0 +1,221 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryKitTestWorld.h"
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/ScopeLock.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InventoryKitWorldViewTests
+{
+    using FWorldViewPtr = TSharedPtr<const FInventoryKitWorldView, ESPMode::ThreadSafe>;
+
+    // 视图中的容器内容和物品位置与物品系统当前状态不一致的数量
+    int32 CountMismatches(const UInventoryKitItemSystem& ItemSystem, const FInventoryKitWorldView& View, TConstArrayView<int32> ContainerIds)
+    {
+        int32 NumMismatches = 0;
+        for (const int32 ContainerID : ContainerIds)
+        {
+            TArray<int32> ViewItems(View.GetItemsInContainer(ContainerID));
+            TArray<int32> SystemItems(ItemSystem.GetItemsInContainerView(ContainerID));
+            ViewItems.Sort();
+            SystemItems.Sort();
+            NumMismatches += ViewItems == SystemItems ? 0 : 1;
+
+            for (const int32 ItemId : SystemItems)
+            {
+                FItemLocation Location;
+                const FItemBaseInstance* ViewItem = View.FindItem(ItemId);
+                NumMismatches += ViewItem && ItemSystem.GetItemLocation(ItemId, Location) && ViewItem->ItemLocation == Location ? 0 : 1;
+            }
+        }
+        return NumMismatches;
+    }
+
+    // 视图自身不一致的数量: 容器列出的物品不在该容器中, 或各容器物品数之和不等于物品总数
+    int32 CountTornState(const FInventoryKitWorldView& View, TConstArrayView<int32> ContainerIds)
+    {
+        int32 NumTorn = 0;
+        int32 NumListed = 0;
+        for (const int32 ContainerID : ContainerIds)
+        {
+            const TConstArrayView<int32> Items = View.GetItemsInContainer(ContainerID);
+            NumListed += Items.Num();
+            for (const int32 ItemId : Items)
+            {
+                const FItemBaseInstance* Item = View.FindItem(ItemId);
+                NumTorn += Item && Item->ItemLocation.ContainerID == ContainerID ? 0 : 1;
+            }
+        }
+        NumTorn += NumListed == View.GetNumItems() ? 0 : 1;
+        return NumTorn;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitWorldViewPublishTest, "InventoryKit.WorldView.Publish",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitWorldViewPublishTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitWorldViewTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    ItemSystem->SetWorldViewPublishing(true);
+    const int32 BackpackID = TestWorld.SpawnGridContainer(10, 10)->GetContainerID();
+    const int32 StashID = TestWorld.SpawnGridContainer(10, 10)->GetContainerID();
+    UInventoryKitBaseContainerComponent* Crate = TestWorld.SpawnGridContainer(5, 5);
+    const int32 CrateID = Crate->GetContainerID();
+    TArray<int32> BackpackItems;
+    for (int32 Slot = 0; Slot < 20; ++Slot)
+    {
+        BackpackItems.Add(TestWorld.CreateItem(FItemLocation(BackpackID, Slot)));
+    }
+    for (int32 Slot = 0; Slot < 3; ++Slot)
+    {
+        TestWorld.CreateItem(FItemLocation(StashID, Slot));
+        TestWorld.CreateItem(FItemLocation(CrateID, Slot));
+    }
+
+    ItemSystem->PublishWorldView();
+    const FWorldViewPtr FirstView = ItemSystem->GetWorldView();
+    if (!TestNotNull(TEXT("View is published"), FirstView.Get()))
+    {
+        return false;
+    }
+    const int32 ContainerIds[] = { BackpackID, StashID, CrateID };
+    TestEqual(TEXT("First view matches the item system"), CountMismatches(*ItemSystem, *FirstView, ContainerIds), 0);
+
+    // 移动一个物品: 新版本只替换两个有变化的容器, 未变化的容器与上一版本共享同一份内容
+    TestTrue(TEXT("Item is moved"), ItemSystem->MoveItem(BackpackItems[0], FItemLocation(StashID, 5)));
+    ItemSystem->PublishWorldView();
+    const FWorldViewPtr SecondView = ItemSystem->GetWorldView();
+    TestTrue(TEXT("Version increases"), SecondView->GetVersion() > FirstView->GetVersion());
+    TestEqual(TEXT("Second view matches the item system"), CountMismatches(*ItemSystem, *SecondView, ContainerIds), 0);
+    TestEqual(TEXT("Changed container has the new version"), SecondView->GetContainerVersion(StashID), SecondView->GetVersion());
+    TestEqual(TEXT("Unchanged container keeps its version"), SecondView->GetContainerVersion(CrateID), FirstView->GetContainerVersion(CrateID));
+    TestTrue(TEXT("Unchanged container contents are shared"), SecondView->GetItemsInContainer(CrateID).GetData() == FirstView->GetItemsInContainer(CrateID).GetData());
+
+    // 已发布的视图不受之后修改的影响
+    const FItemBaseInstance* OldItem = FirstView->FindItem(BackpackItems[0]);
+    TestTrue(TEXT("Earlier view still sees the old location"), OldItem && OldItem->ItemLocation.ContainerID == BackpackID);
+    TestEqual(TEXT("Earlier view keeps its contents"), FirstView->GetItemsInContainer(BackpackID).Num(), 20);
+
+    ItemSystem->PublishWorldView();
+    TestTrue(TEXT("Publishing without changes keeps the view"), ItemSystem->GetWorldView() == SecondView);
+
+    // 注销容器后视图中不再有该容器; 复用同一条目的新容器不会被旧ID查到
+    TestWorld.DestroyContainer(Crate);
+    ItemSystem->PublishWorldView();
+    const FWorldViewPtr ThirdView = ItemSystem->GetWorldView();
+    TestEqual(TEXT("Unregistered container has no items in the view"), ThirdView->GetItemsInContainer(CrateID).Num(), 0);
+    TestEqual(TEXT("Unregistered container has no version"), ThirdView->GetContainerVersion(CrateID), static_cast<uint64>(0));
+    TestEqual(TEXT("Orphans appear in the void"), ThirdView->GetItemsInContainer(ItemSystem->GetVoidContainerID()).Num(), 3);
+
+    const int32 ReplacementID = TestWorld.SpawnGridContainer(5, 5)->GetContainerID();
+    TestWorld.CreateItem(FItemLocation(ReplacementID, 0));
+    ItemSystem->PublishWorldView();
+    const FWorldViewPtr FourthView = ItemSystem->GetWorldView();
+    TestEqual(TEXT("Replacement container is published"), FourthView->GetItemsInContainer(ReplacementID).Num(), 1);
+    TestEqual(TEXT("Stale container ID misses"), FourthView->GetItemsInContainer(CrateID).Num(), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryKitWorldViewConcurrentReadersTest, "InventoryKit.WorldView.ConcurrentReaders",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInventoryKitWorldViewConcurrentReadersTest::RunTest(const FString& Parameters)
+{
+    using namespace InventoryKitWorldViewTests;
+
+    FInventoryKitTestWorld TestWorld;
+    UInventoryKitItemSystem* ItemSystem = TestWorld.GetItemSystem();
+    if (!TestNotNull(TEXT("Item system"), ItemSystem))
+    {
+        return false;
+    }
+
+    // 物品i始终位于两个容器之一的第i个槽位, 每轮把一组物品移到另一个容器
+    constexpr int32 GridSize = 16;
+    constexpr int32 NumItems = 200;
+    constexpr int32 NumMovesPerRound = 10;
+    constexpr int32 NumRounds = 500;
+    constexpr int32 NumReaders = 4;
+    ItemSystem->SetWorldViewPublishing(true);
+    const int32 ContainerIds[2] = {
+        TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID(),
+        TestWorld.SpawnGridContainer(GridSize, GridSize)->GetContainerID()
+    };
+    TArray<int32> ItemIds;
+    TArray<int32> ItemSides;
+    for (int32 Slot = 0; Slot < NumItems; ++Slot)
+    {
+        ItemIds.Add(TestWorld.CreateItem(FItemLocation(ContainerIds[0], Slot)));
+        ItemSides.Add(0);
+    }
+    ItemSystem->PublishWorldView();
+
+    // 视图由游戏线程发布, 通过加锁的指针交给读取线程; 读取视图本身不加锁
+    FCriticalSection LatestViewLock;
+    FWorldViewPtr LatestView = ItemSystem->GetWorldView();
+    std::atomic<bool> bStopReaders { false };
+    std::atomic<int32> NumTornViews { 0 };
+    std::atomic<int32> NumOutOfOrderViews { 0 };
+    std::atomic<int32> NumViewsRead { 0 };
+    TArray<TFuture<void>> Readers;
+    for (int32 Reader = 0; Reader < NumReaders; ++Reader)
+    {
+        Readers.Add(Async(EAsyncExecution::Thread, [&]()
+        {
+            uint64 LastVersion = 0;
+            while (!bStopReaders.load())
+            {
+                FWorldViewPtr View;
+                {
+                    FScopeLock Lock(&LatestViewLock);
+                    View = LatestView;
+                }
+                NumTornViews.fetch_add(CountTornState(*View, ContainerIds));
+                NumOutOfOrderViews.fetch_add(View->GetVersion() < LastVersion ? 1 : 0);
+                LastVersion = View->GetVersion();
+                NumViewsRead.fetch_add(1);
+            }
+        }));
+    }
+
+    int32 NumFailedMoves = 0;
+    for (int32 Round = 0; Round < NumRounds; ++Round)
+    {
+        for (int32 Move = 0; Move < NumMovesPerRound; ++Move)
+        {
+            const int32 Slot = (Round * NumMovesPerRound + Move) % NumItems;
+            ItemSides[Slot] = 1 - ItemSides[Slot];
+            NumFailedMoves += ItemSystem->MoveItem(ItemIds[Slot], FItemLocation(ContainerIds[ItemSides[Slot]], Slot)) ? 0 : 1;
+        }
+        ItemSystem->PublishWorldView();
+
+        FScopeLock Lock(&LatestViewLock);
+        LatestView = ItemSystem->GetWorldView();
+    }
+
+    bStopReaders.store(true);
+    for (TFuture<void>& Reader : Readers)
+    {
+        Reader.Wait();
+    }
+
+    TestEqual(TEXT("Every move succeeds"), NumFailedMoves, 0);
+    TestEqual(TEXT("Readers never see torn state"), NumTornViews.load(), 0);
+    TestEqual(TEXT("Readers never see an older version"), NumOutOfOrderViews.load(), 0);
+    TestTrue(TEXT("Readers read views"), NumViewsRead.load() > 0);
+    TestEqual(TEXT("Latest view matches the item system"), CountMismatches(*ItemSystem, *ItemSystem->GetWorldView(), ContainerIds), 0);
+    return true;
+}
+
+#endif
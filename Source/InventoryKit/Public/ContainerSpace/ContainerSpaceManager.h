@@ -81,4 +81,95 @@ public:
     virtual int32 GetSlotIndexByXY(int32 X, int32 Y) const PURE_VIRTUAL(UContainerSpaceManager::GetSlotIndexByXY, return INDEX_NONE;);
 
     virtual void UpdateSlotState(int32 SlotIndex, uint8 Flag) PURE_VIRTUAL(UContainerSpaceManager::UpdateSlotState, );
+
+    /**
+     * 检查以SlotIndex为左上角、尺寸为Footprint的区域是否可用
+     * 默认实现只检查单个槽位, 网格容器会检查整个区域
+     * 
+     * @param SlotIndex 左上角槽位索引
+     * @param Footprint 占用宽高
+     * @param IgnoreSlotIndex 视为空闲的区域左上角, 用于容器内移动时忽略物品自身
+     * @param IgnoreFootprint 视为空闲的区域宽高
+     * @return 区域是否可用
+     */
+    virtual bool IsFootprintAvailable(int32 SlotIndex, const FIntPoint& Footprint, int32 IgnoreSlotIndex = INDEX_NONE, const FIntPoint& IgnoreFootprint = FIntPoint(1, 1)) const
+    {
+        return SlotIndex == IgnoreSlotIndex || IsSlotAvailable(SlotIndex);
+    }
+
+    /**
+     * 更新以SlotIndex为左上角、尺寸为Footprint的区域状态
+     * 默认实现只更新单个槽位
+     */
+    virtual void UpdateFootprintState(int32 SlotIndex, const FIntPoint& Footprint, uint8 Flag)
+    {
+        UpdateSlotState(SlotIndex, Flag);
+    }
+
+    /**
+     * 获取区域覆盖的所有槽位索引
+     * 
+     * @return 区域超出容器范围时返回false
+     */
+    virtual bool GetFootprintSlots(int32 SlotIndex, const FIntPoint& Footprint, TArray<int32>& OutSlots) const
+    {
+        OutSlots.Reset();
+        OutSlots.Add(SlotIndex);
+        return true;
+    }
+
+    /**
+     * 查找第一个能放下指定尺寸的位置
+     * 默认实现等同于GetRecommendedSlotIndex
+     * 
+     * @param Size 未旋转时的宽高
+     * @param bAllowRotation 是否允许旋转后放置
+     * @param bOutRotated 输出参数, 找到的位置是否需要旋转
+     * @return 左上角槽位索引, 没有可用位置时返回-1
+     */
+    virtual int32 FindFirstFit(const FIntPoint& Size, bool bAllowRotation, bool& bOutRotated) const
+    {
+        bOutRotated = false;
+        return GetRecommendedSlotIndex();
+    }
+
+    /**
+     * 为物品自动选择放置位置, 调用方无需逐个探测槽位
+     * 默认实现等同于FindFirstFit, 固定槽位容器会按物品标签选择兼容的槽位
+     * 
+     * @param Size 未旋转时的宽高
+     * @param ItemTags 物品的标签
+     * @param bAllowRotation 是否允许旋转后放置
+     * @param bOutRotated 输出参数, 找到的位置是否需要旋转
+     * @return 左上角槽位索引, 没有可用位置时返回-1
+     */
+    virtual int32 FindPlacement(const FIntPoint& Size, const FGameplayTagContainer& ItemTags, bool bAllowRotation, bool& bOutRotated) const
+    {
+        return FindFirstFit(Size, bAllowRotation, bOutRotated);
+    }
+
+    /**
+     * 槽位是否独占
+     * 独占时同一槽位只能放置一个物品, 批量操作据此检查批次内的槽位冲突
+     * 
+     * @return 是否独占
+     */
+    virtual bool IsSlotExclusive() const { return true; }
+
+    /**
+     * 序列化槽位占用状态, 用于物品系统快照
+     * 加载时要求空间管理器已按相同配置初始化, 数据与当前配置不符时设置Ar的错误标记, 不修改当前状态
+     */
+    virtual void SerializeOccupancy(FArchive& Ar) {}
+
+    /**
+     * 检查保存的占用状态能否按当前配置恢复, 只读取数据, 不修改当前状态
+     * 物品系统在替换任何状态之前用它校验快照
+     */
+    virtual bool CanRestoreOccupancy(FArchive& Ar) const { return true; }
+
+    /**
+     * 清空所有槽位的占用状态, 之后由调用方按物品逐个重新占用
+     */
+    virtual void ResetOccupancy() {}
 }; 
\ No newline at end of file
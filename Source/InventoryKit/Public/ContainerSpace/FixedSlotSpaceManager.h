@@ -31,6 +31,18 @@ private:
      */
     UPROPERTY()
     TMap<int32, uint8> SlotFlags;
+
+    /**
+     * 槽位类型 -> 该类型的所有槽位, 按索引升序
+     * 自动放置时只检查与物品标签兼容的类型下的槽位, 无需遍历所有槽位; 没有类型的通用槽位以空标签为键
+     */
+    TMap<FGameplayTag, TArray<int32>> SlotsByType;
+
+    // 在指定类型的槽位中查找索引最小的空闲槽位, 找不到时返回-1
+    int32 FindFreeSlotOfType(const FGameplayTag& SlotType) const;
+
+    // 读取保存的槽位状态并校验槽位都存在, 不修改当前状态
+    bool ReadOccupancy(FArchive& Ar, TMap<int32, uint8>& OutFlags) const;
     
 public:
     // 构造函数
@@ -46,6 +58,10 @@ public:
     virtual int32 GetSlotIndexByTag(const FGameplayTag& SlotTag) const override;
     virtual int32 GetSlotIndexByXY(int32 X, int32 Y) const override;
     virtual void UpdateSlotState(int32 SlotIndex, uint8 Flag) override;
+    virtual int32 FindPlacement(const FIntPoint& Size, const FGameplayTagContainer& ItemTags, bool bAllowRotation, bool& bOutRotated) const override;
+    virtual void SerializeOccupancy(FArchive& Ar) override;
+    virtual bool CanRestoreOccupancy(FArchive& Ar) const override;
+    virtual void ResetOccupancy() override;
     //~ End UContainerSpaceManager Interface
     
     /**
@@ -23,11 +23,42 @@ private:
     // 网格高度
     int32 GridHeight;
 
+    // 每行占用的64位字数量
+    int32 WordsPerRow;
+
     /**
-     * 槽位状态数组 -- 0表示可用，1表示被占用 Todo: 其他各种概念视情况添加
+     * 槽位占用位图 -- 按行存储, 每行WordsPerRow个字, 位为0表示可用，1表示被占用
+     * 行尾超出网格宽度的填充位始终为1, 查找空位时无需额外掩码
      * 只通过持有者的Add or Remove 函数进行更新
      */
-    TArray<uint8> SlotFlags;
+    TArray<uint64> OccupancyWords;
+
+    // 每行空闲槽位数量, 查找空位时跳过已满的行
+    TArray<int32> RowFreeCounts;
+
+    // 第一个有空闲槽位的行, 之前的行都已占满; 全部占满时为GridHeight
+    int32 FirstFreeRow;
+
+    // 从FirstFreeRow开始跳过已占满的行
+    void AdvanceFirstFreeRow();
+
+    // 槽位是否被占用, 调用方保证索引有效
+    bool IsSlotOccupied(int32 SlotIndex) const;
+
+    // 第WordIndex个字中覆盖行内[BeginX, EndX)的位掩码
+    static uint64 MakeRowMask(int32 WordIndex, int32 BeginX, int32 EndX);
+
+    // 在一行位图中从StartX开始查找第一个值为bSet的位, 找不到时返回WordsPerRow * 64
+    int32 FindNextBit(const uint64* RowWords, int32 StartX, bool bSet) const;
+
+    // 在一行位图中查找第一段长度不小于Width的空闲区间, 返回区间起点X
+    int32 FindFreeRun(const uint64* RowWords, int32 Width) const;
+
+    // 查找第一个能放下Footprint(已考虑旋转)的左上角槽位
+    int32 FindFirstFitForFootprint(const FIntPoint& Footprint) const;
+
+    // 读取保存的位图和行空闲计数并校验与当前网格一致, 不修改当前状态
+    bool ReadOccupancy(FArchive& Ar, TArray<uint64>& OutWords, TArray<int32>& OutRowFreeCounts) const;
     
 public:
     // 构造函数
@@ -43,7 +74,24 @@ public:
     virtual int32 GetSlotIndexByTag(const FGameplayTag& SlotTag) const override;
     virtual int32 GetSlotIndexByXY(int32 X, int32 Y) const override;
     virtual void UpdateSlotState(int32 SlotIndex, uint8 Flag) override;
+    virtual bool IsFootprintAvailable(int32 SlotIndex, const FIntPoint& Footprint, int32 IgnoreSlotIndex = INDEX_NONE, const FIntPoint& IgnoreFootprint = FIntPoint(1, 1)) const override;
+    virtual void UpdateFootprintState(int32 SlotIndex, const FIntPoint& Footprint, uint8 Flag) override;
+    virtual bool GetFootprintSlots(int32 SlotIndex, const FIntPoint& Footprint, TArray<int32>& OutSlots) const override;
+    virtual int32 FindFirstFit(const FIntPoint& Size, bool bAllowRotation, bool& bOutRotated) const override;
+    virtual void SerializeOccupancy(FArchive& Ar) override;
+    virtual bool CanRestoreOccupancy(FArchive& Ar) const override;
+    virtual void ResetOccupancy() override;
     //~ End UContainerSpaceManager Interface
+
+    /**
+     * 检查尺寸为Footprint的物品能否以(X, Y)为左上角放置
+     * 
+     * @param X 左上角X坐标
+     * @param Y 左上角Y坐标
+     * @param Footprint 占用宽高(已考虑旋转)
+     * @return 是否可以放置
+     */
+    bool CanPlaceAt(int32 X, int32 Y, const FIntPoint& Footprint) const;
     
     /**
      * 获取网格尺寸
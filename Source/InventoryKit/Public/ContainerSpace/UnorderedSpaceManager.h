@@ -36,6 +36,10 @@ public:
     virtual int32 GetSlotIndexByTag(const FGameplayTag& SlotTag) const override;
     virtual int32 GetSlotIndexByXY(int32 X, int32 Y) const override;
     virtual void UpdateSlotState(int32 SlotIndex, uint8 Flag) override;
+    virtual bool IsSlotExclusive() const override;
+    virtual void SerializeOccupancy(FArchive& Ar) override;
+    virtual bool CanRestoreOccupancy(FArchive& Ar) const override;
+    virtual void ResetOccupancy() override;
     //~ End UContainerSpaceManager Interface
     
     /**
@@ -6,13 +6,15 @@
 #include "Components/ActorComponent.h"
 #include "Interfaces/ContainerInterfaces.h"
 #include "Core/InventoryKitTypes.h"
+#include "Core/InventoryKitReplication.h"
 #include "InventoryKitBaseContainerComponent.generated.h"
 
 // 前向声明
 class UContainerSpaceManager;
+class UInventoryKitItemSystem;
 
 // 容器变更事件委托
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnContainerChanged);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnContainerChanged, const FContainerChangeSet&, ChangeSet);
 
 /**
  * 基础容器组件
@@ -30,9 +32,14 @@ public:
     // 构造函数
     UInventoryKitBaseContainerComponent();
 
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
     // 组件初始化
     virtual void BeginPlay() override;
+
+    // 组件结束时注销容器
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     
     // 背包唯一标识
     UPROPERTY(BlueprintReadOnly, Category = "InventoryKit")
@@ -40,28 +47,85 @@ protected:
     
     // 物品ID缓存
     UPROPERTY()
-    TArray<int32> ItemIDs;
+    FInventoryKitItemIdSet ItemIDs;
     
     // 容器配置
     UPROPERTY(EditAnywhere, Category = "InventoryKit|Configuration")
     FContainerSpaceConfig SpaceConfig;
+
+    // 快照和日志中标识容器的持久化标识, 为空时使用组件在世界中的路径; 运行时生成的容器需要自行指定
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryKit|Configuration")
+    FString PersistentKey;
+
+    // 组件结束时容器内物品的处理方式, 转交需要指定接收容器, 此处按移入虚空处理
+    UPROPERTY(EditAnywhere, Category = "InventoryKit|Configuration")
+    EInventoryKitOrphanPolicy OrphanPolicy = EInventoryKitOrphanPolicy::MoveToVoid;
     
     // 容器空间管理器
     UPROPERTY()
     TObjectPtr<UContainerSpaceManager> SpaceManager;
 
+    // 直接存放的物品的负重和体积, 随物品进出增量维护
+    FInventoryKitLoad CurrentLoad;
+
+    // 嵌套子容器内容的负重和体积, 由物品系统通过AddNestedLoad维护
+    FInventoryKitLoad NestedLoad;
+
+    // 所属物品系统, 用于查询物品的负重和体积
+    TWeakObjectPtr<UInventoryKitItemSystem> OwningItemSystem;
+
+    // 尚未广播的变更
+    FInventoryKitContainerChangeJournal ChangeJournal;
+
+    // 同步到客户端的物品, 只由服务端修改
+    UPROPERTY(Replicated)
+    FInventoryKitReplicatedItemArray ReplicatedItems;
+
+    // 客户端: 已应用的物品状态, 用于释放物品变化前占用的槽位
+    TMap<int32, FItemBaseInstance> ReplicatedItemCache;
+
+    // 客户端: 本次网络更新收到的变化, 在OnReplicatedItemsReceived中统一应用
+    TArray<FItemBaseInstance> PendingReplicatedAdds;
+    TArray<FItemBaseInstance> PendingReplicatedChanges;
+    TArray<FItemBaseInstance> PendingReplicatedRemoves;
+
+    // 是否由当前端维护同步数据
+    bool IsReplicationAuthority() const;
+
+    // 物品(含堆叠数量)的负重和体积
+    FInventoryKitLoad GetItemLoad(const FItemBaseInstance& InItem) const;
+
+    // 总负重和体积是否在配置的上限内
+    bool IsWithinLoadLimits(const FInventoryKitLoad& TotalLoad) const;
+
+    // 记录物品占用的槽位为脏槽位
+    void RecordDirtyFootprint(int32 SlotIndex, const FIntPoint& Footprint);
+
+public:
+    // 容器变更事件, 同一广播周期内的变更会合并后广播一次
+    UPROPERTY(BlueprintAssignable, Category = "InventoryKit")
+    FOnContainerChanged OnContainerChanged;
+
 public:
     //~ Begin IInventoryKitContainerInterface
     virtual void InitContainer(int32 InContainerID) override;
     virtual const int32 GetContainerID() const override;
+    virtual FString GetPersistentKey() const override;
     virtual bool CanAddItem(const FItemBaseInstance& InItem, int32 DstSlotIndex) override;
     virtual bool CanMoveItem(const FItemBaseInstance& InItem, int32 DstSlotIndex) override;
+    virtual bool CanAddItemStaged(const FItemBaseInstance& InItem, int32 DstSlotIndex, const FInventoryKitStagedContainerDelta& Staged) override;
+    virtual bool CanMoveItemStaged(const FItemBaseInstance& InItem, int32 DstSlotIndex, const FInventoryKitStagedContainerDelta& Staged) override;
     virtual void OnItemAdded(const FItemBaseInstance& InItem) override;
     virtual void OnItemMoved(const FItemLocation& OldLocation, const FItemBaseInstance& InItem) override;
     virtual void OnItemRemoved(const FItemBaseInstance& InItem) override;
+    virtual void OnItemsAdded(TConstArrayView<FItemBaseInstance> InItems) override;
+    virtual void OnItemsMoved(TConstArrayView<FItemLocation> OldLocations, TConstArrayView<FItemBaseInstance> InItems) override;
+    virtual void OnItemsRemoved(TConstArrayView<FItemBaseInstance> InItems) override;
     virtual const TArray<int32>& GetAllItems() const override;
     virtual UContainerSpaceManager* GetSpaceManager() override;
-    //~ End IInventoryKitContainerInterface
+    virtual UContainerSpaceManager* ReleaseSpaceManager() override;
+    virtual void OnItemQuantityChanged(const FItemBaseInstance& InItem, int32 OldQuantity) override;
+    virtual void FlushPendingChanges() override;
     
     /**
      * 检查背包是否包含指定物品
@@ -70,5 +134,60 @@ public:
      * @return 是否包含此物品
      */
     UFUNCTION(BlueprintCallable, Category = "InventoryKit")
-    bool ContainsItem(int32 ItemId) const;
+    virtual bool ContainsItem(int32 ItemId) const override;
+    virtual void RestoreContents(TConstArrayView<int32> InItemIds) override;
+    virtual bool CanAcceptLoad(const FInventoryKitLoad& AdditionalLoad) const override;
+    virtual int32 GetAcceptableQuantity(const FInventoryKitLoad& UnitLoad, int32 MaxQuantity) const override;
+    virtual FInventoryKitLoad GetCurrentLoad() const override
+    {
+        return CurrentLoad + NestedLoad;
+    }
+    virtual void AddNestedLoad(const FInventoryKitLoad& Delta) override
+    {
+        NestedLoad += Delta;
+    }
+    virtual void ResetNestedLoad() override
+    {
+        NestedLoad = FInventoryKitLoad();
+    }
+    //~ End IInventoryKitContainerInterface
+
+    // 当前负重, 包含嵌套子容器的内容
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    float GetCurrentWeight() const
+    {
+        return static_cast<float>(GetCurrentLoad().Weight);
+    }
+
+    // 当前体积, 包含嵌套子容器的内容
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    float GetCurrentVolume() const
+    {
+        return static_cast<float>(GetCurrentLoad().Volume);
+    }
+
+    /**
+     * 设置空间配置
+     * 需在容器注册前调用, 注册后修改不会重新创建空间管理器
+     */
+    void SetSpaceConfig(const FContainerSpaceConfig& InConfig)
+    {
+        SpaceConfig = InConfig;
+    }
+
+    // 设置持久化标识, 运行时生成的容器需在注册前设置
+    void SetPersistentKey(const FString& InPersistentKey)
+    {
+        PersistentKey = InPersistentKey;
+    }
+
+    // 客户端: 由FInventoryKitReplicatedItemArray在收到同步数据时调用
+    void OnReplicatedItemAdded(const FItemBaseInstance& InItem);
+    void OnReplicatedItemChanged(const FItemBaseInstance& InItem);
+    void OnReplicatedItemRemoved(const FItemBaseInstance& InItem);
+    void OnReplicatedItemsReceived();
+
+protected:
+    // 基于事务暂存状态检查物品占用的所有槽位是否可用
+    bool IsFootprintAvailableStaged(int32 SlotIndex, const FIntPoint& Footprint, const FInventoryKitStagedContainerDelta& Staged) const;
 };
\ No newline at end of file
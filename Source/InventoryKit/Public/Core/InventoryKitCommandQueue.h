@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/InventoryKitTransaction.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include <atomic>
+
+/**
+ * 异步命令的执行结果
+ */
+struct FInventoryKitCommandResult
+{
+    // 事务是否提交成功, 失败时没有任何修改
+    bool bSucceeded = false;
+
+    // 按创建序号排列的新物品ID
+    TArray<int32> CreatedItemIds;
+};
+
+/**
+ * 物品命令队列
+ * 多生产者单消费者的无锁队列: 任意线程提交事务, 由游戏线程按帧成批取出执行
+ * 结果通过TFuture返回, 或在游戏线程调用回调
+ */
+class INVENTORYKIT_API FInventoryKitCommandQueue
+{
+public:
+    using FCallback = TUniqueFunction<void(const FInventoryKitCommandResult&)>;
+
+    // 执行一条命令, 返回是否成功; 在游戏线程调用
+    using FExecuteFunc = TFunctionRef<bool(const FInventoryKitTransaction&, TArray<int32>&)>;
+
+    /**
+     * 提交事务, 可在任意线程调用
+     * 
+     * @return 命令执行后兑现的结果
+     */
+    TFuture<FInventoryKitCommandResult> Submit(FInventoryKitTransaction&& Transaction);
+
+    /**
+     * 提交事务, 可在任意线程调用
+     * 
+     * @param Callback 命令执行后在游戏线程调用
+     */
+    void Submit(FInventoryKitTransaction&& Transaction, FCallback&& Callback);
+
+    /**
+     * 取出并执行命令, 只能在消费线程调用
+     * 只处理调用时已经入队的命令, 回调中再提交的命令留到下一次处理
+     * 
+     * @param MaxCommands 最多处理的命令数量, 小于等于0时不限
+     * @return 处理的命令数量
+     */
+    int32 Drain(FExecuteFunc Execute, int32 MaxCommands = 0);
+
+    /**
+     * 以失败结果完成所有未处理的命令, 用于物品系统关闭时, 避免等待方一直阻塞
+     */
+    void CancelAll();
+
+    // 已提交但尚未处理的命令数量
+    int32 GetNumPending() const
+    {
+        return NumPending.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct FCommand
+    {
+        FInventoryKitTransaction Transaction;
+
+        // 以Future方式提交时有效
+        TUniquePtr<TPromise<FInventoryKitCommandResult>> Promise;
+
+        // 以回调方式提交时有效
+        FCallback Callback;
+
+        void Complete(FInventoryKitCommandResult&& Result);
+    };
+
+    TQueue<FCommand, EQueueMode::Mpsc> Commands;
+
+    std::atomic<int32> NumPending { 0 };
+};
@@ -0,0 +1,133 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * 物品目录中的一条定义, 只用于生成目录文件
+ */
+struct INVENTORYKIT_API FInventoryKitCatalogEntry
+{
+    int32 DefinitionID = INDEX_NONE;
+    int32 MaxStackSize = 1;
+    float Weight = 0.f;
+    float Volume = 0.f;
+    FIntPoint Size = FIntPoint(1, 1);
+    FString Name;
+    FGameplayTagContainer Tags;
+};
+
+/**
+ * 目录文件中的定长记录
+ * 直接映射到文件内容, 布局修改时需要提升FInventoryKitItemCatalog::FileVersion
+ */
+struct FInventoryKitCatalogRecord
+{
+    int32 DefinitionID;
+    int32 MaxStackSize;
+    float Weight;
+    float Volume;
+    int32 SizeX;
+    int32 SizeY;
+
+    // 名称在字符串池中的偏移, UTF-8, 以0结尾
+    uint32 NameOffset;
+
+    // 标签列表在字符串池中的偏移, 为TagCount个uint32, 每个指向一个标签名字符串
+    uint32 TagListOffset;
+    uint32 TagCount;
+    uint32 Reserved;
+
+    FIntPoint GetSize() const
+    {
+        return FIntPoint(SizeX, SizeY);
+    }
+};
+static_assert(sizeof(FInventoryKitCatalogRecord) == 40, "Catalog record layout changed, bump FInventoryKitItemCatalog::FileVersion");
+
+/**
+ * 内存映射的只读物品目录
+ * 文件由Write在构建阶段生成, 运行时直接映射, 打开时只校验文件头, 耗时与目录大小无关
+ * 记录按定义ID升序存放; 定义ID连续时直接按下标访问, 否则二分查找
+ * 文件按本机字节序写入, 需要按目标平台分别生成
+ *
+ * 文件布局: [文件头][定长记录数组][字符串池]
+ */
+class INVENTORYKIT_API FInventoryKitItemCatalog
+{
+public:
+    // "IKCT"
+    static constexpr uint32 FileMagic = 0x54434B49;
+    static constexpr int32 FileVersion = 1;
+
+    ~FInventoryKitItemCatalog();
+
+    /**
+     * 映射目录文件
+     *
+     * @return 文件不存在或格式不合法时返回空
+     */
+    static TUniquePtr<FInventoryKitItemCatalog> Open(const FString& Path);
+
+    /**
+     * 生成目录文件
+     *
+     * @param Entries 物品定义, 定义ID不能重复
+     * @return 是否写入成功
+     */
+    static bool Write(const FString& Path, TArray<FInventoryKitCatalogEntry> Entries);
+
+    /**
+     * 查找物品定义
+     *
+     * @return 记录直接指向映射内存, 目录关闭前有效; 找不到时返回nullptr
+     */
+    const FInventoryKitCatalogRecord* Find(int32 DefinitionID) const;
+
+    int32 Num() const;
+
+    // 所有记录, 按定义ID升序
+    TConstArrayView<FInventoryKitCatalogRecord> GetRecords() const;
+
+    // 名称的UTF-8视图, 不产生内存分配
+    FUtf8StringView GetNameView(const FInventoryKitCatalogRecord& Record) const;
+
+    FString GetName(const FInventoryKitCatalogRecord& Record) const;
+
+    // 读取标签, 标签未在项目中注册时忽略
+    void GetTags(const FInventoryKitCatalogRecord& Record, FGameplayTagContainer& OutTags) const;
+
+private:
+    struct FHeader
+    {
+        uint32 Magic;
+        int32 Version;
+        int32 RecordCount;
+        int32 RecordSize;
+
+        // 位0: 定义ID从第一条记录起连续递增
+        uint32 Flags;
+        uint32 Reserved;
+        uint64 RecordsOffset;
+        uint64 StringPoolOffset;
+        uint64 StringPoolSize;
+    };
+
+    static constexpr uint32 Flag_DenseIDs = 1 << 0;
+
+    FInventoryKitItemCatalog() = default;
+
+    // 字符串池中Offset处的字符串, 越界时返回空视图
+    FUtf8StringView GetPoolString(uint32 Offset) const;
+
+    TUniquePtr<IMappedFileHandle> MappedHandle;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    const FHeader* Header = nullptr;
+    const FInventoryKitCatalogRecord* Records = nullptr;
+    const uint8* StringPool = nullptr;
+};
@@ -6,10 +6,28 @@
 #include "InventoryKitBaseContainerComponent.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "Core/InventoryKitTypes.h"
+#include "Core/InventoryKitSlotMap.h"
+#include "Core/InventoryKitTransaction.h"
+#include "Core/InventoryKitJournal.h"
+#include "Core/InventoryKitItemCatalog.h"
+#include "Core/InventoryKitTagIndex.h"
+#include "Core/InventoryKitWorldView.h"
+#include "Core/InventoryKitCommandQueue.h"
 #include "InventoryKitItemSystem.generated.h"
 
 class UInventoryKitVoidContainer;
 DEFINE_LOG_CATEGORY_STATIC(LogInventoryKitSystem, Log, All);
+
+// 同一类型的空闲空间管理器
+USTRUCT()
+struct FInventoryKitSpaceManagerPool
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<TObjectPtr<UContainerSpaceManager>> FreeManagers;
+};
+
 /**
  * 物品系统抽象基类
  * 作为物品管理的核心，负责物品创建、查询、移动和销毁
@@ -21,23 +39,107 @@ class INVENTORYKIT_API UInventoryKitItemSystem : public UWorldSubsystem
     GENERATED_BODY()
     
 protected:
-    // 物品实例映射表
-    UPROPERTY()
-    TMap<int32, FItemBaseInstance> ItemMap;
+    /**
+     * 物品实例存储
+     * 物品ID即存储中的条目ID, 携带世代信息, 物品销毁后旧ID不会误命中新物品
+     */
+    TInventoryKitSlotMap<FItemBaseInstance> ItemStore;
      
     /**
      * 容器列表， 初始化时， 创建一个虚空容器， 占用第一个ID
+     * 带世代校验的稠密表, 注销容器后ID可以复用, 查找容器只需一次数组下标和世代比较
+     */
+    TInventoryKitSlotMap<IInventoryKitContainerInterface*> ContainerMap;
+
+    /**
+     * 容器 -> 物品反向索引
+     * 由MoveItem、IntervalCreateItem和UnregisterContainer维护, 查询容器内物品时无需遍历ItemStore
+     */
+    TMap<int32, FInventoryKitItemIdSet> ContainerItemIndex;
+
+    /**
+     * 未满堆叠索引: 容器ID -> 物品定义ID -> 未满的堆叠
+     * 添加可堆叠物品时优先填充这些堆叠, 无需遍历容器
+     */
+    TMap<int32, TMap<int32, FInventoryKitItemIdSet>> PartialStackIndex;
+
+    /**
+     * 容器嵌套: 容器ID -> 承载它的物品ID
+     * 容器的父容器即承载物品所在的容器, 祖先查询沿此链上溯, 耗时与嵌套深度成正比
+     */
+    TMap<int32, int32> ContainerHostItems;
+
+    // 物品ID -> 它承载的容器ID, 与ContainerHostItems互为反向索引
+    TMap<int32, int32> ItemHostedContainers;
+
+    /**
+     * 标签 -> 物品倒排索引
+     * 物品创建时按GetItemTags建立, 销毁时移除
      */
-    TMap<int32, IInventoryKitContainerInterface*> ContainerMap;
+    FInventoryKitTagIndex TagIndex;
+
+    // 从物品目录读取的定义标签缓存, 避免每次创建物品都解析标签名
+    TMap<int32, FGameplayTagContainer> DefinitionTagCache;
     
     // 虚空容器ID, 初始化系统时创建
     int32 VoidContainerID = -1;
-    
-    // 下一个可用的物品ID
-    int32 NextItemID = 0;
 
-    // 下一个可用的容器ID
-    int32 NextContainerID = 0;
+    // 虚空中的物品滞留超过该秒数后被回收, 小于等于0时不回收
+    float VoidSweepMaxAge = 0.f;
+
+    // 每帧最多检查的虚空进入记录数
+    int32 VoidSweepItemsPerFrame = 256;
+
+    // 物品ID的复用策略
+    EInventoryKitItemIdPolicy ItemIdPolicy = EInventoryKitItemIdPolicy::RecycleLatest;
+
+    // 容器变更的广播时机
+    EContainerChangeFlushPolicy ChangeFlushPolicy = EContainerChangeFlushPolicy::EndOfFrame;
+
+    // 有未广播变更的容器
+    TSet<int32> DirtyContainers;
+
+    // 帧末广播的回调句柄
+    FDelegateHandle PostActorTickHandle;
+
+    // 预写日志, 未开启时为空
+    TUniquePtr<FInventoryKitJournalWriter> JournalWriter;
+
+    // 自上次检查点起追加多少条记录后自动保存检查点, 小于等于0时不自动保存
+    int32 JournalCheckpointInterval = 0;
+
+    // 回放日志期间不再追加记录
+    bool bReplayingJournal = false;
+
+    // 最近加载的快照及回放中的日志里的容器ID到当前容器ID的映射, 容器ID随注册顺序分配, 重启后可能不同
+    TMap<int32, int32> PersistedContainerRemap;
+
+    // 只读物品目录, 未加载时为空
+    TUniquePtr<FInventoryKitItemCatalog> ItemCatalog;
+
+    // 是否在帧末发布世界视图
+    bool bPublishWorldView = false;
+
+    // 最近一次发布的世界视图, 未开启发布时为空
+    TSharedPtr<const FInventoryKitWorldView, ESPMode::ThreadSafe> WorldView;
+
+    // 自上次发布以来有变化的物品, 所在容器的内容随之重新发布
+    TSet<int32> ViewDirtyItems;
+
+    // 自上次发布以来注销的容器
+    TSet<int32> ViewDirtyContainers;
+
+    // 容器嵌套关系自上次发布以来是否有变化
+    bool bViewHostLinksDirty = false;
+
+    // 下次发布时是否需要完整重建, 如开启发布或加载快照后
+    bool bViewNeedsRebuild = true;
+
+    // 其他线程提交的命令, 帧末统一执行
+    FInventoryKitCommandQueue CommandQueue;
+
+    // 每帧最多执行的命令数量, 小于等于0时不限
+    int32 MaxCommandsPerFrame = 0;
     
 public:
     // 初始化
@@ -56,17 +158,254 @@ public:
     /**
      * 移动物品
      * 基础实现：更新位置映射并触发事件
+     * 承载容器的物品不能移入该容器内部; 目标容器的祖先容器也要能承受物品及其承载容器的负重
      */
     UFUNCTION(BlueprintCallable, Category = "InventoryKit")
     virtual bool MoveItem(int32 ItemId, const FItemLocation& TargetLocation);
+
+    /**
+     * 批量移动物品
+     * 先对整个批次做一次校验, 任一失败则不做任何修改
+     * 校验按整批应用后的状态进行: 批次内所有物品的原位置先释放, 因此容器内互换位置、腾出后再占用的槽位和容量都能通过
+     * 通过后统一更新位置, 每个涉及的容器只收到一次批量添加/移动/移除通知
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual bool MoveItems(const TArray<FItemMoveRequest>& Requests);
+
+    /**
+     * 设置物品旋转状态
+     * 旋转后宽高互换, 新的占用区域必须在当前容器中可用
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual bool SetItemRotated(int32 ItemId, bool bInRotated);
+
+    /**
+     * 合并堆叠
+     * 将源堆叠尽可能多地并入目标堆叠, 源堆叠数量归零时销毁
+     * 
+     * @return 是否有数量被合并
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual bool MergeStacks(int32 SourceItemId, int32 TargetItemId);
+
+    /**
+     * 拆分堆叠
+     * 从指定堆叠中分出Count个, 作为新物品放到目标位置
+     * 
+     * @return 新物品ID, 失败时返回-1
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual int32 SplitStack(int32 ItemId, int32 Count, const FItemLocation& TargetLocation);
+
+    /**
+     * 向容器添加Count个指定定义的物品
+     * 优先通过未满堆叠索引填充已有堆叠, 剩余部分在推荐槽位上创建新堆叠
+     * 
+     * @return 实际添加的数量, 容器放不下时小于Count
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual int32 AddStackableItems(int32 DefinitionID, int32 Count, int32 ContainerID);
+
+    /**
+     * 销毁物品, 通知所在容器后释放存储条目
+     * 
+     * @return 物品不存在时返回false
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual bool DestroyItem(int32 ItemId);
+
+    /**
+     * 批量销毁物品, 每个涉及的容器只收到一次批量移除通知
+     * 
+     * @return 实际销毁的数量, 不存在的物品被跳过
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    int32 DestroyItems(const TArray<int32>& ItemIds);
+
+    /**
+     * 设置虚空容器的定时回收
+     * 物品在虚空中滞留超过MaxAgeSeconds秒后, 在帧末按进入顺序分批销毁
+     * 每帧最多检查ItemsPerFrame条进入记录, 已离开虚空的物品留下的记录也计入, 单帧耗时有上限
+     * 
+     * 关闭回收时不记录进入时间; 开启时虚空中已有的物品从此刻开始计时
+     * 
+     * @param MaxAgeSeconds 小于等于0时关闭回收
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    void SetVoidSweep(float MaxAgeSeconds, int32 ItemsPerFrame = 256);
+
+    /**
+     * 把物品移动到容器中自动选择的位置
+     * 由容器的空间管理器按物品占用尺寸和标签选择槽位, 调用方无需逐个探测; 物品已在该容器中时不移动
+     * 
+     * @return 是否移动成功
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    virtual bool MoveItemToContainer(int32 ItemId, int32 ContainerID);
+
+    /**
+     * 依次把多个物品移动到容器中自动选择的位置, 用于自动拾取等场景
+     * 每个物品单独校验, 放不下的物品保持原位
+     * 
+     * @return 成功移动的物品ID
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    TArray<int32> MoveItemsToContainer(const TArray<int32>& ItemIds, int32 ContainerID);
+
+    /**
+     * 整理容器: 按默认顺序(定义ID升序, 同定义数量多的在前)重新放置所有物品
+     * 
+     * @return 是否整理成功, 放不下时不做任何修改
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool SortContainer(int32 ContainerID);
+
+    /**
+     * 紧凑容器: 保持物品当前的先后顺序, 把物品依次放到最靠前的空位, 消除空隙
+     * 
+     * @return 是否成功, 放不下时不做任何修改
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool CompactContainer(int32 ContainerID);
+
+    /**
+     * 按自定义顺序整理容器
+     * 先在空间管理器上按顺序计算所有物品的新位置, 再一次性应用整个重排, 不逐个校验移动;
+     * 容器只收到一次批量移动通知, 槽位先全部释放再全部占用, 中间不会出现冲突
+     * 非独占槽位的容器(如无序容器)没有位置可整理, 直接返回true
+     * 
+     * @param Predicate 返回A是否应排在B之前, 相等的物品保持当前顺序
+     * @return 是否整理成功, 放不下时不做任何修改
+     */
+    bool SortContainerBy(int32 ContainerID, TFunctionRef<bool(const FItemBaseInstance&, const FItemBaseInstance&)> Predicate);
+
+    /**
+     * 获取物品定义的最大堆叠数量
+     * 基础实现：从物品目录读取, 没有目录或目录中没有该定义时不可堆叠, 项目可根据物品定义重写
+     */
+    virtual int32 GetMaxStackSize(int32 DefinitionID) const
+    {
+        const FInventoryKitCatalogRecord* Record = ItemCatalog ? ItemCatalog->Find(DefinitionID) : nullptr;
+        return Record ? Record->MaxStackSize : 1;
+    }
+
+    /**
+     * 获取物品(含堆叠数量)的负重和体积
+     * 基础实现：从物品目录读取单位负重和体积并乘以堆叠数量, 没有目录时为0
+     * 重写时需保证同一物品在进出容器之间返回相同的值, 容器依此增量维护当前负重
+     */
+    virtual FInventoryKitLoad GetItemLoad(const FItemBaseInstance& Item) const
+    {
+        const FInventoryKitCatalogRecord* Record = ItemCatalog ? ItemCatalog->Find(Item.DefinitionID) : nullptr;
+        return Record ? FInventoryKitLoad(Record->Weight, Record->Volume) * Item.Quantity : FInventoryKitLoad();
+    }
+
+    /**
+     * 获取物品的标签
+     * 基础实现：从物品目录读取定义的标签, 项目可重写以加入实例标签
+     * 重写时需保证同一物品在创建到销毁之间返回相同的标签, 标签索引依此移除物品
+     */
+    virtual void GetItemTags(const FItemBaseInstance& Item, FGameplayTagContainer& OutTags) const;
+
+    /**
+     * 查询带有指定标签(含子标签)的物品
+     * 
+     * @param ContainerID 限定容器, -1表示所有物品
+     * @param bRecursive 是否包含嵌套子容器中的物品
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    TArray<int32> FindItemsWithTag(FGameplayTag Tag, int32 ContainerID = -1, bool bRecursive = false) const;
+
+    /**
+     * 查询匹配标签查询的物品
+     * 按标签倒排索引求值, 结果再与容器范围求交; 查询含有精确匹配等索引不支持的表达式时退回逐个匹配
+     * 
+     * @param ContainerID 限定容器, -1表示所有物品
+     * @param bRecursive 是否包含嵌套子容器中的物品
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    TArray<int32> QueryItems(const FGameplayTagQuery& Query, int32 ContainerID = -1, bool bRecursive = false) const;
+
+    /**
+     * 容器(默认含嵌套子容器)中是否有匹配标签查询的物品, 找到第一个即返回
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool HasItemMatchingQuery(const FGameplayTagQuery& Query, int32 ContainerID, bool bRecursive = true) const;
+
+    /**
+     * 加载内存映射的物品目录, 替换已加载的目录
+     * 
+     * @param Path 由FInventoryKitItemCatalog::Write生成的目录文件
+     * @return 是否加载成功
+     */
+    bool LoadItemCatalog(const FString& Path);
+
+    // 当前物品目录, 未加载时返回nullptr
+    const FInventoryKitItemCatalog* GetItemCatalog() const
+    {
+        return ItemCatalog.Get();
+    }
+
+    /**
+     * 提交事务
+     * 先基于暂存状态按顺序校验所有步骤, 校验期间不修改物品和容器; 全部通过后再依次执行
+     * 
+     * @param Transaction 要提交的事务
+     * @param OutCreatedItemIds 可选, 按创建序号输出新物品ID
+     * @return 是否提交成功, 失败时没有任何修改
+     */
+    virtual bool CommitTransaction(const FInventoryKitTransaction& Transaction, TArray<int32>* OutCreatedItemIds = nullptr);
+
+    /**
+     * 从任意线程提交事务
+     * 事务进入无锁队列, 在游戏线程的帧末(广播容器变更之前)按提交顺序执行
+     * 提交方需保证物品系统在命令执行前仍然存在; 系统关闭时未执行的命令以失败结果完成
+     * 
+     * @return 执行后兑现的结果
+     */
+    TFuture<FInventoryKitCommandResult> EnqueueTransaction(FInventoryKitTransaction Transaction)
+    {
+        return CommandQueue.Submit(MoveTemp(Transaction));
+    }
+
+    /**
+     * 从任意线程提交事务, 执行后在游戏线程调用回调
+     */
+    void EnqueueTransaction(FInventoryKitTransaction Transaction, FInventoryKitCommandQueue::FCallback Callback)
+    {
+        CommandQueue.Submit(MoveTemp(Transaction), MoveTemp(Callback));
+    }
+
+    /**
+     * 立即执行已提交的命令, 只能在游戏线程调用
+     * 
+     * @return 执行的命令数量
+     */
+    int32 ProcessCommandQueue();
+
+    /**
+     * 设置每帧最多执行的命令数量, 超出的命令留到之后的帧
+     * 
+     * @param InMaxCommands 小于等于0时不限
+     */
+    void SetMaxCommandsPerFrame(int32 InMaxCommands)
+    {
+        MaxCommandsPerFrame = InMaxCommands;
+    }
     
     /**
      * 查询指定容器中的所有物品
-     * 基础实现：遍历位置映射表
+     * 基础实现：拷贝容器反向索引
      */
     UFUNCTION(BlueprintCallable, Category = "InventoryKit")
     virtual TArray<int32> GetItemsInContainer(int32 Identifier) const;
 
+    /**
+     * 查询指定容器中的所有物品, 不产生内存分配
+     * 返回的视图在下一次修改该容器内容前有效
+     */
+    TConstArrayView<int32> GetItemsInContainerView(int32 Identifier) const;
+
     /**
      * 获取物品数据
      * 基础实现：直接从映射表中获取
@@ -82,20 +421,235 @@ public:
 
     /**
      * 注销容器
+     * 容器内的物品按OrphanPolicy整体处理, 注销后不会有物品指向失效的容器ID; 耗时只与容器内物品数量相关
+     * 
      * @param InContainer 
+     * @param OrphanPolicy 内部物品的处理方式
+     * @param HandOffContainerID OrphanPolicy为HandOff时接收物品的容器
+     */
+    void UnregisterContainer(IInventoryKitContainerInterface* InContainer,
+                             EInventoryKitOrphanPolicy OrphanPolicy = EInventoryKitOrphanPolicy::MoveToVoid,
+                             int32 HandOffContainerID = -1);
+
+    /**
+     * 取出一个按配置初始化好的空间管理器, 池中没有同类型的空闲对象时才创建新对象
+     * 容器在InitContainer中调用, 注销时通过ReleaseSpaceManager交还
+     */
+    UContainerSpaceManager* AcquireSpaceManager(const FContainerSpaceConfig& InConfig);
+
+    /**
+     * 预先创建空间管理器放入池中, 之后注册的容器不再需要创建对象
+     * 按配置初始化, 网格等容器的槽位数组会预先分配到对应大小
+     * 
+     * @param Count 预先创建的数量
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    void PrewarmSpaceManagers(const FContainerSpaceConfig& InConfig, int32 Count);
+
+    // 池中空闲的空间管理器数量
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    int32 GetNumPooledSpaceManagers() const;
+
+    /**
+     * 设置物品ID的复用策略, 对之后创建的物品生效
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    void SetItemIdPolicy(EInventoryKitItemIdPolicy InPolicy);
+
+    EInventoryKitItemIdPolicy GetItemIdPolicy() const
+    {
+        return ItemIdPolicy;
+    }
+
+    // 物品ID分配统计, 用于预估内存和监控ID空间
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    FInventoryKitItemIdStats GetItemIdStats() const;
+
+    /**
+     * 预先分配物品存储, 避免创建大量物品时多次扩容
+     * 
+     * @param NumItems 预计同时存活的物品数量
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    void ReserveItems(int32 NumItems);
+
+    /**
+     * 设置容器变更的广播时机
+     * 切换到Immediate时会先广播已积累的变更
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    void SetChangeFlushPolicy(EContainerChangeFlushPolicy InPolicy);
+
+    EContainerChangeFlushPolicy GetChangeFlushPolicy() const
+    {
+        return ChangeFlushPolicy;
+    }
+
+    /**
+     * 广播所有容器积累的变更
+     * 每个容器在一个广播周期内只广播一次OnContainerChanged
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    void FlushContainerChanges();
+
+    /**
+     * 保存物品系统快照
+     * 物品按列整块写出, 并包含各容器空间管理器的槽位占用和容器挂接关系
+     * 
+     * @param OutData 输出的快照数据
+     * @return 是否保存成功
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool SaveSnapshot(TArray<uint8>& OutData);
+
+    /**
+     * 加载物品系统快照, 替换当前所有物品, 物品ID与保存时相同
+     * 保存时的容器按持久化标识映射到当前注册的容器, 找不到对应容器的物品移入虚空
+     * 头部或物品数据不合法时返回false且不修改任何状态; 单个容器的占用与当前配置不符或快照中缺失时, 按恢复到该容器的物品重建占用
+     * 
+     * @param InData 快照数据
+     * @return 是否加载成功
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool LoadSnapshot(const TArray<uint8>& InData);
+
+    /**
+     * 开启预写日志
+     * 开启时立即保存一次检查点, 之后的创建、移动、销毁、数量和旋转变化都会追加到日志, 每帧末由后台线程成批写入
+     * 
+     * @param JournalPath 日志文件路径
+     * @param CheckpointPath 检查点(快照)文件路径
+     * @param CheckpointInterval 追加多少条记录后自动保存检查点并清空日志, 小于等于0时只在手动调用时保存
+     * @return 是否开启成功
      */
-    void UnregisterContainer(IInventoryKitContainerInterface* InContainer);
+    bool OpenJournal(const FString& JournalPath, const FString& CheckpointPath, int32 CheckpointInterval = 10000);
+
+    /**
+     * 关闭预写日志, 等待所有记录写入完成
+     */
+    void CloseJournal();
+
+    /**
+     * 保存检查点并清空日志
+     */
+    void CheckpointJournal();
+
+    /**
+     * 从检查点和日志恢复物品系统
+     * 先加载检查点快照, 再按顺序回放日志中的完整记录; 需要在开启日志前、所有容器注册后调用
+     * 日志基于更早的检查点时(检查点写入后、日志清空前崩溃), 其中的记录已包含在检查点中, 不再回放
+     * 回放中途失败时已回放的部分不会撤销
+     * 
+     * @return 是否恢复成功
+     */
+    bool RecoverFromJournal(const FString& JournalPath, const FString& CheckpointPath);
 
     int32 GetVoidContainerID() const
     {
         return VoidContainerID;
     }
 
-    const TMap<int32, IInventoryKitContainerInterface*>& GetContainerMap() const
+    const TInventoryKitSlotMap<IInventoryKitContainerInterface*>& GetContainerMap() const
     {
         return ContainerMap;
     }
 
+    // 查找已注册的容器, ID未注册或已失效时返回nullptr
+    IInventoryKitContainerInterface* FindContainer(int32 ContainerID) const
+    {
+        IInventoryKitContainerInterface* const* Container = ContainerMap.Find(ContainerID);
+        return Container ? *Container : nullptr;
+    }
+
+    /**
+     * 把容器挂接到物品上, 容器成为该物品所在容器的子容器, 其内容的负重计入所有祖先容器
+     * 一个物品只能承载一个容器, 一个容器只能挂接到一个物品; 物品位于该容器内部(含间接)时拒绝, 避免形成环
+     * 
+     * @return 是否挂接成功, 已挂接到同一物品时视为成功
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool AttachContainerToItem(int32 ContainerID, int32 HostItemId);
+
+    /**
+     * 解除容器与承载物品的挂接, 容器成为顶层容器
+     * 承载物品被销毁或容器注销时自动解除
+     * 
+     * @return 容器之前是否已挂接
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    bool DetachContainer(int32 ContainerID);
+
+    // 承载容器的物品ID, 未挂接时返回-1
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    int32 GetHostItemID(int32 ContainerID) const;
+
+    // 物品承载的容器ID, 没有时返回-1
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    int32 GetHostedContainerID(int32 ItemId) const;
+
+    /**
+     * 获取父容器, 即承载物品所在的容器
+     * 
+     * @return 父容器ID, 顶层容器或父容器未注册时返回-1
+     */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    int32 GetParentContainerID(int32 ContainerID) const;
+
+    /**
+     * 容器是否直接或间接嵌套在祖先容器内部, 耗时与嵌套深度成正比
+     */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    bool IsContainerInside(int32 ContainerID, int32 AncestorID) const;
+
+    /**
+     * 获取物品所在的顶层容器, 耗时与嵌套深度成正比
+     * 
+     * @return 顶层容器ID, 物品不存在时返回-1
+     */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    int32 GetTopLevelContainerID(int32 ItemId) const;
+
+    /**
+     * 获取物品所在顶层容器的所属Actor
+     * 
+     * @return 顶层容器不是Actor组件时返回nullptr
+     */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "InventoryKit")
+    AActor* GetTopLevelOwner(int32 ItemId) const;
+
+    /**
+     * 查询容器及其所有嵌套子容器中的物品
+     * 按容器逐层展开反向索引, 耗时与结果数量成正比
+     */
+    UFUNCTION(BlueprintCallable, Category = "InventoryKit")
+    TArray<int32> GetItemsInContainerRecursive(int32 ContainerID) const;
+
+    /**
+     * 开启或关闭世界视图发布
+     * 开启后每帧末尾发布一次只读视图, 供工作线程无锁查询; 关闭时释放视图
+     */
+    void SetWorldViewPublishing(bool bEnabled);
+
+    bool IsWorldViewPublishing() const
+    {
+        return bPublishWorldView;
+    }
+
+    /**
+     * 立即发布世界视图, 未开启发布时不做处理
+     * 只复制自上次发布以来有变化的物品块和容器, 耗时与变化量成正比
+     */
+    void PublishWorldView();
+
+    /**
+     * 获取最近一次发布的世界视图, 只能在游戏线程调用
+     * 返回的视图不可修改, 可以交给任意线程读取; 未开启发布时返回空
+     */
+    TSharedPtr<const FInventoryKitWorldView, ESPMode::ThreadSafe> GetWorldView() const
+    {
+        return WorldView;
+    }
+
 protected:
     /**
      * 创建物品
@@ -103,8 +657,199 @@ protected:
      */
     virtual int32 IntervalCreateItem(const FItemLocation& Location, bool bNotify = true);
 
+    /**
+     * 以模板创建物品
+     * 复制模板中的位置、尺寸等数据, 物品ID由系统重新分配
+     */
+    int32 IntervalCreateItemFromTemplate(FItemBaseInstance Template, bool bNotify = true);
+
+    /**
+     * 销毁物品
+     * 基础实现：通知所在容器移除, 然后释放存储条目
+     */
+    virtual bool IntervalDestroyItem(int32 ItemId, bool bNotify = true);
+
+    /**
+     * 根据物品定义生成创建模板
+     * 基础实现：设置定义ID, 加载了物品目录时从目录读取尺寸, 项目可重写以填充其他定义数据
+     */
+    virtual FItemBaseInstance MakeItemTemplate(int32 DefinitionID) const;
+
+    /**
+     * 为物品在容器中选择放置位置, 保持物品当前的旋转状态
+     * 
+     * @return 槽位索引, 没有可用位置时返回-1
+     */
+    int32 FindPlacementSlot(const FItemBaseInstance& Item, IInventoryKitContainerInterface* Container) const;
+
+    // 物品是否为未满的堆叠
+    bool IsPartialStack(const FItemBaseInstance& Item) const;
+
+    // 维护未满堆叠索引
+    void IndexPartialStack(const FItemBaseInstance& Item);
+    void UnindexPartialStack(const FItemBaseInstance& Item);
+
+    // 修改物品堆叠数量, 同时维护索引并通知容器
+    void SetItemQuantity(FItemBaseInstance& Item, int32 NewQuantity);
+
+    /**
+     * 执行已通过校验的移动: 更新位置、反向索引并通知容器
+     */
+    void ApplyMove(FItemBaseInstance& Item, const FItemLocation& TargetLocation, IInventoryKitContainerInterface* TargetContainer);
+
+    /**
+     * 应用容器内的整体重排, 调用方保证所有物品都在该容器中且新位置互不重叠
+     */
+    void ApplyRearrange(int32 ContainerID, const TArray<FItemMoveRequest>& Moves);
+
+    /**
+     * 基于暂存状态校验事务, 不修改任何状态
+     */
+    bool ValidateTransaction(const FInventoryKitTransaction& Transaction) const;
+
+    /**
+     * 标记容器有未广播的变更
+     * Immediate模式下直接广播, 其余模式等待帧末或手动广播
+     */
+    void MarkContainerDirty(int32 ContainerID);
+
+    /**
+     * 读写项目自定义的快照数据, 在物品和槽位占用之后序列化
+     * 基础实现：不做处理
+     */
+    virtual void SerializeCustomSnapshotData(FArchive& Ar) {}
+
+    // 追加一条日志记录
+    void RecordJournal(const FInventoryKitJournalRecord& Record)
+    {
+        if (JournalWriter && !bReplayingJournal)
+        {
+            JournalWriter->Append(Record);
+        }
+    }
+
+    // 回放一条日志记录
+    bool ReplayJournalRecord(const FInventoryKitJournalRecord& Record);
+
+    // 当前注册的容器按持久化标识索引, 标识为空的容器不参与
+    TMap<FString, int32> BuildContainerKeyIndex() const;
+
+    /**
+     * 日志中记录的位置映射到当前注册的容器
+     * 记录的容器已不存在时改为虚空中的位置
+     */
+    FItemLocation RemapJournalLocation(const FItemLocation& Location, const FItemBaseInstance& Item) const;
+
+    // 每帧Actor Tick结束后调用
+    void HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+    // 回收一批在虚空中滞留过久的物品
+    void SweepVoidContainer();
+
+    /**
+     * 注销容器前处理其中的物品
+     * 移出或销毁后统一通知一次原容器, 不逐个修改原容器的反向索引和堆叠索引, 由注销时整体删除
+     */
+    void ReleaseOrphanItems(int32 ContainerID, IInventoryKitContainerInterface* Container,
+                            EInventoryKitOrphanPolicy OrphanPolicy, int32 HandOffContainerID);
+
+    // 物品能否在不检查原容器的情况下放入目标容器, 返回目标槽位, 不能放入时返回INDEX_NONE
+    int32 FindOrphanPlacement(const FItemBaseInstance& Item, int32 TargetContainerID, IInventoryKitContainerInterface* TargetContainer) const;
+
+    // 记录物品有变化, 下次发布世界视图时更新所在的块
+    void MarkItemViewDirty(int32 ItemId)
+    {
+        if (bPublishWorldView)
+        {
+            ViewDirtyItems.Add(ItemId);
+        }
+    }
+
+    // 记录容器嵌套关系有变化
+    void MarkHostLinksViewDirty()
+    {
+        bViewHostLinksDirty = true;
+    }
+
+    // 按当前状态完整构建世界视图
+    void RebuildWorldView(FInventoryKitWorldView& View) const;
+
+    /**
+     * 用当前状态更新视图中的一个物品条目, 条目所在的块在本次发布中第一次修改时复制
+     * 
+     * @param OutDirtyContainers 收集物品变化前后所在的容器, 其内容需要重新发布
+     */
+    void UpdateWorldViewItem(FInventoryKitWorldView& View, TMap<int32, FInventoryKitWorldView::FItemChunk*>& CopiedChunks, int32 ItemId, TSet<int32>& OutDirtyContainers) const;
+
+    // 用当前状态更新视图中的一个容器条目, 容器已注销时清空条目; 条目所在的块在本次发布中第一次修改时复制
+    void UpdateWorldViewContainer(FInventoryKitWorldView& View, TMap<int32, FInventoryKitWorldView::FContainerChunk*>& CopiedChunks, int32 ContainerID) const;
+
+    // 容器及其祖先容器ID, 由近到远
+    using FContainerChain = TArray<int32, TInlineAllocator<8>>;
+
+    // 物品当前所在的容器, 物品不存在时返回-1
+    int32 GetItemContainerID(int32 ItemId) const;
+
+    // 物品承载的容器的总负重, 没有承载容器时为0
+    FInventoryKitLoad GetHostedLoad(int32 ItemId) const;
+
+    /**
+     * 承载HostedContainerID的物品放入TargetContainerID后是否会形成环
+     * 
+     * @param GetContainerOfItem 返回物品在待校验状态下所在的容器, 批量移动和事务借此按暂存状态检查
+     */
+    bool WouldCreateCycle(int32 HostedContainerID, int32 TargetContainerID, TFunctionRef<int32(int32)> GetContainerOfItem) const;
+
+    /**
+     * 物品从SourceContainerID移入TargetContainerID时总负重增加的容器
+     * 为目标容器及其祖先, 到与源容器祖先链(含源容器)的第一个公共容器为止, 公共部分的总负重不变
+     * 
+     * @param SourceContainerID 新创建的物品传-1
+     */
+    void GetLoadGainContainers(int32 SourceContainerID, int32 TargetContainerID, FContainerChain& OutContainers) const;
+
+    // 物品移动时总负重增加的容器能否都承受Load
+    bool CanContainersAcceptLoad(int32 SourceContainerID, int32 TargetContainerID, const FInventoryKitLoad& Load) const;
+
+    // 向容器的所有祖先累加负重变化, 容器自身的负重由其通知回调维护
+    void RollUpLoad(int32 ContainerID, const FInventoryKitLoad& Delta);
+
+    // 物品跨容器移动后, 转移它承载的容器的负重并更新两侧的祖先
+    void RollUpItemMove(const FItemBaseInstance& OldItem, int32 NewContainerID);
+
+    // 按当前的嵌套关系重新累计所有容器的嵌套负重
+    void RebuildNestedLoads();
+
+    // 维护标签倒排索引
+    void IndexItemTags(const FItemBaseInstance& Item);
+    void UnindexItemTags(const FItemBaseInstance& Item);
+
+    // 重建所有物品的标签索引
+    void RebuildTagIndex();
+
+    // 物品是否位于容器范围内, ContainerID为-1时总是成立
+    bool IsItemInScope(int32 ItemId, int32 ContainerID, bool bRecursive) const;
+
+    // 容器范围内的所有物品, ContainerID为-1时为所有物品
+    void GetItemsInScope(int32 ContainerID, bool bRecursive, TArray<int32>& OutItems) const;
+
+    /**
+     * 取出集合(bComplement为true时为集合的补集)中位于容器范围内的物品
+     * 
+     * @param OutItems 为空时只判断是否存在, 找到第一个即返回
+     * @return 是否至少有一个物品
+     */
+    bool CollectItemsInScope(const FInventoryKitItemIdSet& Items, bool bComplement, int32 ContainerID, bool bRecursive, TArray<int32>* OutItems) const;
+
+    // 逐个匹配标签查询, 用于索引不支持的查询
+    bool MatchItemsInScope(const FGameplayTagQuery& Query, int32 ContainerID, bool bRecursive, TArray<int32>* OutItems) const;
+
 private:
     // 防止GC
     UPROPERTY()
     TObjectPtr<UInventoryKitVoidContainer> VoidContainer;
+
+    // 空间管理器类 -> 空闲的空间管理器, 容器注销时放回, 注册时取出复用
+    UPROPERTY()
+    TMap<TObjectPtr<UClass>, FInventoryKitSpaceManagerPool> SpaceManagerPools;
 }; 
\ No newline at end of file
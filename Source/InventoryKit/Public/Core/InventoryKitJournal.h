@@ -0,0 +1,287 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/InventoryKitTypes.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FRunnableThread;
+class IFileHandle;
+
+/**
+ * 日志记录的操作类型
+ */
+enum class EInventoryKitJournalOp : uint8
+{
+    Create,
+    Move,
+    Destroy,
+    SetQuantity,
+    SetRotated,
+
+    // 批量移动: 之后的BatchSize条Move记录需要作为一批同时应用
+    MoveBatch,
+
+    // 容器挂接到物品上(ItemID为承载物品), 或从承载物品上解除(ItemID为INDEX_NONE)
+    AttachContainer,
+
+    // 容器内整理: 之后的BatchSize条Move记录是Location.ContainerID内的一次整体重排
+    Rearrange,
+
+    // 容器注册: Location.ContainerID分配给了持久化标识为ContainerKey的容器, 回放时据此映射到当前的容器ID
+    RegisterContainer
+};
+
+/**
+ * 一条日志记录
+ * 按操作类型只序列化用到的字段
+ */
+struct INVENTORYKIT_API FInventoryKitJournalRecord
+{
+    EInventoryKitJournalOp Op = EInventoryKitJournalOp::Move;
+
+    int32 ItemID = INDEX_NONE;
+
+    // Create、Move: 目标位置; AttachContainer: Location.ContainerID为被挂接的容器
+    FItemLocation Location;
+
+    // Create: 物品定义ID和尺寸
+    int32 DefinitionID = INDEX_NONE;
+    FIntPoint Size = FIntPoint(1, 1);
+
+    // Create、SetQuantity: 堆叠数量
+    int32 Quantity = 1;
+
+    // Create、SetRotated: 是否旋转
+    bool bRotated = false;
+
+    // MoveBatch、Rearrange: 批次内的移动数量
+    int32 BatchSize = 0;
+
+    // RegisterContainer: 容器的持久化标识
+    FString ContainerKey;
+
+    static FInventoryKitJournalRecord MakeCreate(const FItemBaseInstance& Item)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::Create;
+        Record.ItemID = Item.ItemID;
+        Record.Location = Item.ItemLocation;
+        Record.DefinitionID = Item.DefinitionID;
+        Record.Size = Item.Size;
+        Record.Quantity = Item.Quantity;
+        Record.bRotated = Item.bRotated;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeMove(int32 ItemId, const FItemLocation& TargetLocation)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::Move;
+        Record.ItemID = ItemId;
+        Record.Location = TargetLocation;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeDestroy(int32 ItemId)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::Destroy;
+        Record.ItemID = ItemId;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeSetQuantity(int32 ItemId, int32 NewQuantity)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::SetQuantity;
+        Record.ItemID = ItemId;
+        Record.Quantity = NewQuantity;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeSetRotated(int32 ItemId, bool bInRotated)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::SetRotated;
+        Record.ItemID = ItemId;
+        Record.bRotated = bInRotated;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeAttachContainer(int32 ContainerID, int32 HostItemId)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::AttachContainer;
+        Record.ItemID = HostItemId;
+        Record.Location.ContainerID = ContainerID;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeRegisterContainer(int32 ContainerID, const FString& InContainerKey)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::RegisterContainer;
+        Record.Location.ContainerID = ContainerID;
+        Record.ContainerKey = InContainerKey;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeMoveBatch(int32 InBatchSize)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::MoveBatch;
+        Record.BatchSize = InBatchSize;
+        return Record;
+    }
+
+    static FInventoryKitJournalRecord MakeRearrange(int32 ContainerID, int32 InBatchSize)
+    {
+        FInventoryKitJournalRecord Record;
+        Record.Op = EInventoryKitJournalOp::Rearrange;
+        Record.Location.ContainerID = ContainerID;
+        Record.BatchSize = InBatchSize;
+        return Record;
+    }
+
+    friend FArchive& operator<<(FArchive& Ar, FInventoryKitJournalRecord& Record);
+};
+
+/**
+ * 物品操作预写日志
+ * 游戏线程把记录追加到本帧缓冲, 帧末提交给后台线程, 后台线程成批写入文件并刷盘
+ * 提交队列有上限, 队列满时记录留在游戏线程缓冲中等待下次提交, 不会阻塞游戏线程
+ *
+ * 文件格式: 文件头[Magic][版本][检查点序号]之后是若干帧, 每帧为 [字节数][CRC][记录...]
+ * 崩溃时最后一帧可能不完整, 回放时在第一个长度或CRC不合法的帧处停止
+ *
+ * 检查点: 物品系统保存快照后交给写入线程, 写入线程先写好检查点文件, 再清空日志
+ * 检查点文件为[Magic][版本][序号][CRC][快照], 先写入.tmp再替换; 日志文件头记录它所基于的检查点序号
+ * 恢复时取序号最大的完整检查点(正式文件或.tmp), 日志序号小于检查点序号时说明其中的记录已包含在检查点中, 直接跳过
+ */
+class INVENTORYKIT_API FInventoryKitJournalWriter : public FRunnable
+{
+public:
+    // "IKJN"
+    static constexpr uint32 FileMagic = 0x4E4A4B49;
+    static constexpr int32 FileVersion = 3;
+
+    // "IKCP"
+    static constexpr uint32 CheckpointMagic = 0x50434B49;
+    static constexpr int32 CheckpointVersion = 1;
+
+    FInventoryKitJournalWriter(const FString& InJournalPath, const FString& InCheckpointPath, int32 InMaxQueuedBatches = 64);
+    virtual ~FInventoryKitJournalWriter() override;
+
+    /**
+     * 打开日志文件并启动写入线程
+     *
+     * @return 文件打开失败时返回false
+     */
+    bool Start();
+
+    /**
+     * 提交剩余记录并等待写入线程退出
+     */
+    void Shutdown();
+
+    // 追加一条记录到本帧缓冲, 只在游戏线程调用
+    void Append(const FInventoryKitJournalRecord& Record);
+
+    /**
+     * 把本帧缓冲提交给写入线程
+     *
+     * @return 队列已满时返回false, 记录保留到下次提交
+     */
+    bool SubmitPending();
+
+    /**
+     * 提交检查点
+     * 本帧缓冲中尚未提交的记录先于检查点写入日志, 检查点写入成功后才随日志一起清空
+     *
+     * @param SnapshotData 物品系统快照
+     */
+    void SubmitCheckpoint(TArray<uint8>&& SnapshotData);
+
+    // 上次检查点后追加的记录数量
+    int32 GetNumRecordsSinceCheckpoint() const
+    {
+        return NumRecordsSinceCheckpoint;
+    }
+
+    /**
+     * 读取日志文件中所有完整的记录
+     *
+     * @param OutSequence 日志所基于的检查点序号, 文件不存在时为0
+     * @return 文件头不合法时返回false; 文件不存在视为空日志
+     */
+    static bool ReadRecords(const FString& InJournalPath, TArray<FInventoryKitJournalRecord>& OutRecords, uint64& OutSequence);
+
+    /**
+     * 读取最新的完整检查点, 正式文件和替换时残留的.tmp文件中取序号较大者
+     * 兼容没有检查点文件头的旧格式, 其序号视为0
+     *
+     * @param OutSnapshotData 快照数据, 没有检查点时为空
+     * @param OutSequence 检查点序号, 没有检查点时为0
+     * @return 检查点文件存在但都不完整时返回false
+     */
+    static bool ReadCheckpoint(const FString& InCheckpointPath, TArray<uint8>& OutSnapshotData, uint64& OutSequence);
+
+    //~ Begin FRunnable Interface
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+    //~ End FRunnable Interface
+
+private:
+    enum class ECommandType : uint8
+    {
+        Records,
+        Checkpoint
+    };
+
+    struct FCommand
+    {
+        ECommandType Type = ECommandType::Records;
+        TArray<uint8> Data;
+    };
+
+    // 写入线程: 处理队列中的所有命令
+    void ProcessCommands();
+
+    // 写入线程: 以清空方式重新打开日志文件并写入文件头
+    bool ResetJournalFile();
+
+    // 写入线程: 写入检查点文件, 成功后序号+1
+    bool WriteCheckpoint(const TArray<uint8>& SnapshotData);
+
+    // 写入日志文件头
+    void WriteJournalHeader();
+
+    // 读取文件开头的检查点序号, 用于在已有文件的基础上继续递增
+    static uint64 PeekCheckpointSequence(const FString& InPath);
+    static uint64 PeekJournalSequence(const FString& InPath);
+
+    FString JournalPath;
+    FString CheckpointPath;
+    int32 MaxQueuedBatches;
+
+    // 游戏线程: 本帧尚未提交的记录
+    TArray<uint8> PendingBytes;
+    int32 NumRecordsSinceCheckpoint = 0;
+
+    // 游戏线程生产, 写入线程消费
+    TQueue<FCommand, EQueueMode::Spsc> Commands;
+    std::atomic<int32> NumQueuedBatches { 0 };
+    std::atomic<bool> bStopping { false };
+    FEvent* WorkEvent = nullptr;
+    FRunnableThread* Thread = nullptr;
+
+    // 写入线程持有
+    TUniquePtr<IFileHandle> JournalFile;
+
+    // 最近一次写入的检查点序号, Start之后只由写入线程修改
+    uint64 CheckpointSequence = 0;
+};
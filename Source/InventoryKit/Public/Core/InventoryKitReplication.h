@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/InventoryKitTypes.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "InventoryKitReplication.generated.h"
+
+class UInventoryKitBaseContainerComponent;
+struct FInventoryKitReplicatedItemArray;
+
+/**
+ * 同步到客户端的容器物品
+ */
+USTRUCT()
+struct INVENTORYKIT_API FInventoryKitReplicatedItem : public FFastArraySerializerItem
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    FItemBaseInstance Item;
+
+    //~ Begin FFastArraySerializerItem
+    void PreReplicatedRemove(const FInventoryKitReplicatedItemArray& InArraySerializer);
+    void PostReplicatedAdd(const FInventoryKitReplicatedItemArray& InArraySerializer);
+    void PostReplicatedChange(const FInventoryKitReplicatedItemArray& InArraySerializer);
+    //~ End FFastArraySerializerItem
+};
+
+/**
+ * 容器物品的增量同步数组
+ * 服务端在容器收到物品通知时更新对应条目并标记为脏, 只有新增、移除和变化的条目会被发送
+ * 每个连接的已确认状态由FFastArraySerializer维护, 没有变化的容器只比较一次版本号
+ * 客户端的回调先收集, 在PostReplicatedReceive中统一应用, 同一次更新内的互换不会互相覆盖
+ */
+USTRUCT()
+struct INVENTORYKIT_API FInventoryKitReplicatedItemArray : public FFastArraySerializer
+{
+    GENERATED_BODY()
+
+    // 服务端: 新增或更新物品
+    void AddOrUpdate(const FItemBaseInstance& InItem);
+
+    // 服务端: 移除物品
+    void Remove(int32 ItemId);
+
+    // 服务端: 清空所有物品
+    void Reset();
+
+    TConstArrayView<FInventoryKitReplicatedItem> GetItems() const
+    {
+        return Items;
+    }
+
+    //~ Begin FFastArraySerializer
+    void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+    //~ End FFastArraySerializer
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+    {
+        return FFastArraySerializer::FastArrayDeltaSerialize<FInventoryKitReplicatedItem, FInventoryKitReplicatedItemArray>(Items, DeltaParms, *this);
+    }
+
+    // 持有者, 由容器组件在构造时设置
+    UPROPERTY(NotReplicated)
+    TObjectPtr<UInventoryKitBaseContainerComponent> Owner;
+
+private:
+    UPROPERTY()
+    TArray<FInventoryKitReplicatedItem> Items;
+
+    // 服务端: 物品ID -> Items下标
+    TMap<int32, int32> IndexByItemID;
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventoryKitReplicatedItemArray> : public TStructOpsTypeTraitsBase2<FInventoryKitReplicatedItemArray>
+{
+    enum
+    {
+        WithNetDeltaSerializer = true,
+    };
+};
@@ -0,0 +1,333 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 带世代校验的稠密条目表 (slot map)
+ * ID = 条目下标 | (世代 << IndexBits), 条目释放时世代+1, 持有旧ID的查询会直接失败
+ * 存活元素连续存放, 遍历时对缓存友好; 删除时与末尾元素交换, 不保证顺序
+ * 世代用尽的条目不再复用, 保证ID不会在回绕后误命中; 代价是条目表随累计释放次数增长, 约每(MaxGeneration+1)次释放退役一个条目
+ * 因此ID空间总计约MaxEntries * (MaxGeneration+1)次分配(约2^31), 与递增计数器相当, 可以通过GetRemainingAllocations监控
+ * 空闲条目默认后进先出复用, 对缓存友好; 也可以改为先进先出, 让同一ID两次出现之间间隔尽可能长
+ */
+template <typename ElementType>
+class TInventoryKitSlotMap
+{
+public:
+    static constexpr int32 IndexBits = 24;
+    static constexpr int32 GenerationBits = 7;
+    static constexpr int32 IndexMask = (1 << IndexBits) - 1;
+    static constexpr int32 MaxEntries = 1 << IndexBits;
+    static constexpr int32 MaxGeneration = (1 << GenerationBits) - 1;
+
+    static int32 MakeID(int32 EntryIndex, int32 Generation)
+    {
+        return EntryIndex | (Generation << IndexBits);
+    }
+
+    static int32 GetEntryIndex(int32 ID)
+    {
+        return ID & IndexMask;
+    }
+
+    static int32 GetGeneration(int32 ID)
+    {
+        return ID >> IndexBits;
+    }
+
+    /**
+     * 分配一个默认构造的元素
+     *
+     * @param OutID 新元素的ID, 条目耗尽时为INDEX_NONE
+     * @return 新元素的引用, 条目耗尽时返回nullptr
+     */
+    ElementType* AddDefaulted(int32& OutID)
+    {
+        int32 EntryIndex;
+        if (FreeEntries.Num() > FreeHead)
+        {
+            EntryIndex = bReuseOldestFirst ? FreeEntries[FreeHead++] : FreeEntries.Pop();
+            if (FreeHead == FreeEntries.Num())
+            {
+                FreeEntries.Reset();
+                FreeHead = 0;
+            }
+            else if (FreeHead >= 1024 && FreeHead * 2 >= FreeEntries.Num())
+            {
+                // 已取出的部分超过一半时整体前移, 摊还后每次分配为O(1)
+                FreeEntries.RemoveAt(0, FreeHead);
+                FreeHead = 0;
+            }
+        }
+        else if (Entries.Num() < MaxEntries)
+        {
+            EntryIndex = Entries.AddDefaulted();
+        }
+        else
+        {
+            OutID = INDEX_NONE;
+            return nullptr;
+        }
+
+        FEntry& Entry = Entries[EntryIndex];
+        Entry.DenseIndex = Elements.AddDefaulted();
+        DenseToEntry.Add(EntryIndex);
+        PeakNum = FMath::Max(PeakNum, Elements.Num());
+        OutID = MakeID(EntryIndex, Entry.Generation);
+        return &Elements[Entry.DenseIndex];
+    }
+
+    /**
+     * 删除元素, 条目世代+1后放回空闲列表
+     *
+     * @return ID失效或不存在时返回false
+     */
+    bool Remove(int32 ID)
+    {
+        const int32 EntryIndex = ResolveEntry(ID);
+        if (EntryIndex == INDEX_NONE)
+        {
+            return false;
+        }
+
+        FEntry& Entry = Entries[EntryIndex];
+        const int32 DenseIndex = Entry.DenseIndex;
+        Elements.RemoveAtSwap(DenseIndex);
+        DenseToEntry.RemoveAtSwap(DenseIndex);
+        if (DenseIndex < Elements.Num())
+        {
+            Entries[DenseToEntry[DenseIndex]].DenseIndex = DenseIndex;
+        }
+
+        Entry.DenseIndex = INDEX_NONE;
+        if (Entry.Generation < MaxGeneration)
+        {
+            ++Entry.Generation;
+            FreeEntries.Add(EntryIndex);
+        }
+        return true;
+    }
+
+    ElementType* Find(int32 ID)
+    {
+        const int32 EntryIndex = ResolveEntry(ID);
+        return EntryIndex != INDEX_NONE ? &Elements[Entries[EntryIndex].DenseIndex] : nullptr;
+    }
+
+    const ElementType* Find(int32 ID) const
+    {
+        const int32 EntryIndex = ResolveEntry(ID);
+        return EntryIndex != INDEX_NONE ? &Elements[Entries[EntryIndex].DenseIndex] : nullptr;
+    }
+
+    bool Contains(int32 ID) const
+    {
+        return ResolveEntry(ID) != INDEX_NONE;
+    }
+
+    // 根据稠密下标获取元素ID, 与遍历Elements配合使用
+    int32 GetIDAt(int32 DenseIndex) const
+    {
+        const int32 EntryIndex = DenseToEntry[DenseIndex];
+        return MakeID(EntryIndex, Entries[EntryIndex].Generation);
+    }
+
+    int32 Num() const
+    {
+        return Elements.Num();
+    }
+
+    // 可以复用的空闲条目数量
+    int32 GetNumFree() const
+    {
+        return FreeEntries.Num() - FreeHead;
+    }
+
+    // 世代用尽、不再复用的条目数量
+    int32 GetNumRetired() const
+    {
+        return Entries.Num() - Elements.Num() - GetNumFree();
+    }
+
+    // 已分配的条目总数, 决定条目表占用的内存
+    int32 GetNumEntries() const
+    {
+        return Entries.Num();
+    }
+
+    /**
+     * 还能分配多少次元素, 包括尚未创建的条目和已有条目剩余的世代
+     * 需要遍历条目表, 只用于统计
+     */
+    int64 GetRemainingAllocations() const
+    {
+        int64 Remaining = static_cast<int64>(MaxEntries - Entries.Num()) * (MaxGeneration + 1);
+        for (const FEntry& Entry : Entries)
+        {
+            // 空闲条目还能以当前世代再分配一次, 存活条目要等释放后才能复用
+            Remaining += MaxGeneration - Entry.Generation + (Entry.DenseIndex == INDEX_NONE ? 1 : 0);
+        }
+
+        // 退役条目的世代为MaxGeneration且不在空闲列表中, 上面多算了一次
+        return Remaining - GetNumRetired();
+    }
+
+    // 自清空或加载以来同时存活的元素数量峰值
+    int32 GetPeakNum() const
+    {
+        return PeakNum;
+    }
+
+    /**
+     * 设置空闲条目的复用顺序
+     * 
+     * @param bInReuseOldestFirst 为true时先复用最早释放的条目, 为false时先复用最近释放的条目
+     */
+    void SetReuseOldestFirst(bool bInReuseOldestFirst)
+    {
+        bReuseOldestFirst = bInReuseOldestFirst;
+    }
+
+    void Reserve(int32 Number)
+    {
+        Elements.Reserve(Number);
+        DenseToEntry.Reserve(Number);
+        Entries.Reserve(Number);
+    }
+
+    void Empty()
+    {
+        Elements.Empty();
+        DenseToEntry.Empty();
+        Entries.Empty();
+        FreeEntries.Empty();
+        FreeHead = 0;
+        PeakNum = 0;
+    }
+
+    /**
+     * 序列化条目表布局(世代、稠密下标映射、空闲栈), 不包含元素本身
+     * 加载后Elements按稠密顺序默认构造, 由调用方通过GetElements()逐列填充, 保证ID与保存时一致
+     *
+     * @return 加载的数据不合法时返回false, 此时表被清空
+     */
+    bool SerializeLayout(FArchive& Ar)
+    {
+        TArray<int32> Generations;
+        if (Ar.IsSaving())
+        {
+            if (FreeHead > 0)
+            {
+                FreeEntries.RemoveAt(0, FreeHead);
+                FreeHead = 0;
+            }
+            Generations.SetNumUninitialized(Entries.Num());
+            for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+            {
+                Generations[EntryIndex] = Entries[EntryIndex].Generation;
+            }
+        }
+        Generations.BulkSerialize(Ar);
+        DenseToEntry.BulkSerialize(Ar);
+        FreeEntries.BulkSerialize(Ar);
+
+        if (!Ar.IsLoading())
+        {
+            return true;
+        }
+
+        Entries.SetNum(Generations.Num());
+        for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+        {
+            Entries[EntryIndex].DenseIndex = INDEX_NONE;
+            Entries[EntryIndex].Generation = Generations[EntryIndex];
+        }
+
+        bool bValid = !Ar.IsError() && Entries.Num() <= MaxEntries;
+        for (int32 DenseIndex = 0; bValid && DenseIndex < DenseToEntry.Num(); ++DenseIndex)
+        {
+            const int32 EntryIndex = DenseToEntry[DenseIndex];
+            bValid = Entries.IsValidIndex(EntryIndex) && Entries[EntryIndex].DenseIndex == INDEX_NONE;
+            if (bValid)
+            {
+                Entries[EntryIndex].DenseIndex = DenseIndex;
+            }
+        }
+        for (int32 FreeIndex = 0; bValid && FreeIndex < FreeEntries.Num(); ++FreeIndex)
+        {
+            bValid = Entries.IsValidIndex(FreeEntries[FreeIndex]) && Entries[FreeEntries[FreeIndex]].DenseIndex == INDEX_NONE;
+        }
+
+        if (!bValid)
+        {
+            Empty();
+            return false;
+        }
+
+        Elements.Reset();
+        Elements.SetNum(DenseToEntry.Num());
+        FreeHead = 0;
+        PeakNum = Elements.Num();
+        return true;
+    }
+
+    // 连续的存活元素视图
+    TArrayView<ElementType> GetElements() { return Elements; }
+    TConstArrayView<ElementType> GetElements() const { return Elements; }
+
+    typename TArray<ElementType>::RangedForIteratorType begin() { return Elements.begin(); }
+    typename TArray<ElementType>::RangedForIteratorType end() { return Elements.end(); }
+    typename TArray<ElementType>::RangedForConstIteratorType begin() const { return Elements.begin(); }
+    typename TArray<ElementType>::RangedForConstIteratorType end() const { return Elements.end(); }
+
+private:
+    struct FEntry
+    {
+        // 元素在Elements中的下标, INDEX_NONE表示空闲
+        int32 DenseIndex = INDEX_NONE;
+
+        // 当前世代
+        int32 Generation = 0;
+    };
+
+    // 返回ID对应的条目下标, ID失效时返回INDEX_NONE
+    int32 ResolveEntry(int32 ID) const
+    {
+        if (ID < 0)
+        {
+            return INDEX_NONE;
+        }
+        const int32 EntryIndex = GetEntryIndex(ID);
+        if (!Entries.IsValidIndex(EntryIndex))
+        {
+            return INDEX_NONE;
+        }
+        const FEntry& Entry = Entries[EntryIndex];
+        if (Entry.DenseIndex == INDEX_NONE || Entry.Generation != GetGeneration(ID))
+        {
+            return INDEX_NONE;
+        }
+        return EntryIndex;
+    }
+
+    // 存活元素
+    TArray<ElementType> Elements;
+
+    // Elements下标 -> 条目下标
+    TArray<int32> DenseToEntry;
+
+    // 条目表
+    TArray<FEntry> Entries;
+
+    // 空闲条目, [FreeHead, Num)为可复用部分, 按释放顺序排列
+    TArray<int32> FreeEntries;
+
+    // 先进先出复用时下一个取出的位置
+    int32 FreeHead = 0;
+
+    int32 PeakNum = 0;
+
+    bool bReuseOldestFirst = false;
+};
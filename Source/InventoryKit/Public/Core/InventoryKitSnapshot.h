@@ -0,0 +1,109 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/InventoryKitTypes.h"
+
+/**
+ * 物品系统快照版本
+ * 修改快照格式时在LatestVersionPlusOne之前添加新版本
+ */
+enum class EInventoryKitSnapshotVersion : int32
+{
+    Initial = 1,
+
+    // 保存容器与承载物品的挂接关系
+    NestedContainers,
+
+    // 每个容器附带持久化标识, 加载时按标识重新映射容器ID
+    ContainerKeys,
+
+    // -----<新版本添加在此行之上>-----
+    LatestVersionPlusOne,
+    LatestVersion = LatestVersionPlusOne - 1
+};
+
+/**
+ * 快照文件头
+ * 文件头之后依次为: 容器ID状态、物品条目表布局、按列存放的物品数据、各容器的持久化标识和槽位占用、容器挂接关系、项目自定义数据
+ */
+struct INVENTORYKIT_API FInventoryKitSnapshotHeader
+{
+    // "IKSN"
+    static constexpr uint32 ExpectedMagic = 0x4E534B49;
+
+    uint32 Magic = ExpectedMagic;
+
+    int32 Version = static_cast<int32>(EInventoryKitSnapshotVersion::LatestVersion);
+
+    bool IsValid() const
+    {
+        return Magic == ExpectedMagic && Version >= static_cast<int32>(EInventoryKitSnapshotVersion::Initial) && Version <= static_cast<int32>(EInventoryKitSnapshotVersion::LatestVersion);
+    }
+
+    friend FArchive& operator<<(FArchive& Ar, FInventoryKitSnapshotHeader& Header)
+    {
+        Ar << Header.Magic;
+        Ar << Header.Version;
+        return Ar;
+    }
+};
+
+/**
+ * 按列存放的物品数据
+ * 下标与物品存储的稠密下标一致, 物品ID由条目表布局恢复, 不单独保存
+ * 每列都是平坦数组, 读写时整块拷贝
+ */
+struct INVENTORYKIT_API FInventoryKitItemColumns
+{
+    TArray<int32> ContainerIDs;
+    TArray<int32> SlotIndices;
+    TArray<int32> DefinitionIDs;
+    TArray<int32> Quantities;
+    TArray<int32> SizeX;
+    TArray<int32> SizeY;
+    TArray<uint8> Rotated;
+
+    // 从连续的物品实例中拆出各列
+    void Gather(TConstArrayView<FItemBaseInstance> Items)
+    {
+        const int32 Num = Items.Num();
+        ContainerIDs.SetNumUninitialized(Num);
+        SlotIndices.SetNumUninitialized(Num);
+        DefinitionIDs.SetNumUninitialized(Num);
+        Quantities.SetNumUninitialized(Num);
+        SizeX.SetNumUninitialized(Num);
+        SizeY.SetNumUninitialized(Num);
+        Rotated.SetNumUninitialized(Num);
+        for (int32 Index = 0; Index < Num; ++Index)
+        {
+            const FItemBaseInstance& Item = Items[Index];
+            ContainerIDs[Index] = Item.ItemLocation.ContainerID;
+            SlotIndices[Index] = Item.ItemLocation.SlotIndex;
+            DefinitionIDs[Index] = Item.DefinitionID;
+            Quantities[Index] = Item.Quantity;
+            SizeX[Index] = Item.Size.X;
+            SizeY[Index] = Item.Size.Y;
+            Rotated[Index] = Item.bRotated ? 1 : 0;
+        }
+    }
+
+    // 各列长度是否都等于Num
+    bool IsValid(int32 Num) const
+    {
+        return ContainerIDs.Num() == Num && SlotIndices.Num() == Num && DefinitionIDs.Num() == Num && Quantities.Num() == Num
+            && SizeX.Num() == Num && SizeY.Num() == Num && Rotated.Num() == Num;
+    }
+
+    void Serialize(FArchive& Ar)
+    {
+        ContainerIDs.BulkSerialize(Ar);
+        SlotIndices.BulkSerialize(Ar);
+        DefinitionIDs.BulkSerialize(Ar);
+        Quantities.BulkSerialize(Ar);
+        SizeX.BulkSerialize(Ar);
+        SizeY.BulkSerialize(Ar);
+        Rotated.BulkSerialize(Ar);
+    }
+};
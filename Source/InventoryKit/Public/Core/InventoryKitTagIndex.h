@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Core/InventoryKitTypes.h"
+
+/**
+ * 物品标签倒排索引
+ * 标签 -> 带有该标签的物品集合, 物品的每个标签连同其所有父标签都会建立索引, 查询父标签时无需展开子标签
+ * 标签查询按表达式树对倒排表做并、交、差运算求值, 不逐个匹配物品
+ */
+class INVENTORYKIT_API FInventoryKitTagIndex
+{
+public:
+    /**
+     * 求值结果
+     * bComplement为false时结果为Items; 为true时结果为全集中除Items以外的所有物品, 用于表示NoTagsMatch等取反的表达式
+     */
+    struct FResult
+    {
+        FInventoryKitItemIdSet Items;
+        bool bComplement = false;
+    };
+
+    // 为物品的标签及其父标签建立索引
+    void AddItem(int32 ItemId, const FGameplayTagContainer& Tags);
+
+    // 移除物品的索引, Tags需与添加时一致
+    void RemoveItem(int32 ItemId, const FGameplayTagContainer& Tags);
+
+    void Reset();
+
+    // 带有该标签或其子标签的物品, 没有时返回nullptr
+    const FInventoryKitItemIdSet* Find(const FGameplayTag& Tag) const;
+
+    /**
+     * 对标签查询求值
+     *
+     * @return 查询中含有索引不支持的表达式类型(如精确匹配)时返回false, 调用方应退回逐个匹配
+     */
+    bool Evaluate(const FGameplayTagQuery& Query, FResult& OutResult) const;
+
+private:
+    bool EvaluateExpr(const FGameplayTagQueryExpression& Expr, FResult& OutResult) const;
+
+    // A = A ∪ B
+    static void Union(FResult& A, const FResult& B);
+
+    // A = A ∩ B
+    static void Intersect(FResult& A, const FResult& B);
+
+    TMap<FGameplayTag, FInventoryKitItemIdSet> Postings;
+};
@@ -0,0 +1,114 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/InventoryKitTypes.h"
+
+/**
+ * 物品事务
+ * 暂存移动、创建、销毁操作, 由UInventoryKitItemSystem::CommitTransaction统一提交
+ * 提交时按顺序基于暂存后的状态校验每一步, 任一步失败则整体放弃, 物品和容器都不会被修改
+ * 同一事务中创建的物品不能被后续步骤引用
+ */
+class INVENTORYKIT_API FInventoryKitTransaction
+{
+public:
+    enum class EOpType : uint8
+    {
+        Move,
+        Create,
+        Destroy
+    };
+
+    struct FOp
+    {
+        EOpType Type;
+
+        // 移动、销毁的物品ID, 创建时为-1
+        int32 ItemID;
+
+        // 移动、创建的目标位置
+        FItemLocation Location;
+
+        // 创建时使用的模板在CreateTemplates中的下标, 没有模板时为-1
+        int32 TemplateIndex = INDEX_NONE;
+    };
+
+    /**
+     * 暂存移动操作
+     */
+    void StageMove(int32 ItemId, const FItemLocation& TargetLocation)
+    {
+        Ops.Add({ EOpType::Move, ItemId, TargetLocation });
+    }
+
+    /**
+     * 暂存创建操作
+     * 
+     * @return 创建序号, 提交成功后对应OutCreatedItemIds中的下标
+     */
+    int32 StageCreate(const FItemLocation& Location)
+    {
+        Ops.Add({ EOpType::Create, INDEX_NONE, Location });
+        return NumCreates++;
+    }
+
+    /**
+     * 按模板暂存创建操作
+     * 校验和提交都使用模板的定义、尺寸、旋转和堆叠数量, 模板的ID和位置被忽略
+     * 
+     * @return 创建序号, 提交成功后对应OutCreatedItemIds中的下标
+     */
+    int32 StageCreate(const FItemBaseInstance& Template, const FItemLocation& Location)
+    {
+        FItemBaseInstance& StagedTemplate = CreateTemplates.Add_GetRef(Template);
+        StagedTemplate.ItemID = INDEX_NONE;
+        StagedTemplate.ItemLocation = Location;
+        Ops.Add({ EOpType::Create, INDEX_NONE, Location, CreateTemplates.Num() - 1 });
+        return NumCreates++;
+    }
+
+    /**
+     * 暂存销毁操作
+     */
+    void StageDestroy(int32 ItemId)
+    {
+        Ops.Add({ EOpType::Destroy, ItemId, FItemLocation() });
+    }
+
+    void Reset()
+    {
+        Ops.Reset();
+        CreateTemplates.Reset();
+        NumCreates = 0;
+    }
+
+    bool IsEmpty() const
+    {
+        return Ops.Num() == 0;
+    }
+
+    int32 GetNumCreates() const
+    {
+        return NumCreates;
+    }
+
+    const TArray<FOp>& GetOps() const
+    {
+        return Ops;
+    }
+
+    // 创建操作使用的模板, 没有模板时返回空
+    const FItemBaseInstance* GetCreateTemplate(const FOp& Op) const
+    {
+        return CreateTemplates.IsValidIndex(Op.TemplateIndex) ? &CreateTemplates[Op.TemplateIndex] : nullptr;
+    }
+
+private:
+    TArray<FOp> Ops;
+
+    TArray<FItemBaseInstance> CreateTemplates;
+
+    int32 NumCreates = 0;
+};
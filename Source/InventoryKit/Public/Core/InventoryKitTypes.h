@@ -18,6 +18,39 @@ enum class EContainerSpaceType : uint8
     Grid UMETA(DisplayName = "网格容器")         // 网格容器空间 - 二维网格布局
 };
 
+/**
+ * 容器变更的广播时机
+ */
+UENUM(BlueprintType)
+enum class EContainerChangeFlushPolicy : uint8
+{
+    Immediate UMETA(DisplayName = "立即广播"),       // 每次操作通知容器后立即广播
+    EndOfFrame UMETA(DisplayName = "帧末广播"),      // 在本帧Actor Tick结束后统一广播
+    Manual UMETA(DisplayName = "手动广播")           // 由项目调用FlushContainerChanges广播
+};
+
+/**
+ * 物品ID的复用策略
+ * 物品ID由条目下标和世代组成, 条目释放后世代+1再复用, 持有旧ID的查询不会误命中新物品
+ */
+UENUM(BlueprintType)
+enum class EInventoryKitItemIdPolicy : uint8
+{
+    RecycleLatest UMETA(DisplayName = "优先复用最近释放"),   // 后进先出, 复用的条目仍在缓存中
+    RecycleOldest UMETA(DisplayName = "优先复用最早释放")    // 先进先出, 同一ID两次出现之间间隔最长, 适合外部长期持有ID的场景
+};
+
+/**
+ * 注销容器时内部物品的处理方式
+ */
+UENUM(BlueprintType)
+enum class EInventoryKitOrphanPolicy : uint8
+{
+    MoveToVoid UMETA(DisplayName = "移入虚空"),
+    Destroy UMETA(DisplayName = "销毁"),
+    HandOff UMETA(DisplayName = "转交其他容器")     // 放不下的物品移入虚空
+};
+
 /**
  * 容器配置结构体
  * 用于初始化和配置容器的槽位管理方式
@@ -45,7 +78,13 @@ struct INVENTORYKIT_API FContainerSpaceConfig
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryKit|Grid", meta = (EditCondition = "SpaceType == EContainerSpaceType::Grid", EditConditionHides, ClampMin = "1"))
     int32 GridHeight;
 
-    // Todo: 负重等配置
+    // 负重上限, 小于0表示不限制
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryKit|Limits")
+    float MaxWeight;
+
+    // 体积上限, 小于0表示不限制
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "InventoryKit|Limits")
+    float MaxVolume;
     
     // 构造函数 - 默认为无序容器，不限制容量
     FContainerSpaceConfig()
@@ -53,6 +92,8 @@ struct INVENTORYKIT_API FContainerSpaceConfig
         , Capacity(-1)
         , GridWidth(1)
         , GridHeight(1)
+        , MaxWeight(-1.f)
+        , MaxVolume(-1.f)
     {
     }
 
@@ -61,6 +102,8 @@ struct INVENTORYKIT_API FContainerSpaceConfig
         , Capacity(InCapacity)
         , GridWidth(InGridWidth)
         , GridHeight(InGridHeight)
+        , MaxWeight(-1.f)
+        , MaxVolume(-1.f)
     {
     }
 };
@@ -105,6 +148,70 @@ struct INVENTORYKIT_API FItemLocation
     }
 };
 
+/**
+ * 批量移动请求
+ */
+USTRUCT(BlueprintType)
+struct INVENTORYKIT_API FItemMoveRequest
+{
+    GENERATED_BODY()
+
+    // 要移动的物品ID
+    UPROPERTY(BlueprintReadWrite)
+    int32 ItemID;
+
+    // 目标位置
+    UPROPERTY(BlueprintReadWrite)
+    FItemLocation TargetLocation;
+
+    FItemMoveRequest()
+        : ItemID(-1)
+    {
+    }
+
+    FItemMoveRequest(int32 InItemID, const FItemLocation& InTargetLocation)
+        : ItemID(InItemID), TargetLocation(InTargetLocation)
+    {
+    }
+};
+
+/**
+ * 物品ID分配统计
+ */
+USTRUCT(BlueprintType)
+struct INVENTORYKIT_API FInventoryKitItemIdStats
+{
+    GENERATED_BODY()
+
+    // 存活的物品数量
+    UPROPERTY(BlueprintReadOnly)
+    int32 NumLive = 0;
+
+    // 可以复用的空闲条目数量
+    UPROPERTY(BlueprintReadOnly)
+    int32 NumFree = 0;
+
+    // 世代用尽、不再复用的条目数量, 随累计销毁次数增长, 约每128次销毁增加一个
+    UPROPERTY(BlueprintReadOnly)
+    int32 NumRetired = 0;
+
+    // 自初始化或加载快照以来同时存活的物品数量峰值
+    UPROPERTY(BlueprintReadOnly)
+    int32 PeakLive = 0;
+
+    // 已分配的条目总数
+    UPROPERTY(BlueprintReadOnly)
+    int32 NumEntries = 0;
+
+    // 条目数量上限, 达到上限且没有空闲条目时无法再创建物品
+    UPROPERTY(BlueprintReadOnly)
+    int32 MaxEntries = 0;
+
+    // 耗尽ID空间前还能创建的物品数量, 总量约2^31次
+    UPROPERTY(BlueprintReadOnly)
+    int64 RemainingAllocations = 0;
+};
+
 /**
  * 物品基础结构体，项目如果需要额外实例数据， 可以通过创建一个新的结构体， 然后继承InventorySystem, 在其中增加一个<ID, CustomData>的Map来保存实例数据
  */
@@ -119,10 +226,330 @@ struct INVENTORYKIT_API FItemBaseInstance
     
     UPROPERTY(BlueprintReadOnly)
     FItemLocation ItemLocation;
+
+    // 物品定义ID, 由项目决定含义(数据表行号、资产索引等), -1表示未指定
+    UPROPERTY(BlueprintReadOnly)
+    int32 DefinitionID;
+
+    // 堆叠数量
+    UPROPERTY(BlueprintReadOnly)
+    int32 Quantity;
+
+    // 网格容器中的占用尺寸(未旋转时的宽高), 非网格容器忽略
+    UPROPERTY(BlueprintReadOnly)
+    FIntPoint Size;
+
+    // 是否旋转90度放置, 旋转后宽高互换
+    UPROPERTY(BlueprintReadOnly)
+    bool bRotated;
     
     // 基础构造函数
     FItemBaseInstance()
         : ItemID(-1)
+        , DefinitionID(-1)
+        , Quantity(1)
+        , Size(1, 1)
+        , bRotated(false)
+    {
+    }
+
+    // 实际占用的宽高, 已考虑旋转
+    FIntPoint GetFootprint() const
+    {
+        return bRotated ? FIntPoint(Size.Y, Size.X) : Size;
+    }
+};
+
+/**
+ * 物品ID集合
+ * 稠密数组 + 下标索引, 插入、删除、查询均为O(1)
+ * 删除时与末尾元素交换, 因此不保证物品顺序
+ */
+USTRUCT()
+struct INVENTORYKIT_API FInventoryKitItemIdSet
+{
+    GENERATED_BODY()
+
+private:
+    // 连续存储的物品ID
+    UPROPERTY()
+    TArray<int32> Items;
+
+    // 物品ID -> Items中的下标
+    TMap<int32, int32> IndexMap;
+
+public:
+    /**
+     * 添加物品ID
+     * @return 是否新增, 已存在时返回false
+     */
+    bool Add(int32 ItemId)
+    {
+        if (IndexMap.Contains(ItemId))
+        {
+            return false;
+        }
+        IndexMap.Add(ItemId, Items.Add(ItemId));
+        return true;
+    }
+
+    /**
+     * 移除物品ID
+     * @return 是否移除, 不存在时返回false
+     */
+    bool Remove(int32 ItemId)
+    {
+        int32 Index;
+        if (!IndexMap.RemoveAndCopyValue(ItemId, Index))
+        {
+            return false;
+        }
+        Items.RemoveAtSwap(Index);
+        if (Index < Items.Num())
+        {
+            IndexMap[Items[Index]] = Index;
+        }
+        return true;
+    }
+
+    bool Contains(int32 ItemId) const
+    {
+        return IndexMap.Contains(ItemId);
+    }
+
+    int32 Num() const
+    {
+        return Items.Num();
+    }
+
+    void Reserve(int32 Number)
+    {
+        Items.Reserve(Number);
+        IndexMap.Reserve(Number);
+    }
+
+    void Reset()
     {
+        Items.Reset();
+        IndexMap.Reset();
     }
-};
\ No newline at end of file
+
+    // 连续的物品ID视图
+    const TArray<int32>& GetItems() const
+    {
+        return Items;
+    }
+
+    TArray<int32>::RangedForConstIteratorType begin() const { return Items.begin(); }
+    TArray<int32>::RangedForConstIteratorType end() const { return Items.end(); }
+};
+
+/**
+ * 负重和体积
+ * 容器的当前值由物品进出时增量维护, 检查时不需要遍历容器内容
+ */
+struct INVENTORYKIT_API FInventoryKitLoad
+{
+    double Weight = 0.0;
+    double Volume = 0.0;
+
+    FInventoryKitLoad() = default;
+
+    FInventoryKitLoad(double InWeight, double InVolume)
+        : Weight(InWeight)
+        , Volume(InVolume)
+    {
+    }
+
+    FInventoryKitLoad& operator+=(const FInventoryKitLoad& Other)
+    {
+        Weight += Other.Weight;
+        Volume += Other.Volume;
+        return *this;
+    }
+
+    FInventoryKitLoad& operator-=(const FInventoryKitLoad& Other)
+    {
+        Weight -= Other.Weight;
+        Volume -= Other.Volume;
+        return *this;
+    }
+
+    FInventoryKitLoad operator+(const FInventoryKitLoad& Other) const
+    {
+        return FInventoryKitLoad(Weight + Other.Weight, Volume + Other.Volume);
+    }
+
+    FInventoryKitLoad operator-(const FInventoryKitLoad& Other) const
+    {
+        return FInventoryKitLoad(Weight - Other.Weight, Volume - Other.Volume);
+    }
+
+    FInventoryKitLoad operator-() const
+    {
+        return FInventoryKitLoad(-Weight, -Volume);
+    }
+
+    FInventoryKitLoad operator*(double Scale) const
+    {
+        return FInventoryKitLoad(Weight * Scale, Volume * Scale);
+    }
+
+    bool IsZero() const
+    {
+        return Weight == 0.0 && Volume == 0.0;
+    }
+};
+
+/**
+ * 事务中单个容器的暂存变化
+ * 容器在事务校验阶段据此判断槽位和容量, 不需要修改自身状态
+ */
+struct INVENTORYKIT_API FInventoryKitStagedContainerDelta
+{
+    // 实际被占用、但在暂存状态中已被释放的槽位
+    TSet<int32> FreedSlots;
+
+    // 实际空闲、但在暂存状态中已被占用的槽位
+    TSet<int32> ClaimedSlots;
+
+    // 暂存状态中新增的物品数量
+    int32 AddedCount = 0;
+
+    // 暂存状态中移出的物品数量
+    int32 RemovedCount = 0;
+
+    // 暂存状态中新增和移出的负重、体积
+    FInventoryKitLoad AddedLoad;
+    FInventoryKitLoad RemovedLoad;
+
+    void ReleaseSlot(int32 SlotIndex)
+    {
+        if (ClaimedSlots.Remove(SlotIndex) == 0)
+        {
+            FreedSlots.Add(SlotIndex);
+        }
+    }
+
+    void ClaimSlot(int32 SlotIndex)
+    {
+        if (FreedSlots.Remove(SlotIndex) == 0)
+        {
+            ClaimedSlots.Add(SlotIndex);
+        }
+    }
+};
+
+/**
+ * 容器的一次合并变更
+ * 同一物品在一次广播周期内的多次变化会被合并, 例如添加后又移除的物品不会出现
+ */
+USTRUCT(BlueprintType)
+struct INVENTORYKIT_API FContainerChangeSet
+{
+    GENERATED_BODY()
+
+    // 容器ID
+    UPROPERTY(BlueprintReadOnly)
+    int32 ContainerID = -1;
+
+    // 新进入容器的物品
+    UPROPERTY(BlueprintReadOnly)
+    TArray<int32> AddedItems;
+
+    // 离开容器的物品
+    UPROPERTY(BlueprintReadOnly)
+    TArray<int32> RemovedItems;
+
+    // 仍在容器中但位置、旋转或数量发生变化的物品
+    UPROPERTY(BlueprintReadOnly)
+    TArray<int32> ChangedItems;
+
+    // 状态发生变化的槽位
+    UPROPERTY(BlueprintReadOnly)
+    TArray<int32> DirtySlots;
+
+    bool IsEmpty() const
+    {
+        return AddedItems.Num() == 0 && RemovedItems.Num() == 0 && ChangedItems.Num() == 0 && DirtySlots.Num() == 0;
+    }
+};
+
+/**
+ * 容器变更日志
+ * 容器在收到物品系统通知时记录, 广播时一次性产出合并后的FContainerChangeSet
+ */
+struct INVENTORYKIT_API FInventoryKitContainerChangeJournal
+{
+    void RecordAdded(int32 ItemId)
+    {
+        // 本周期内先移出又移回的物品视为变化
+        if (RemovedItems.Remove(ItemId))
+        {
+            ChangedItems.Add(ItemId);
+        }
+        else
+        {
+            AddedItems.Add(ItemId);
+        }
+    }
+
+    void RecordRemoved(int32 ItemId)
+    {
+        ChangedItems.Remove(ItemId);
+        
+        // 本周期内新加入又移出的物品不需要广播
+        if (!AddedItems.Remove(ItemId))
+        {
+            RemovedItems.Add(ItemId);
+        }
+    }
+
+    void RecordChanged(int32 ItemId)
+    {
+        if (!AddedItems.Contains(ItemId))
+        {
+            ChangedItems.Add(ItemId);
+        }
+    }
+
+    void RecordDirtySlot(int32 SlotIndex)
+    {
+        DirtySlots.Add(SlotIndex);
+    }
+
+    bool IsEmpty() const
+    {
+        return AddedItems.Num() == 0 && RemovedItems.Num() == 0 && ChangedItems.Num() == 0 && DirtySlots.Num() == 0;
+    }
+
+    /**
+     * 输出合并后的变更并清空日志
+     * 
+     * @return 是否有变更
+     */
+    bool Flush(int32 ContainerID, FContainerChangeSet& OutChangeSet)
+    {
+        if (IsEmpty())
+        {
+            return false;
+        }
+        
+        OutChangeSet.ContainerID = ContainerID;
+        OutChangeSet.AddedItems = AddedItems.GetItems();
+        OutChangeSet.RemovedItems = RemovedItems.GetItems();
+        OutChangeSet.ChangedItems = ChangedItems.GetItems();
+        OutChangeSet.DirtySlots = DirtySlots.Array();
+        AddedItems.Reset();
+        RemovedItems.Reset();
+        ChangedItems.Reset();
+        DirtySlots.Reset();
+        return true;
+    }
+
+private:
+    FInventoryKitItemIdSet AddedItems;
+    FInventoryKitItemIdSet RemovedItems;
+    FInventoryKitItemIdSet ChangedItems;
+    TSet<int32> DirtySlots;
+};
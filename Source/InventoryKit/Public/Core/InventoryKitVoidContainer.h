@@ -9,6 +9,7 @@
 
 /**
  * 虚空容器
+ * 记录物品进入虚空的时间, 物品系统据此分批回收滞留过久的物品
  */
 UCLASS()
 class INVENTORYKIT_API UInventoryKitVoidContainer : public UObject, public IInventoryKitContainerInterface
@@ -21,16 +22,42 @@ protected:
 
 	// 物品ID缓存
 	UPROPERTY()
-	TArray<int32> ItemIds;
+	FInventoryKitItemIdSet ItemIds;
 
 	// 容器空间管理器
 	UPROPERTY()
 	TObjectPtr<UContainerSpaceManager> SpaceManager;
+
+	struct FVoidEntry
+	{
+		int32 ItemId;
+		double EnterTime;
+	};
+
+	// 按进入时间排列的只追加队列, [EntryHead, Num)为尚未检查的部分; 已离开的物品在检查时跳过
+	TArray<FVoidEntry> EntryQueue;
+	int32 EntryHead = 0;
+
+	// 物品ID -> 最近一次进入虚空的时间, 用于识别队列中已失效的记录
+	TMap<int32, double> EnterTimes;
+
+	// 队列中尚未检查、物品已离开的记录数量, 超过一半时压缩队列
+	int32 NumStaleEntries = 0;
+
+	// 是否记录进入时间, 物品系统未开启回收时不记录, 队列不会增长
+	bool bTrackEnterTimes = false;
+
+	// 记录物品进入虚空
+	void RecordEnter(int32 ItemId, double Now);
+
+	// 删除队列中已失效的记录
+	void CompactEntryQueue();
 	
 public:
 	//~ Begin IInventoryKitContainerInterface
 	virtual void InitContainer(int32 InContainerID) override;
 	virtual const int32 GetContainerID() const override;
+	virtual FString GetPersistentKey() const override;
 	virtual bool CanAddItem(const FItemBaseInstance& InItem, int32 DstSlotIndex) override;
 	virtual bool CanMoveItem(const FItemBaseInstance& InItem, int32 DstSlotIndex) override;
 	virtual void OnItemAdded(const FItemBaseInstance& InItem) override;
@@ -38,8 +65,24 @@ public:
 	virtual void OnItemRemoved(const FItemBaseInstance& InItem) override;
 	virtual const TArray<int32>& GetAllItems() const override;
 	virtual UContainerSpaceManager* GetSpaceManager() override;
+	virtual bool ContainsItem(int32 ItemId) const override;
+	virtual void RestoreContents(TConstArrayView<int32> InItemIds) override;
 	//~ End IInventoryKitContainerInterface
 
+	/**
+	 * 取出在虚空中滞留超过MaxAge秒的物品, 按进入顺序检查, 遇到未过期的记录即停止
+	 * 
+	 * @param MaxEntries 本次最多检查的进入记录数, 已离开虚空的物品留下的记录也计入, 用于分帧回收
+	 * @return 取出的数量
+	 */
+	int32 CollectExpiredItems(double Now, double MaxAge, int32 MaxEntries, TArray<int32>& OutItemIds);
+
+	/**
+	 * 开启或关闭进入时间的记录
+	 * 关闭时清空队列; 开启时虚空中已有的物品从此刻开始计时
+	 */
+	void SetTrackEnterTimes(bool bInTrackEnterTimes);
+
 	void SetContainerSpaceConfig(const FContainerSpaceConfig& InConfig)
 	{
 		ContainerSpaceConfig = InConfig;
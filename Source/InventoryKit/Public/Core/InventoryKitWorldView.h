@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/InventoryKitTypes.h"
+
+/**
+ * 只读的物品世界视图
+ * 由物品系统在游戏线程发布, 发布后不再修改, 任意线程都可以无锁读取, 不会读到修改到一半的状态
+ * 物品和容器都按条目下标分块保存, 块由共享指针持有; 发布新版本时复制两张块指针表, 再只复制有变化的块,
+ * 其余块与上一版本共享. 指针表的大小为条目数除以块大小, 发布的主要耗时与变化量成正比
+ *
+ * 使用方式: 在游戏线程调用UInventoryKitItemSystem::GetWorldView, 把返回的指针交给工作线程的任务;
+ * 任务持有指针期间视图一直有效, 不受之后的发布影响
+ */
+class INVENTORYKIT_API FInventoryKitWorldView
+{
+public:
+    static constexpr int32 ChunkBits = 10;
+    static constexpr int32 ChunkSize = 1 << ChunkBits;
+
+    // 容器远少于物品, 块也更小
+    static constexpr int32 ContainerChunkBits = 6;
+    static constexpr int32 ContainerChunkSize = 1 << ContainerChunkBits;
+
+    // 一个块保存ChunkSize个条目, ItemID为-1的条目为空
+    using FItemChunk = TArray<FItemBaseInstance>;
+
+    // 发布时的版本号, 每次发布递增
+    uint64 GetVersion() const
+    {
+        return Version;
+    }
+
+    // 查找物品, 物品不存在或ID已失效时返回nullptr
+    const FItemBaseInstance* FindItem(int32 ItemId) const;
+
+    int32 GetNumItems() const
+    {
+        return NumItems;
+    }
+
+    // 容器内的所有物品ID, 容器不存在时返回空
+    TConstArrayView<int32> GetItemsInContainer(int32 ContainerID) const;
+
+    /**
+     * 容器内容最后一次变化时的视图版本
+     * 读取方可以据此跳过没有变化的容器
+     *
+     * @return 容器不存在时返回0
+     */
+    uint64 GetContainerVersion(int32 ContainerID) const;
+
+    // 父容器, 即承载物品所在的容器; 顶层容器返回-1
+    int32 GetParentContainerID(int32 ContainerID) const;
+
+    // 容器及其所有嵌套子容器中的物品
+    TArray<int32> GetItemsInContainerRecursive(int32 ContainerID) const;
+
+    // 物品承载的容器ID, 没有时返回-1
+    int32 GetHostedContainerID(int32 ItemId) const;
+
+    // 遍历所有物品
+    template <typename FuncType>
+    void ForEachItem(FuncType&& Func) const
+    {
+        for (const TSharedPtr<const FItemChunk, ESPMode::ThreadSafe>& Chunk : Chunks)
+        {
+            if (!Chunk)
+            {
+                continue;
+            }
+            for (const FItemBaseInstance& Item : *Chunk)
+            {
+                if (Item.ItemID != INDEX_NONE)
+                {
+                    Func(Item);
+                }
+            }
+        }
+    }
+
+private:
+    friend class UInventoryKitItemSystem;
+
+    struct FContainerEntry
+    {
+        // 条目被新容器复用时世代不同, 查找时比较完整的ID; 空条目为-1
+        int32 ContainerID = INDEX_NONE;
+        TSharedPtr<const TArray<int32>, ESPMode::ThreadSafe> Items;
+        uint64 Version = 0;
+    };
+
+    // 一个块保存ContainerChunkSize个容器条目
+    using FContainerChunk = TArray<FContainerEntry>;
+
+    // 查找容器条目, 容器不存在时返回nullptr
+    const FContainerEntry* FindContainer(int32 ContainerID) const;
+
+    uint64 Version = 0;
+    int32 NumItems = 0;
+
+    // 按条目下标分块的物品, 没有物品的块为空指针
+    TArray<TSharedPtr<const FItemChunk, ESPMode::ThreadSafe>> Chunks;
+
+    // 按容器ID的条目下标分块的容器内容, 没有容器的块为空指针
+    TArray<TSharedPtr<const FContainerChunk, ESPMode::ThreadSafe>> ContainerChunks;
+
+    // 容器ID -> 承载它的物品ID
+    TSharedPtr<const TMap<int32, int32>, ESPMode::ThreadSafe> ContainerHostItems;
+
+    // 物品ID -> 它承载的容器ID
+    TSharedPtr<const TMap<int32, int32>, ESPMode::ThreadSafe> ItemHostedContainers;
+};
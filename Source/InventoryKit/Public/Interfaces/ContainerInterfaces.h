@@ -32,6 +32,15 @@ public:
      * @return 容器ID
      */
     virtual const int32 GetContainerID() const = 0;
+
+    /**
+     * 跨会话稳定的容器标识
+     * 容器ID随注册顺序分配并会复用, 快照和日志按此标识把保存时的容器ID映射到当前注册的容器
+     * 返回空字符串表示容器不参与持久化, 加载时其中的物品移入虚空
+     * 
+     * @return 持久化标识
+     */
+    virtual FString GetPersistentKey() const { return FString(); }
     
     /**
      * 检查容器是否可以添加指定物品
@@ -51,6 +60,81 @@ public:
      * @return 是否可以移动物品 
      */
     virtual bool CanMoveItem(const FItemBaseInstance& InItem, int32 DstSlotIndex) = 0;
+
+    /**
+     * 基于事务暂存状态检查容器是否可以添加指定物品
+     * 默认实现忽略暂存状态, 直接调用CanAddItem; 需要支持事务内腾挪槽位的容器应重写此方法
+     * 
+     * @param InItem 
+     * @param DstSlotIndex 
+     * @param Staged 当前事务对此容器的暂存变化
+     * @return 是否可以添加物品
+     */
+    virtual bool CanAddItemStaged(const FItemBaseInstance& InItem, int32 DstSlotIndex, const FInventoryKitStagedContainerDelta& Staged)
+    {
+        return CanAddItem(InItem, DstSlotIndex);
+    }
+
+    /**
+     * 检查容器能否再承受指定的负重和体积
+     * 默认实现不限制
+     * 
+     * @param AdditionalLoad 新增的负重和体积
+     * @return 是否可以承受
+     */
+    virtual bool CanAcceptLoad(const FInventoryKitLoad& AdditionalLoad) const
+    {
+        return true;
+    }
+
+    /**
+     * 按剩余负重和体积计算容器最多还能接受多少个单位
+     * 用于堆叠物品的批量添加, 默认实现不限制
+     * 
+     * @param UnitLoad 单个单位的负重和体积
+     * @param MaxQuantity 期望添加的数量
+     * @return 不超过MaxQuantity的可接受数量
+     */
+    virtual int32 GetAcceptableQuantity(const FInventoryKitLoad& UnitLoad, int32 MaxQuantity) const
+    {
+        return MaxQuantity;
+    }
+
+    /**
+     * 获取容器当前的总负重和体积, 包含嵌套在其中的子容器的内容
+     * 默认实现不统计负重
+     */
+    virtual FInventoryKitLoad GetCurrentLoad() const
+    {
+        return FInventoryKitLoad();
+    }
+
+    /**
+     * 嵌套子容器的内容负重变化通知
+     * 子容器的内容变化时, 物品系统沿父链向每个祖先容器调用一次, 默认不做处理
+     * 
+     * @param Delta 负重和体积的变化量
+     */
+    virtual void AddNestedLoad(const FInventoryKitLoad& Delta) {}
+
+    /**
+     * 清空嵌套子容器的负重, 物品系统重建嵌套负重前调用, 默认不做处理
+     */
+    virtual void ResetNestedLoad() {}
+
+    /**
+     * 基于事务暂存状态检查容器是否可以移动指定物品
+     * 默认实现忽略暂存状态, 直接调用CanMoveItem
+     * 
+     * @param InItem 
+     * @param DstSlotIndex 
+     * @param Staged 当前事务对此容器的暂存变化
+     * @return 是否可以移动物品
+     */
+    virtual bool CanMoveItemStaged(const FItemBaseInstance& InItem, int32 DstSlotIndex, const FInventoryKitStagedContainerDelta& Staged)
+    {
+        return CanMoveItem(InItem, DstSlotIndex);
+    }
     
     /**
      * 物品添加通知回调
@@ -76,6 +160,42 @@ public:
      * @param InItem
      */
     virtual void OnItemRemoved(const FItemBaseInstance& InItem) = 0;
+
+    /**
+     * 物品堆叠数量变化通知回调
+     * 合并、拆分堆叠时调用, 默认不做处理
+     * 
+     * @param InItem 数量变化后的物品
+     * @param OldQuantity 变化前的数量
+     */
+    virtual void OnItemQuantityChanged(const FItemBaseInstance& InItem, int32 OldQuantity) {}
+
+    /**
+     * 批量物品添加通知回调
+     * 物品系统批量移动时, 每个容器每批次只会收到一次
+     * 默认实现逐个调用OnItemAdded
+     * 
+     * @param InItems
+     */
+    virtual void OnItemsAdded(TConstArrayView<FItemBaseInstance> InItems);
+
+    /**
+     * 批量物品移动通知回调
+     * 语义上先释放所有旧槽位再占用新槽位, 因此批次内物品可以互换位置
+     * 默认实现逐个调用OnItemMoved, 需要支持互换的容器应重写此方法
+     * 
+     * @param OldLocations 与InItems一一对应的旧位置
+     * @param InItems
+     */
+    virtual void OnItemsMoved(TConstArrayView<FItemLocation> OldLocations, TConstArrayView<FItemBaseInstance> InItems);
+
+    /**
+     * 批量物品移除通知回调
+     * 默认实现逐个调用OnItemRemoved
+     * 
+     * @param InItems
+     */
+    virtual void OnItemsRemoved(TConstArrayView<FItemBaseInstance> InItems);
     
     /**
      * 获取容器中所有物品ID
@@ -85,7 +205,41 @@ public:
      */
     virtual const TArray<int32>& GetAllItems() const = 0;
 
+    /**
+     * 检查容器是否包含指定物品
+     * 实现应保证O(1)
+     * 
+     * @param ItemId 
+     * @return 是否包含此物品
+     */
+    virtual bool ContainsItem(int32 ItemId) const = 0;
+
+    /**
+     * 加载物品系统快照后重建容器内的物品列表
+     * 槽位占用由空间管理器单独恢复, 实现中不应再更新占用状态
+     * 
+     * @param InItemIds 容器内的所有物品ID
+     */
+    virtual void RestoreContents(TConstArrayView<int32> InItemIds) = 0;
+
     virtual UContainerSpaceManager* GetSpaceManager() = 0;
 
+    /**
+     * 广播积累的变更
+     * 物品系统按EContainerChangeFlushPolicy在合适的时机调用, 默认不做处理
+     */
+    virtual void FlushPendingChanges() {}
+
+    /**
+     * 注销时交出空间管理器, 由物品系统放回池中供之后注册的容器复用
+     * 交出后容器不再持有空间管理器; 默认不交出
+     * 
+     * @return 交出的空间管理器, nullptr表示不回收
+     */
+    virtual UContainerSpaceManager* ReleaseSpaceManager() { return nullptr; }
+
     static UContainerSpaceManager* CreateSpaceManager(UObject* InOuter, const FContainerSpaceConfig& InConfig);
+
+    // 空间类型对应的空间管理器类
+    static UClass* GetSpaceManagerClass(EContainerSpaceType InSpaceType);
 };
\ No newline at end of file